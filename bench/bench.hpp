@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace owge::bench
+{
+class Context
+{
+public:
+    Context(const char* name, bool quick) noexcept
+        : m_name(name), m_quick(quick)
+    {}
+
+    // Quick runs only check that the benchmarks work, they scale every iteration count down.
+    [[nodiscard]] uint64_t iterations(uint64_t count) const noexcept
+    {
+        return m_quick ? (count + 999) / 1000 : count;
+    }
+
+    void report(const char* metric, double value, const char* unit) const;
+    // Reports `count / seconds` as operations per second.
+    void report_rate(const char* metric, uint64_t count, double seconds) const;
+
+    // Keeps the optimizer from dropping the work that produced `value`.
+    void consume(uint64_t value) noexcept;
+
+private:
+    const char* m_name;
+    bool m_quick;
+};
+
+struct Benchmark
+{
+    const char* name;
+    void(*run)(Context&);
+};
+
+[[nodiscard]] std::vector<Benchmark>& get_benchmarks();
+
+// Bytes requested through the global operator new since the process started.
+[[nodiscard]] uint64_t get_allocated_bytes() noexcept;
+// Resident set size of the process, 0 where it isn't available.
+[[nodiscard]] uint64_t get_resident_bytes() noexcept;
+
+class Timer
+{
+public:
+    Timer() noexcept
+        : m_start(std::chrono::steady_clock::now())
+    {}
+
+    [[nodiscard]] double seconds() const noexcept
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+struct Benchmark_Registrar
+{
+    Benchmark_Registrar(const char* name, void(*run)(Context&))
+    {
+        get_benchmarks().push_back({ .name = name, .run = run });
+    }
+};
+}
+
+// Defines a benchmark, `owge_bench <prefix>` only runs the benchmarks whose name starts with `prefix`.
+#define OWGE_BENCHMARK(group, name) \
+    static void group##_##name(owge::bench::Context& context); \
+    static const owge::bench::Benchmark_Registrar group##_##name##_registrar(#group "." #name, group##_##name); \
+    static void group##_##name([[maybe_unused]] owge::bench::Context& context)
@@ -0,0 +1,126 @@
+#include "bench.hpp"
+
+#include <owge_common/block_allocator.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace owge
+{
+// Matches the heap blocks and placement rules of Gpu_Heap_Allocator.
+static constexpr uint64_t HEAP_BLOCK_SIZE = 64ull << 20;
+static constexpr uint64_t MAX_PLACED_RESOURCE_SIZE = HEAP_BLOCK_SIZE / 4;
+static constexpr uint64_t DEFAULT_PLACEMENT_ALIGNMENT = 64 << 10;
+static constexpr uint64_t SMALL_PLACEMENT_ALIGNMENT = 4 << 10;
+// The working set grows to the high mark and shrinks to the low mark again, like loading and unloading a level.
+static constexpr uint64_t HIGH_WORKING_SET = 768ull << 20;
+static constexpr uint64_t LOW_WORKING_SET = 192ull << 20;
+
+struct Placed_Resource
+{
+    uint64_t size;
+    uint64_t alignment;
+};
+
+// Buffers and textures are 64 KiB aligned and sized, small textures may use 4 KiB placement.
+[[nodiscard]] static Placed_Resource get_placed_resource(std::mt19937& random)
+{
+    auto kind = random() % 10;
+    if (kind < 4)
+    {
+        return { .size = DEFAULT_PLACEMENT_ALIGNMENT * (1 + random() % 64), .alignment = DEFAULT_PLACEMENT_ALIGNMENT };
+    }
+    if (kind < 7)
+    {
+        return { .size = SMALL_PLACEMENT_ALIGNMENT * (1 + random() % 16), .alignment = SMALL_PLACEMENT_ALIGNMENT };
+    }
+    auto size = (DEFAULT_PLACEMENT_ALIGNMENT * 4) << (random() % 7);
+    return { .size = std::min(size, MAX_PLACED_RESOURCE_SIZE), .alignment = DEFAULT_PLACEMENT_ALIGNMENT };
+}
+
+OWGE_BENCHMARK(block_allocator, placed_resource_churn)
+{
+    Block_Allocator allocator(HEAP_BLOCK_SIZE);
+    std::mt19937 random(42);
+    std::vector<Block_Allocation> allocations;
+    uint64_t used_size = 0;
+    uint64_t allocate_count = 0;
+    uint64_t free_count = 0;
+    uint64_t added_block_count = 0;
+    uint64_t removed_block_count = 0;
+    uint32_t peak_block_count = 0;
+    double allocate_seconds = 0.0;
+    double free_seconds = 0.0;
+    double peak_fragmentation = 0.0;
+    double peak_utilization = 0.0;
+
+    auto cycle_count = context.iterations(2000);
+    for (uint64_t cycle = 0; cycle < cycle_count; ++cycle)
+    {
+        bench::Timer allocate_timer;
+        while (used_size < HIGH_WORKING_SET)
+        {
+            auto resource = get_placed_resource(random);
+            auto allocation = allocator.allocate(resource.size, resource.alignment);
+            if (!allocation.is_valid())
+            {
+                (void)allocator.add_block();
+                added_block_count += 1;
+                allocation = allocator.allocate(resource.size, resource.alignment);
+            }
+            used_size += allocation.size;
+            allocations.push_back(allocation);
+            allocate_count += 1;
+        }
+        allocate_seconds += allocate_timer.seconds();
+
+        // Fragmentation of the free memory, and how much of the blocks the resources use, at the high mark.
+        auto stats = allocator.get_stats();
+        auto block_memory = uint64_t(stats.block_count) * HEAP_BLOCK_SIZE;
+        auto free_size = block_memory - stats.used_size;
+        peak_block_count = std::max(peak_block_count, stats.block_count);
+        peak_fragmentation += free_size > 0 ? 1.0 - double(stats.largest_free_block) / double(free_size) : 0.0;
+        peak_utilization += double(stats.used_size) / double(block_memory);
+
+        bench::Timer free_timer;
+        while (used_size > LOW_WORKING_SET)
+        {
+            auto index = random() % allocations.size();
+            auto allocation = allocations[index];
+            allocations[index] = allocations.back();
+            allocations.pop_back();
+            used_size -= allocation.size;
+            if (allocator.free(allocation))
+            {
+                allocator.remove_block(allocation.block);
+                removed_block_count += 1;
+            }
+            free_count += 1;
+        }
+        free_seconds += free_timer.seconds();
+    }
+
+    auto low_block_count = allocator.get_stats().block_count;
+    for (const auto& allocation : allocations)
+    {
+        if (allocator.free(allocation))
+        {
+            allocator.remove_block(allocation.block);
+            removed_block_count += 1;
+        }
+    }
+
+    context.report_rate("allocate", allocate_count, allocate_seconds);
+    context.report("allocate latency", allocate_seconds * 1e9 / double(allocate_count), "ns");
+    context.report_rate("free", free_count, free_seconds);
+    context.report("free latency", free_seconds * 1e9 / double(free_count), "ns");
+    context.report("fragmentation at high mark", 100.0 * peak_fragmentation / double(cycle_count), "%");
+    context.report("block utilization at high mark", 100.0 * peak_utilization / double(cycle_count), "%");
+    context.report("peak blocks", double(peak_block_count), "blocks");
+    context.report("blocks at low mark", double(low_block_count), "blocks");
+    context.report("blocks after draining", double(allocator.get_stats().block_count), "blocks");
+    context.report("added blocks", double(added_block_count), "blocks");
+    context.report("reclaimed blocks", double(removed_block_count), "blocks");
+}
+}
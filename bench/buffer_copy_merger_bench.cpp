@@ -0,0 +1,93 @@
+#include "bench.hpp"
+
+#include <owge_common/buffer_copy_merger.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace owge
+{
+struct Bench_Copy
+{
+    uint32_t src;
+    uint64_t src_offset;
+    uint32_t dst;
+    uint64_t dst_offset;
+    uint64_t size;
+};
+
+static constexpr uint32_t SLOTS_PER_BUFFER = 512;
+
+// Slots are staged back to back in the upload ring in `order`, like upload_data does.
+[[nodiscard]] static std::vector<Bench_Copy> stage_slots(const std::vector<uint32_t>& order, uint64_t slot_size)
+{
+    std::vector<Bench_Copy> copies;
+    uint64_t ring_offset = 0;
+    for (auto slot : order)
+    {
+        copies.push_back({
+            .src = 0,
+            .src_offset = ring_offset,
+            .dst = slot / SLOTS_PER_BUFFER,
+            .dst_offset = (slot % SLOTS_PER_BUFFER) * slot_size,
+            .size = slot_size
+        });
+        ring_offset += slot_size;
+    }
+    return copies;
+}
+
+static void bench_merge(bench::Context& context, const char* name, const std::vector<Bench_Copy>& copies)
+{
+    std::vector<Bench_Copy> sorted;
+    uint32_t issued_count = 0;
+    uint64_t size = 0;
+    auto repeat_count = context.iterations(200);
+    bench::Timer timer;
+    for (uint64_t i = 0; i < repeat_count; ++i)
+    {
+        issued_count = merge_buffer_copies(copies, sorted, [&](const Bench_Copy& copy) {
+            size += copy.size;
+        });
+    }
+    auto seconds = timer.seconds();
+    context.report((std::string(name) + " requested").c_str(), double(copies.size()), "copies");
+    context.report((std::string(name) + " issued").c_str(), double(issued_count), "copies");
+    context.report_rate((std::string(name) + " merge").c_str(), repeat_count * copies.size(), seconds);
+    context.consume(size);
+}
+
+// 16 buffers of per-object data with 64 byte slots, 8192 of them updated per frame.
+OWGE_BENCHMARK(buffer_copy_merger, per_object_updates)
+{
+    static constexpr uint32_t UPDATE_COUNT = 8192;
+    std::vector<uint32_t> order(UPDATE_COUNT);
+    std::iota(order.begin(), order.end(), 0u);
+    bench_merge(context, "in slot order", stage_slots(order, 64));
+
+    std::mt19937 random(5);
+    std::vector<uint32_t> blocks(order);
+    // Objects update in runs of 8 neighbouring slots, the runs come in random order.
+    for (uint32_t i = 0; i < UPDATE_COUNT; i += 8)
+    {
+        blocks[i / 8] = i;
+    }
+    blocks.resize(UPDATE_COUNT / 8);
+    std::ranges::shuffle(blocks, random);
+    std::vector<uint32_t> runs;
+    for (auto block : blocks)
+    {
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            runs.push_back(block + i);
+        }
+    }
+    bench_merge(context, "shuffled runs", stage_slots(runs, 64));
+
+    std::ranges::shuffle(order, random);
+    bench_merge(context, "random order", stage_slots(order, 64));
+}
+}
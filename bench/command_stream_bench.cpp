@@ -0,0 +1,81 @@
+#include "bench.hpp"
+
+#include <owge_common/command_stream.hpp>
+
+#include <cstring>
+#include <random>
+
+namespace owge
+{
+static constexpr uint32_t DRAW_COUNT = 4096;
+static constexpr uint32_t PIPELINE_COUNT = 16;
+// Passes end with barriers, the sort never moves work across them.
+static constexpr uint32_t DRAWS_PER_BARRIER = 512;
+
+// Every draw sets its pipeline and a few root constants, like the draws of a pass recorded in scene order do.
+static void record_frame(Command_Stream& stream)
+{
+    std::mt19937 random(42);
+    for (uint32_t i = 0; i < DRAW_COUNT; ++i)
+    {
+        stream.push<Command_Set_Pipeline_State>(Command_Type::Set_Pipeline_State).pipeline =
+            1 + random() % PIPELINE_COUNT;
+        auto& constants = stream.push<Command_Set_Constants>(Command_Type::Set_Constants, 4 * sizeof(uint32_t));
+        constants = { .first_constant = 0, .count = 4, .graphics = true };
+        uint32_t values[4] = { i, i % 7, 0, 1 };
+        std::memcpy(Command_Stream::get_trailing_data(constants), values, sizeof(values));
+        stream.push<Command_Draw>(Command_Type::Draw) = {
+            .vertex_count = 3 * (1 + i % 64),
+            .vertex_offset = 0,
+            .instance_count = 1,
+            .instance_offset = 0
+        };
+        if (i % DRAWS_PER_BARRIER == DRAWS_PER_BARRIER - 1)
+        {
+            stream.push<Command_Barrier>(Command_Type::Barrier) = {};
+        }
+    }
+}
+
+OWGE_BENCHMARK(command_stream, frame_4096_draws)
+{
+    Command_Stream stream;
+    record_frame(stream);
+    auto packet_count = uint64_t(stream.get_packet_count());
+    context.report("packets", double(packet_count), "packets");
+
+    auto frame_count = context.iterations(2000);
+    uint64_t sum = 0;
+    bench::Timer record_timer;
+    for (uint64_t i = 0; i < frame_count; ++i)
+    {
+        stream.reset();
+        record_frame(stream);
+        sum += stream.get_packet_count();
+    }
+    context.report_rate("record", frame_count * packet_count, record_timer.seconds());
+
+    bench::Timer validate_timer;
+    for (uint64_t i = 0; i < frame_count; ++i)
+    {
+        uint32_t open_event_count = 0;
+        sum += stream.validate(open_event_count);
+    }
+    context.report_rate("validate", frame_count * packet_count, validate_timer.seconds());
+
+    // Sorting consumes the recorded order, so every frame is recorded again outside the timed part.
+    double sort_seconds = 0.0;
+    for (uint64_t i = 0; i < frame_count; ++i)
+    {
+        stream.reset();
+        record_frame(stream);
+        bench::Timer sort_timer;
+        stream.sort_by_pipeline();
+        sort_seconds += sort_timer.seconds();
+        sum += stream.get_packet_count();
+    }
+    context.report_rate("sort", frame_count * packet_count, sort_seconds);
+    context.report("sorted packets", double(stream.get_packet_count()), "packets");
+    context.consume(sum);
+}
+}
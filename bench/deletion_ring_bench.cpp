@@ -0,0 +1,101 @@
+#include "bench.hpp"
+
+#include <owge_render_engine/deletion_ring.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace owge
+{
+static constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+
+struct Bench_Deletion
+{
+    uint64_t handle;
+    uint64_t frame;
+};
+
+struct Retire_Counter
+{
+    uint64_t retired_count;
+    uint64_t handle_sum;
+
+    void retire(uint64_t handle)
+    {
+        retired_count += 1;
+        handle_sum += handle;
+    }
+};
+
+static void report(bench::Context& context, const char* name, uint64_t deletions_per_frame, uint64_t frame_count,
+    double seconds, double retire_seconds)
+{
+    auto metric = std::to_string(deletions_per_frame * FRAMES_IN_FLIGHT) + " pending, " + name;
+    context.report_rate((metric + " push+retire").c_str(), deletions_per_frame * frame_count, seconds);
+    context.report((metric + " retire").c_str(), retire_seconds * 1e6 / double(frame_count), "us/frame");
+}
+
+// The remove_if scan empty_deletion_queues did before the ring, with the mutex the queues had for loader threads.
+static void bench_scan(bench::Context& context, uint64_t frame_count, uint64_t deletions_per_frame)
+{
+    Retire_Counter counter = {};
+    double retire_seconds = 0.0;
+    std::mutex mutex;
+    std::vector<Bench_Deletion> queue;
+    bench::Timer timer;
+    for (uint64_t frame = 0; frame < frame_count; ++frame)
+    {
+        for (uint64_t i = 0; i < deletions_per_frame; ++i)
+        {
+            std::scoped_lock lock(mutex);
+            queue.push_back({ .handle = i, .frame = frame + FRAMES_IN_FLIGHT });
+        }
+        bench::Timer retire_timer;
+        std::scoped_lock lock(mutex);
+        auto range = std::ranges::remove_if(queue, [&](const Bench_Deletion& deletion) {
+            if (frame >= deletion.frame)
+            {
+                counter.retire(deletion.handle);
+                return true;
+            }
+            return false;
+        });
+        queue.erase(range.begin(), range.end());
+        retire_seconds += retire_timer.seconds();
+    }
+    report(context, "scan", deletions_per_frame, frame_count, timer.seconds(), retire_seconds);
+    context.consume(counter.handle_sum);
+}
+
+static void bench_ring(bench::Context& context, uint64_t frame_count, uint64_t deletions_per_frame)
+{
+    Retire_Counter counter = {};
+    double retire_seconds = 0.0;
+    Deletion_Ring ring(FRAMES_IN_FLIGHT + 1);
+    bench::Timer timer;
+    for (uint64_t frame = 0; frame < frame_count; ++frame)
+    {
+        for (uint64_t i = 0; i < deletions_per_frame; ++i)
+        {
+            ring.push<&Retire_Counter::retire>(frame + FRAMES_IN_FLIGHT, &counter, i);
+        }
+        bench::Timer retire_timer;
+        ring.retire(frame);
+        retire_seconds += retire_timer.seconds();
+    }
+    report(context, "ring", deletions_per_frame, frame_count, timer.seconds(), retire_seconds);
+    context.consume(counter.handle_sum);
+}
+
+OWGE_BENCHMARK(deletion_ring, retire)
+{
+    auto frame_count = context.iterations(1000) + FRAMES_IN_FLIGHT;
+    for (uint64_t deletions_per_frame : { 1000, 10000, 50000 })
+    {
+        bench_scan(context, frame_count, deletions_per_frame);
+        bench_ring(context, frame_count, deletions_per_frame);
+    }
+}
+}
@@ -0,0 +1,108 @@
+#include "bench.hpp"
+
+#include <owge_common/dirty_range_merger.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace owge
+{
+// Mirrors Bindset_Stager: 16 dword bindsets in 4 MB buffers that are flushed with 4 KB pages.
+static constexpr uint64_t BUFFER_SIZE = 4194304;
+static constexpr uint64_t BINDSET_SIZE = 64;
+static constexpr uint64_t PAGE_SIZE = 4096;
+static constexpr uint32_t DIRTY_BINDSET_COUNT = 10000;
+
+struct Dirty_Bindset
+{
+    uint64_t offset;
+    uint64_t dirty_mask;
+};
+
+static void bench_flush(bench::Context& context, const char* name, const std::vector<Dirty_Bindset>& bindsets,
+    float page_upload_density)
+{
+    std::vector<Dirty_Range> dirty_ranges;
+    std::vector<Dirty_Range> flush_ranges;
+    uint64_t uploaded_size = 0;
+    auto frame_count = context.iterations(200);
+    bench::Timer timer;
+    for (uint64_t frame = 0; frame < frame_count; ++frame)
+    {
+        for (const auto& bindset : bindsets)
+        {
+            for (auto mask = bindset.dirty_mask; mask != 0;)
+            {
+                auto first = uint64_t(std::countr_zero(mask));
+                auto count = uint64_t(std::countr_one(mask >> first));
+                dirty_ranges.push_back({
+                    .buffer = bindset.offset / BUFFER_SIZE,
+                    .begin = bindset.offset % BUFFER_SIZE + first * sizeof(uint32_t),
+                    .end = bindset.offset % BUFFER_SIZE + (first + count) * sizeof(uint32_t)
+                });
+                mask &= ~(((1ull << count) - 1) << first);
+            }
+        }
+        merge_dirty_ranges(dirty_ranges);
+        flush_ranges.assign(dirty_ranges.begin(), dirty_ranges.end());
+        if (page_upload_density > 0.0f)
+        {
+            append_dense_pages(dirty_ranges, PAGE_SIZE, uint64_t(float(PAGE_SIZE) * page_upload_density),
+                [](uint64_t) { return BUFFER_SIZE; }, flush_ranges);
+            merge_dirty_ranges(flush_ranges);
+        }
+        uploaded_size = 0;
+        for (const auto& range : flush_ranges)
+        {
+            uploaded_size += range.end - range.begin;
+        }
+        if (frame + 1 < frame_count)
+        {
+            dirty_ranges.clear();
+            flush_ranges.clear();
+        }
+    }
+    auto seconds = timer.seconds();
+    auto metric = std::string(name) + ", density " + std::to_string(int(page_upload_density * 100.0f)) + "%";
+    context.report((metric + " copies").c_str(), double(flush_ranges.size()), "copies");
+    context.report((metric + " uploaded").c_str(), double(uploaded_size) / 1024.0, "KiB");
+    context.report((metric + " flush").c_str(), seconds * 1e6 / double(frame_count), "us/frame");
+}
+
+static void bench_bindsets(bench::Context& context, const char* name, const std::vector<uint64_t>& slots)
+{
+    std::mt19937 random(9);
+    std::vector<Dirty_Bindset> bindsets;
+    for (auto slot : slots)
+    {
+        // Most updates rewrite one or two handles, some rewrite the whole bindset.
+        auto dirty_mask = random() % 4 == 0
+            ? 0xFFFFull
+            : (1ull << (random() % 16)) | (1ull << (random() % 16));
+        bindsets.push_back({ .offset = slot * BINDSET_SIZE, .dirty_mask = dirty_mask });
+    }
+    // 0.5 is what the tech demo uses.
+    for (auto page_upload_density : { 0.0f, 0.25f, 0.5f })
+    {
+        bench_flush(context, name, bindsets, page_upload_density);
+    }
+}
+
+OWGE_BENCHMARK(dirty_range_merger, dirty_bindsets)
+{
+    // Three buffers' worth of bindsets, as a scene of a few hundred thousand bindsets would have.
+    std::vector<uint64_t> slots(3 * BUFFER_SIZE / BINDSET_SIZE);
+    std::iota(slots.begin(), slots.end(), 0ull);
+    std::ranges::shuffle(slots, std::mt19937(4));
+    slots.resize(DIRTY_BINDSET_COUNT);
+    bench_bindsets(context, "scattered", slots);
+
+    std::ranges::sort(slots);
+    std::iota(slots.begin(), slots.end(), slots.front());
+    bench_bindsets(context, "contiguous", slots);
+}
+}
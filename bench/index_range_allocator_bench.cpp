@@ -0,0 +1,85 @@
+#include "bench.hpp"
+
+#include <owge_common/index_range_allocator.hpp>
+#include <owge_common/tlsf_allocator.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace owge
+{
+// The CBV/SRV/UAV heap, which Descriptor_Allocator serves ranges from.
+static constexpr uint32_t HEAP_SIZE = 1000000;
+// Descriptor counts of created resources: 1 or 2 for buffers, an SRV plus one UAV per mip for textures.
+static constexpr uint32_t DESCRIPTOR_COUNTS[] = { 1, 2, 2, 1, 2, 11, 1, 8 };
+
+// What Descriptor_Allocator::allocate_range did before the cached counts, every call takes the mutex.
+class Locked_Tlsf_Allocator
+{
+public:
+    Locked_Tlsf_Allocator(uint32_t size)
+        : m_allocator(size)
+    {}
+
+    [[nodiscard]] uint32_t allocate(uint32_t count)
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_allocator.allocate(count).node;
+    }
+    void free(uint32_t allocation)
+    {
+        std::scoped_lock lock(m_mutex);
+        m_allocator.free(allocation);
+    }
+
+private:
+    std::mutex m_mutex;
+    Tlsf_Allocator m_allocator;
+};
+
+template<typename Allocator, typename Allocate_Fn>
+static void bench_concurrent_scaling(bench::Context& context, const char* name, Allocate_Fn&& allocate)
+{
+    auto max_thread_count = std::max(4u, std::thread::hardware_concurrency());
+    auto iteration_count = context.iterations(1 << 20);
+    for (uint32_t thread_count = 1; thread_count <= max_thread_count; thread_count *= 2)
+    {
+        Allocator allocator(HEAP_SIZE);
+        std::vector<std::jthread> threads;
+        bench::Timer timer;
+        for (uint32_t thread = 0; thread < thread_count; ++thread)
+        {
+            threads.emplace_back([&]() {
+                uint32_t allocations[64];
+                for (uint64_t i = 0; i < iteration_count; ++i)
+                {
+                    auto& allocation = allocations[i % 64];
+                    if (i >= 64)
+                    {
+                        allocator.free(allocation);
+                    }
+                    allocation = allocate(allocator, DESCRIPTOR_COUNTS[i % std::size(DESCRIPTOR_COUNTS)]);
+                }
+                for (auto allocation : allocations)
+                {
+                    allocator.free(allocation);
+                }
+            });
+        }
+        threads.clear();
+        auto metric = std::to_string(thread_count) + " thread allocate+free, " + name;
+        context.report_rate(metric.c_str(), thread_count * iteration_count, timer.seconds());
+    }
+}
+
+OWGE_BENCHMARK(index_range_allocator, concurrent_scaling)
+{
+    bench_concurrent_scaling<Index_Range_Allocator>(context, "cached counts",
+        [](Index_Range_Allocator& allocator, uint32_t count) { return allocator.allocate(count).allocation; });
+    bench_concurrent_scaling<Locked_Tlsf_Allocator>(context, "mutex + TLSF (baseline)",
+        [](Locked_Tlsf_Allocator& allocator, uint32_t count) { return allocator.allocate(count); });
+}
+}
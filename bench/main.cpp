@@ -0,0 +1,134 @@
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+static std::atomic<uint64_t> s_allocated_bytes = 0;
+
+// Only the unaligned forms are counted, the array and nothrow forms forward to them.
+void* operator new(std::size_t size)
+{
+    s_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (auto result = std::malloc(size != 0 ? size : 1))
+    {
+        return result;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace owge::bench
+{
+static std::atomic<uint64_t> s_sink = 0;
+
+void Context::report(const char* metric, double value, const char* unit) const
+{
+    std::printf("%-40s %-28s %16.2f %s\n", m_name, metric, value, unit);
+}
+
+void Context::report_rate(const char* metric, uint64_t count, double seconds) const
+{
+    report(metric, seconds > 0.0 ? double(count) / seconds : 0.0, "op/s");
+}
+
+void Context::consume(uint64_t value) noexcept
+{
+    s_sink.fetch_xor(value, std::memory_order_relaxed);
+}
+
+std::vector<Benchmark>& get_benchmarks()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+uint64_t get_allocated_bytes() noexcept
+{
+    return s_allocated_bytes.load(std::memory_order_relaxed);
+}
+
+uint64_t get_resident_bytes() noexcept
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#else
+    uint64_t resident_pages = 0;
+    if (auto file = std::fopen("/proc/self/statm", "r"))
+    {
+        if (std::fscanf(file, "%*u %lu", &resident_pages) != 1)
+        {
+            resident_pages = 0;
+        }
+        std::fclose(file);
+    }
+    return resident_pages * uint64_t(sysconf(_SC_PAGESIZE));
+#endif
+}
+}
+
+int main(int argc, char** argv)
+{
+    using namespace owge::bench;
+
+    bool quick = false;
+    const char* prefix = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--quick") == 0)
+        {
+            quick = true;
+        }
+        else
+        {
+            prefix = argv[i];
+        }
+    }
+
+    uint32_t run_count = 0;
+    uint32_t failed_count = 0;
+    for (const auto& benchmark : get_benchmarks())
+    {
+        if (prefix != nullptr && std::strncmp(prefix, benchmark.name, std::strlen(prefix)) != 0)
+        {
+            continue;
+        }
+        Context context(benchmark.name, quick);
+        try
+        {
+            benchmark.run(context);
+        }
+        catch (const std::exception& exception)
+        {
+            std::printf("[FAILED] %s: %s\n", benchmark.name, exception.what());
+            failed_count += 1;
+        }
+        run_count += 1;
+    }
+    return run_count == 0 || failed_count > 0 ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+#include "bench.hpp"
+
+#include <owge_common/render_graph.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace owge
+{
+static constexpr uint32_t PASS_COUNT = 500;
+static constexpr uint32_t IMPORTED_RESOURCE_COUNT = 32;
+// Passes read what the passes shortly before them produced, like the stages of a frame do.
+static constexpr uint32_t READ_WINDOW = 16;
+
+struct Bench_Usage
+{
+    uint32_t pass;
+    uint32_t resource;
+    Render_Graph_Access access;
+};
+
+struct Bench_Graph
+{
+    std::vector<Render_Graph_Resource_Desc> resources;
+    std::vector<Render_Graph_Pass_Desc> passes;
+    std::vector<Bench_Usage> usages;
+};
+
+// Every pass writes a transient resource and reads up to three produced by the passes before it. Every eighth
+// pass is async compute and every sixteenth writes an exported resource, passes whose results only feed
+// culled passes are culled.
+[[nodiscard]] static Bench_Graph create_bench_graph()
+{
+    std::mt19937 random(42);
+    Bench_Graph graph;
+    for (uint32_t i = 0; i < IMPORTED_RESOURCE_COUNT; ++i)
+    {
+        graph.resources.push_back({
+            .texture = i % 2 == 0,
+            .imported = true,
+            .exported = i % 4 == 0,
+            .initial_access = Render_Graph_Access::Pixel_Shader_Read,
+            .final_access = i % 4 == 0 ? Render_Graph_Access::Pixel_Shader_Read : Render_Graph_Access::None,
+            .size = 0,
+            .alignment = 0
+        });
+    }
+    for (uint32_t pass = 0; pass < PASS_COUNT; ++pass)
+    {
+        auto async_compute = pass % 8 == 7;
+        graph.passes.push_back({ .async_compute = async_compute, .side_effects = pass % 100 == 99 });
+        auto read_access = async_compute ? Render_Graph_Access::Compute_Shader_Read : Render_Graph_Access::Pixel_Shader_Read;
+        auto read_count = pass == 0 ? 0u : 1u + random() % 3;
+        for (uint32_t i = 0; i < read_count; ++i)
+        {
+            auto window = std::min(pass, READ_WINDOW);
+            auto producer = pass - 1 - uint32_t(random() % window);
+            graph.usages.push_back({ .pass = pass, .resource = IMPORTED_RESOURCE_COUNT + producer, .access = read_access });
+        }
+        graph.resources.push_back({
+            .texture = random() % 4 != 0,
+            .imported = false,
+            .exported = false,
+            .initial_access = Render_Graph_Access::None,
+            .final_access = Render_Graph_Access::None,
+            .size = 65536ull << (random() % 6),
+            .alignment = 65536
+        });
+        auto write_access = async_compute ? Render_Graph_Access::Unordered_Access : Render_Graph_Access::Render_Target;
+        graph.usages.push_back({ .pass = pass, .resource = IMPORTED_RESOURCE_COUNT + pass, .access = write_access });
+        if (pass % 16 == 15)
+        {
+            graph.usages.push_back({
+                .pass = pass,
+                .resource = uint32_t(random() % IMPORTED_RESOURCE_COUNT),
+                .access = Render_Graph_Access::Unordered_Access
+            });
+        }
+    }
+    return graph;
+}
+
+static void build_graph(const Bench_Graph& bench_graph, Render_Graph& graph)
+{
+    graph.clear();
+    for (const auto& resource : bench_graph.resources)
+    {
+        [[maybe_unused]] auto index = graph.add_resource(resource);
+    }
+    for (const auto& pass : bench_graph.passes)
+    {
+        [[maybe_unused]] auto index = graph.add_pass(pass);
+    }
+    for (const auto& usage : bench_graph.usages)
+    {
+        graph.use(usage.pass, usage.resource, usage.access);
+    }
+}
+
+OWGE_BENCHMARK(render_graph, compile_500_passes)
+{
+    auto bench_graph = create_bench_graph();
+    Render_Graph graph;
+    build_graph(bench_graph, graph);
+    auto compiled = graph.compile();
+    context.report("kept passes", double(compiled.passes.size()), "passes");
+    context.report("barriers", double(compiled.barriers.size()), "barriers");
+    context.report("transient heap", double(compiled.transient_heap_size) / (1024.0 * 1024.0), "MiB");
+
+    auto compile_count = context.iterations(2000);
+    uint64_t sum = 0;
+    bench::Timer compile_timer;
+    for (uint64_t i = 0; i < compile_count; ++i)
+    {
+        sum += graph.compile().barriers.size();
+    }
+    auto compile_seconds = compile_timer.seconds();
+    context.report_rate("compile", compile_count, compile_seconds);
+    context.report("compile time", compile_seconds * 1e6 / double(compile_count), "us");
+
+    // The render engine rebuilds its graph every frame.
+    bench::Timer frame_timer;
+    for (uint64_t i = 0; i < compile_count; ++i)
+    {
+        build_graph(bench_graph, graph);
+        sum += graph.compile().passes.size();
+    }
+    auto frame_seconds = frame_timer.seconds();
+    context.report_rate("build + compile", compile_count, frame_seconds);
+    context.report("build + compile time", frame_seconds * 1e6 / double(compile_count), "us");
+    context.consume(sum);
+}
+}
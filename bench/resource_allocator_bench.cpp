@@ -0,0 +1,171 @@
+#include "bench.hpp"
+#include "vector_resource_allocator.hpp"
+
+#include <owge_render_engine/resource_allocator.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace owge
+{
+static constexpr uint32_t CAPACITY = 1048576;
+
+// Roughly the size of a Texture.
+struct Bench_Resource
+{
+    uint64_t values[8];
+};
+
+// Mirrors Pipeline and Pipeline_Desc, the graphics desc is dominated by the blend, rasterizer and depth state.
+struct Bench_Pipeline
+{
+    void* pso;
+    uint32_t type;
+    uint32_t workgroups_x;
+    uint32_t workgroups_y;
+    uint32_t workgroups_z;
+};
+
+struct Bench_Pipeline_Desc
+{
+    uint32_t type;
+    std::byte graphics[508];
+};
+
+struct Bench_Pipeline_Record
+{
+    Bench_Pipeline pipeline;
+    Bench_Pipeline_Desc desc;
+};
+
+template<typename Allocator>
+static void bench_startup(bench::Context& context, const char* name)
+{
+    auto allocated_bytes = bench::get_allocated_bytes();
+    auto resident_bytes = bench::get_resident_bytes();
+    auto allocator = std::make_unique<Allocator>(CAPACITY);
+    auto handle = allocator->insert(0, 0, { .values = { 1 } });
+    context.consume((*allocator)[handle].values[0]);
+    context.report(name, double(bench::get_allocated_bytes() - allocated_bytes) / 1024.0, "KiB allocated");
+    context.report(name, double(bench::get_resident_bytes() - resident_bytes) / 1024.0, "KiB resident");
+}
+
+template<typename Allocator>
+static void bench_insert_lookup(bench::Context& context, const char* name)
+{
+    auto count = context.iterations(CAPACITY);
+    auto allocator = std::make_unique<Allocator>(CAPACITY);
+    std::vector<Base_Resource_Handle<Bench_Resource>> handles;
+    handles.reserve(count);
+
+    bench::Timer insert_timer;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        handles.push_back(allocator->insert(0, 0, { .values = { i } }));
+    }
+    context.report_rate((std::string(name) + " insert").c_str(), count, insert_timer.seconds());
+
+    std::ranges::shuffle(handles, std::mt19937(42));
+    uint64_t sum = 0;
+    bench::Timer lookup_timer;
+    for (uint32_t pass = 0; pass < 4; ++pass)
+    {
+        for (auto handle : handles)
+        {
+            sum += (*allocator)[handle].values[0];
+        }
+    }
+    context.report_rate((std::string(name) + " lookup").c_str(), count * 4, lookup_timer.seconds());
+    context.consume(sum);
+}
+
+OWGE_BENCHMARK(resource_allocator, startup)
+{
+    bench_startup<Resource_Allocator<Bench_Resource>>(context, "paged");
+    bench_startup<bench::Vector_Resource_Allocator<Bench_Resource>>(context, "vector (baseline)");
+}
+
+OWGE_BENCHMARK(resource_allocator, insert)
+{
+    bench_insert_lookup<Resource_Allocator<Bench_Resource>>(context, "paged");
+    bench_insert_lookup<bench::Vector_Resource_Allocator<Bench_Resource>>(context, "vector (baseline)");
+}
+
+template<typename T, typename T_Cold, typename Fn>
+static void bench_dispatch_lookup(bench::Context& context, const char* name, Fn&& get_pipeline)
+{
+    static constexpr uint32_t PIPELINE_COUNT = 4096;
+    auto allocator = std::make_unique<Resource_Allocator<T, T_Cold>>(PIPELINE_COUNT);
+    std::vector<Base_Resource_Handle<T>> handles;
+    for (uint32_t i = 0; i < PIPELINE_COUNT; ++i)
+    {
+        handles.push_back(allocator->emplace(0, 0).handle);
+        auto& pipeline = get_pipeline((*allocator)[handles.back()]);
+        pipeline.workgroups_x = 8 + i % 3;
+        pipeline.workgroups_y = 8;
+        pipeline.workgroups_z = 1;
+    }
+
+    std::mt19937 random(42);
+    std::uniform_int_distribution<uint32_t> distribution(0, PIPELINE_COUNT - 1);
+    std::vector<Base_Resource_Handle<T>> dispatches(context.iterations(1 << 22));
+    for (auto& dispatch : dispatches)
+    {
+        dispatch = handles[distribution(random)];
+    }
+
+    // Reads what set_pipeline_state and dispatch_div_by_workgroups read per dispatch.
+    uint64_t sum = 0;
+    bench::Timer timer;
+    for (auto dispatch : dispatches)
+    {
+        const auto& pipeline = get_pipeline((*allocator)[dispatch]);
+        sum += uint64_t(uintptr_t(pipeline.pso)) + (1920 + pipeline.workgroups_x - 1) / pipeline.workgroups_x
+            + (1080 + pipeline.workgroups_y - 1) / pipeline.workgroups_y;
+    }
+    context.report_rate(name, dispatches.size(), timer.seconds());
+    context.consume(sum);
+}
+
+OWGE_BENCHMARK(resource_allocator, dispatch_lookup)
+{
+    bench_dispatch_lookup<Bench_Pipeline, Bench_Pipeline_Desc>(context, "hot/cold split",
+        [](Bench_Pipeline& pipeline) -> Bench_Pipeline& { return pipeline; });
+    bench_dispatch_lookup<Bench_Pipeline_Record, No_Cold_Data>(context, "single record",
+        [](Bench_Pipeline_Record& record) -> Bench_Pipeline& { return record.pipeline; });
+}
+
+OWGE_BENCHMARK(resource_allocator, concurrent_scaling)
+{
+    auto max_thread_count = std::max(4u, std::thread::hardware_concurrency());
+    auto iteration_count = context.iterations(1 << 20);
+    for (uint32_t thread_count = 1; thread_count <= max_thread_count; thread_count *= 2)
+    {
+        Resource_Allocator<Bench_Resource> allocator(thread_count * 64);
+        std::vector<std::jthread> threads;
+        bench::Timer timer;
+        for (uint32_t thread = 0; thread < thread_count; ++thread)
+        {
+            threads.emplace_back([&]() {
+                Base_Resource_Handle<Bench_Resource> handles[64];
+                for (uint64_t i = 0; i < iteration_count; ++i)
+                {
+                    auto& handle = handles[i % 64];
+                    if (i >= 64)
+                    {
+                        allocator.remove(handle);
+                    }
+                    handle = allocator.insert(0, 0, { .values = { i } });
+                }
+            });
+        }
+        threads.clear();
+        auto metric = std::to_string(thread_count) + " thread insert+remove";
+        context.report_rate(metric.c_str(), thread_count * iteration_count, timer.seconds());
+    }
+}
+}
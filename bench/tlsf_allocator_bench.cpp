@@ -0,0 +1,56 @@
+#include "bench.hpp"
+
+#include <owge_common/tlsf_allocator.hpp>
+
+#include <random>
+#include <vector>
+
+namespace owge
+{
+// Descriptor ranges are 1 to 16 descriptors for buffers and mip chains, and up to 64 for bindsets.
+OWGE_BENCHMARK(tlsf_allocator, descriptor_ranges)
+{
+    static constexpr uint32_t HEAP_SIZE = 1000000;
+    Tlsf_Allocator allocator(HEAP_SIZE);
+    std::mt19937 random(42);
+    std::vector<Tlsf_Allocation> allocations;
+    auto operation_count = context.iterations(4000000);
+    uint64_t failed_count = 0;
+
+    uint64_t used_size = 0;
+    bench::Timer timer;
+    for (uint64_t i = 0; i < operation_count; ++i)
+    {
+        // Fills the heap to 80% and then churns around that level.
+        if (used_size > HEAP_SIZE * 8 / 10 || (used_size > HEAP_SIZE * 7 / 10 && random() % 2 == 0))
+        {
+            auto index = random() % allocations.size();
+            used_size -= allocations[index].size;
+            allocator.free(allocations[index]);
+            allocations[index] = allocations.back();
+            allocations.pop_back();
+            continue;
+        }
+        auto size = random() % 8 == 0 ? 1 + random() % 64 : 1 + random() % 16;
+        auto allocation = allocator.allocate(size);
+        if (allocation.is_valid())
+        {
+            used_size += allocation.size;
+            allocations.push_back(allocation);
+        }
+        else
+        {
+            failed_count += 1;
+        }
+    }
+    context.report_rate("allocate+free", operation_count, timer.seconds());
+
+    auto stats = allocator.get_stats();
+    auto free_size = stats.total_size - stats.used_size;
+    context.report("used", 100.0 * double(stats.used_size) / double(stats.total_size), "%");
+    context.report("free blocks", double(stats.free_block_count), "blocks");
+    context.report("fragmentation", free_size > 0
+        ? 100.0 * (1.0 - double(stats.largest_free_block) / double(free_size)) : 0.0, "%");
+    context.report("failed allocations", double(failed_count), "allocations");
+}
+}
@@ -92,3 +92,33 @@ function(add_owge_exe TARGET)
     add_executable(${TARGET})
     setup_owge_target(${TARGET})
 endfunction()
+
+function(add_owge_test_target TARGET DIRECTORY)
+    add_executable(${TARGET})
+    set_target_default_properties(${TARGET})
+    add_subdirectory(${DIRECTORY})
+    target_group_file_tree(${TARGET})
+    if(NOT MSVC)
+        target_compile_options(${TARGET} PRIVATE -Wall -Wextra -Werror)
+    endif()
+    find_package(Threads REQUIRED)
+    target_include_directories(
+        ${TARGET} PRIVATE
+        ${CMAKE_CURRENT_SOURCE_DIR}/${DIRECTORY}
+        ${CMAKE_CURRENT_SOURCE_DIR}/owge_render_engine
+    )
+    target_link_libraries(
+        ${TARGET} PRIVATE
+        owge_common
+        Threads::Threads
+    )
+endfunction()
+
+# Tests and benchmarks only cover code without API dependencies, so they also build on other platforms.
+# Sources of owge_render_engine that don't depend on D3D12 are compiled into them directly.
+function(add_owge_tests)
+    if(OWGE_BUILD_TESTS)
+        add_owge_test_target(owge_tests tests)
+        add_owge_test_target(owge_bench bench)
+    endif()
+endfunction()
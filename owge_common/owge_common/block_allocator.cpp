@@ -0,0 +1,101 @@
+#include "owge_common/block_allocator.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace owge
+{
+Block_Allocator::Block_Allocator(uint64_t block_size)
+    : m_block_size(block_size)
+    , m_block_count(0)
+    , m_blocks()
+{}
+
+Block_Allocation Block_Allocator::allocate(uint64_t size, uint64_t alignment)
+{
+    Block_Allocation result = {
+        .block = BLOCK_NO_ALLOCATION,
+        .node = TLSF_NO_ALLOCATION,
+        .offset = 0,
+        .size = 0
+    };
+    if (size == 0 || size > m_block_size)
+    {
+        return result;
+    }
+
+    for (uint32_t block = 0; block < uint32_t(m_blocks.size()); ++block)
+    {
+        if (!m_blocks[block])
+        {
+            continue;
+        }
+        auto allocation = m_blocks[block]->allocate(size, alignment);
+        if (allocation.is_valid())
+        {
+            result.block = block;
+            result.node = allocation.node;
+            result.offset = allocation.offset;
+            result.size = allocation.size;
+            return result;
+        }
+    }
+    return result;
+}
+
+uint32_t Block_Allocator::add_block()
+{
+    m_block_count += 1;
+    auto slot = std::ranges::find_if(m_blocks, [](const auto& block) { return !block; });
+    if (slot != m_blocks.end())
+    {
+        *slot = std::make_unique<Tlsf_Allocator>(m_block_size);
+        return uint32_t(slot - m_blocks.begin());
+    }
+    m_blocks.push_back(std::make_unique<Tlsf_Allocator>(m_block_size));
+    return uint32_t(m_blocks.size() - 1);
+}
+
+void Block_Allocator::remove_block(uint32_t block)
+{
+    assert(m_blocks[block] && m_blocks[block]->empty());
+    m_blocks[block].reset();
+    m_block_count -= 1;
+}
+
+bool Block_Allocator::free(const Block_Allocation& allocation)
+{
+    if (!allocation.is_valid())
+    {
+        return false;
+    }
+    auto& block = m_blocks[allocation.block];
+    block->free(allocation.node);
+    return block->empty() && m_block_count > 1;
+}
+
+Block_Allocator_Stats Block_Allocator::get_stats() const
+{
+    Block_Allocator_Stats stats = {
+        .block_size = m_block_size,
+        .used_size = 0,
+        .largest_free_block = 0,
+        .block_count = m_block_count,
+        .allocation_count = 0,
+        .free_block_count = 0
+    };
+    for (const auto& block : m_blocks)
+    {
+        if (!block)
+        {
+            continue;
+        }
+        auto block_stats = block->get_stats();
+        stats.used_size += block_stats.used_size;
+        stats.largest_free_block = std::max(stats.largest_free_block, block_stats.largest_free_block);
+        stats.allocation_count += block_stats.allocation_count;
+        stats.free_block_count += block_stats.free_block_count;
+    }
+    return stats;
+}
+}
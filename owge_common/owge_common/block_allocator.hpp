@@ -0,0 +1,65 @@
+#pragma once
+
+#include "owge_common/tlsf_allocator.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace owge
+{
+static constexpr uint32_t BLOCK_NO_ALLOCATION = ~0u;
+
+struct Block_Allocation
+{
+    uint32_t block;
+    uint32_t node;
+    uint64_t offset;
+    uint64_t size;
+
+    [[nodiscard]] bool is_valid() const
+    {
+        return block != BLOCK_NO_ALLOCATION;
+    }
+};
+
+struct Block_Allocator_Stats
+{
+    uint64_t block_size;
+    uint64_t used_size;
+    uint64_t largest_free_block;
+    uint32_t block_count;
+    uint32_t allocation_count;
+    uint32_t free_block_count;
+};
+
+// Suballocates from a growing set of equally sized blocks, each of which is managed by a Tlsf_Allocator.
+// Blocks are abstract, the caller owns whatever memory backs them:
+// when allocate fails it calls add_block, creates the backing memory for the returned block and retries,
+// when free reports an empty block it releases the backing memory and calls remove_block.
+// Not thread-safe.
+class Block_Allocator
+{
+public:
+    Block_Allocator(uint64_t block_size);
+
+    [[nodiscard]] Block_Allocation allocate(uint64_t size, uint64_t alignment = 1);
+    [[nodiscard]] uint32_t add_block();
+    void remove_block(uint32_t block);
+
+    // Returns true if the allocation's block is now empty and can be removed.
+    // The last remaining block is never reported so that alternating allocations don't thrash it.
+    [[nodiscard]] bool free(const Block_Allocation& allocation);
+
+    [[nodiscard]] uint64_t block_size() const
+    {
+        return m_block_size;
+    }
+    [[nodiscard]] Block_Allocator_Stats get_stats() const;
+
+private:
+    uint64_t m_block_size;
+    uint32_t m_block_count;
+    std::vector<std::unique_ptr<Tlsf_Allocator>> m_blocks;
+};
+}
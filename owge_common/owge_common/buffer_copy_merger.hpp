@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace owge
+{
+// Merges buffer copies that are contiguous in both their source and their destination.
+// `T` needs `src`, `src_offset`, `dst`, `dst_offset` and `size` members, `src` and `dst` are compared as is.
+// Sorting by destination lines up neighbouring ranges. The copies may only be reordered if no two of them
+// write the same bytes, otherwise only neighbours in submission order are merged so the last write still wins.
+// Calls `record` once per merged copy and returns how many it recorded. `sorted` is scratch space.
+template<typename T, typename Fn>
+uint32_t merge_buffer_copies(const std::vector<T>& copies, std::vector<T>& sorted, Fn&& record)
+{
+    sorted.assign(copies.begin(), copies.end());
+    std::ranges::stable_sort(sorted, [](const T& a, const T& b) {
+        return a.dst != b.dst
+            ? std::less<decltype(a.dst)>()(a.dst, b.dst)
+            : a.dst_offset < b.dst_offset;
+    });
+    auto overlap = std::ranges::adjacent_find(sorted, [](const T& a, const T& b) {
+        return a.dst == b.dst && a.dst_offset + a.size > b.dst_offset;
+    });
+    const auto& ordered = overlap == sorted.end() ? sorted : copies;
+
+    uint32_t merged_count = 0;
+    for (uint32_t i = 0; i < uint32_t(ordered.size());)
+    {
+        auto merged = ordered[i];
+        for (i += 1; i < uint32_t(ordered.size()); ++i)
+        {
+            const auto& next = ordered[i];
+            if (next.src != merged.src ||
+                next.dst != merged.dst ||
+                next.src_offset != merged.src_offset + merged.size ||
+                next.dst_offset != merged.dst_offset + merged.size)
+            {
+                break;
+            }
+            merged.size += next.size;
+        }
+        record(merged);
+        merged_count += 1;
+    }
+    return merged_count;
+}
+}
@@ -0,0 +1,365 @@
+#include "owge_common/command_stream.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <utility>
+
+namespace owge
+{
+// Slots of the state packets that replace the previous packet of their type, constants are shadowed per dword.
+enum State_Slot : uint32_t
+{
+    STATE_SLOT_PIPELINE,
+    STATE_SLOT_INDEX_BUFFER,
+    STATE_SLOT_PRIMITIVE_TOPOLOGY,
+    STATE_SLOT_RENDER_TARGETS,
+    STATE_SLOT_VIEWPORT,
+    STATE_SLOT_SCISSOR,
+    STATE_SLOT_COUNT
+};
+
+static constexpr uint32_t NO_STATE_SLOT = ~0u;
+
+struct Sort_State
+{
+    std::array<const Command_Header*, STATE_SLOT_COUNT> packets;
+    // Compute and graphics constants.
+    std::array<std::array<uint32_t, COMMAND_STREAM_MAX_CONSTANTS>, 2> constants;
+    std::array<uint64_t, 2> set_constants;
+};
+
+struct Sort_Run
+{
+    uint64_t pipeline;
+    const Command_Header* work;
+    Sort_State state;
+};
+
+[[nodiscard]] static uint32_t get_payload_size(Command_Type type)
+{
+    switch (type)
+    {
+    case Command_Type::Set_Pipeline_State:
+        return sizeof(Command_Set_Pipeline_State);
+    case Command_Type::Set_Constants:
+        return sizeof(Command_Set_Constants);
+    case Command_Type::Set_Index_Buffer:
+        return sizeof(Command_Set_Index_Buffer);
+    case Command_Type::Set_Primitive_Topology:
+        return sizeof(Command_Set_Primitive_Topology);
+    case Command_Type::Set_Render_Targets:
+        return sizeof(Command_Set_Render_Targets);
+    case Command_Type::Set_Viewport:
+        return sizeof(Command_Set_Viewport);
+    case Command_Type::Set_Scissor:
+        return sizeof(Command_Set_Scissor);
+    case Command_Type::Dispatch:
+    case Command_Type::Dispatch_Mesh:
+        return sizeof(Command_Dispatch);
+    case Command_Type::Draw:
+        return sizeof(Command_Draw);
+    case Command_Type::Draw_Indexed:
+        return sizeof(Command_Draw_Indexed);
+    case Command_Type::Clear_Render_Target:
+        return sizeof(Command_Clear_Render_Target);
+    case Command_Type::Clear_Depth_Stencil:
+        return sizeof(Command_Clear_Depth_Stencil);
+    case Command_Type::Barrier:
+        return sizeof(Command_Barrier);
+    case Command_Type::Begin_Event:
+    case Command_Type::Set_Marker:
+        return sizeof(Command_Event);
+    default:
+        return 0;
+    }
+}
+
+[[nodiscard]] static uint32_t get_state_slot(Command_Type type)
+{
+    switch (type)
+    {
+    case Command_Type::Set_Pipeline_State:
+        return STATE_SLOT_PIPELINE;
+    case Command_Type::Set_Index_Buffer:
+        return STATE_SLOT_INDEX_BUFFER;
+    case Command_Type::Set_Primitive_Topology:
+        return STATE_SLOT_PRIMITIVE_TOPOLOGY;
+    case Command_Type::Set_Render_Targets:
+        return STATE_SLOT_RENDER_TARGETS;
+    case Command_Type::Set_Viewport:
+        return STATE_SLOT_VIEWPORT;
+    case Command_Type::Set_Scissor:
+        return STATE_SLOT_SCISSOR;
+    default:
+        return NO_STATE_SLOT;
+    }
+}
+
+[[nodiscard]] static bool is_work(Command_Type type)
+{
+    return type >= Command_Type::Dispatch && type <= Command_Type::Draw_Indexed;
+}
+
+// The header's padding isn't initialized, only the zeroed payload is compared.
+[[nodiscard]] static bool is_same_packet(const Command_Header& a, const Command_Header& b)
+{
+    return a.type == b.type && a.size == b.size &&
+        std::memcmp(&a + 1, &b + 1, a.size - sizeof(Command_Header)) == 0;
+}
+
+[[nodiscard]] static uint64_t get_constant_bits(const Command_Set_Constants& constants)
+{
+    return constants.count == 0 ? 0 : (~0ull >> (64 - constants.count)) << constants.first_constant;
+}
+
+// Whether the packet sets a slot or constant for the first time in the stream, work recorded before
+// it may depend on the value set before the stream started.
+[[nodiscard]] static bool is_first_set(const Sort_State& state, const Command_Header& header)
+{
+    if (header.type != Command_Type::Set_Constants)
+    {
+        return state.packets[get_state_slot(header.type)] == nullptr;
+    }
+    auto& constants = Command_Stream::get_payload<Command_Set_Constants>(header);
+    auto bits = get_constant_bits(constants);
+    return (state.set_constants[constants.graphics ? 1 : 0] & bits) != bits;
+}
+
+static void apply_state(Sort_State& state, const Command_Header& header)
+{
+    if (header.type != Command_Type::Set_Constants)
+    {
+        state.packets[get_state_slot(header.type)] = &header;
+        return;
+    }
+    auto& constants = Command_Stream::get_payload<Command_Set_Constants>(header);
+    auto side = constants.graphics ? 1 : 0;
+    std::memcpy(state.constants[side].data() + constants.first_constant,
+        Command_Stream::get_trailing_data<Command_Set_Constants>(header), constants.count * sizeof(uint32_t));
+    state.set_constants[side] |= get_constant_bits(constants);
+}
+
+Command_Stream::Command_Stream(uint32_t chunk_size)
+    : m_chunk_size(chunk_size)
+{}
+
+bool Command_Stream::validate(uint32_t& open_event_count) const
+{
+    bool valid = true;
+    uint32_t packet_count = 0;
+    for_each([&](const Command_Header& header) {
+        packet_count += 1;
+        if (header.type >= Command_Type::Count || header.size % 8 != 0 ||
+            header.size < sizeof(Command_Header) + get_payload_size(header.type))
+        {
+            valid = false;
+            return;
+        }
+        auto trailing_size = header.size - uint32_t(sizeof(Command_Header));
+        switch (header.type)
+        {
+        case Command_Type::Set_Constants:
+        {
+            auto& constants = get_payload<Command_Set_Constants>(header);
+            trailing_size -= get_trailing_offset<Command_Set_Constants>();
+            valid &= constants.first_constant + constants.count <= COMMAND_STREAM_MAX_CONSTANTS
+                && constants.count * sizeof(uint32_t) <= trailing_size;
+            break;
+        }
+        case Command_Type::Set_Render_Targets:
+            valid &= get_payload<Command_Set_Render_Targets>(header).render_target_count
+                <= COMMAND_STREAM_MAX_RENDER_TARGETS;
+            break;
+        case Command_Type::Begin_Event:
+        case Command_Type::Set_Marker:
+        {
+            auto length = get_payload<Command_Event>(header).length;
+            trailing_size -= get_trailing_offset<Command_Event>();
+            valid &= length < trailing_size && get_trailing_data<Command_Event>(header)[length] == std::byte(0);
+            open_event_count += header.type == Command_Type::Begin_Event ? 1 : 0;
+            break;
+        }
+        case Command_Type::End_Event:
+            valid &= open_event_count > 0;
+            open_event_count -= open_event_count > 0 ? 1 : 0;
+            break;
+        default:
+            break;
+        }
+    });
+    return valid && packet_count == m_packet_count;
+}
+
+void Command_Stream::sort_by_pipeline()
+{
+    std::vector<const Command_Header*> packets;
+    packets.reserve(m_packet_count);
+    for_each([&](const Command_Header& header) {
+        packets.push_back(&header);
+    });
+
+    // Packets are copied into a second stream that replaces this one, the state pointers refer to this one.
+    Command_Stream sorted(m_chunk_size);
+    std::swap(sorted.m_chunks, m_sort_chunks);
+    sorted.reset();
+    Sort_State recorded = {};
+    Sort_State emitted = {};
+    std::vector<Sort_Run> runs;
+    auto emit_state = [&](const Sort_State& state) {
+        for (uint32_t slot = 0; slot < STATE_SLOT_COUNT; ++slot)
+        {
+            auto packet = state.packets[slot];
+            if (packet != nullptr &&
+                (emitted.packets[slot] == nullptr || !is_same_packet(*packet, *emitted.packets[slot])))
+            {
+                sorted.copy(*packet);
+                emitted.packets[slot] = packet;
+            }
+        }
+        for (uint32_t side = 0; side < 2; ++side)
+        {
+            auto& constants = state.constants[side];
+            auto& emitted_constants = emitted.constants[side];
+            uint64_t dirty = 0;
+            for (auto bits = state.set_constants[side]; bits != 0; bits &= bits - 1)
+            {
+                auto i = uint32_t(std::countr_zero(bits));
+                if ((emitted.set_constants[side] & (1ull << i)) == 0 || constants[i] != emitted_constants[i])
+                {
+                    dirty |= 1ull << i;
+                }
+            }
+            while (dirty != 0)
+            {
+                auto first = uint32_t(std::countr_zero(dirty));
+                auto count = uint32_t(std::countr_one(dirty >> first));
+                auto& packet = sorted.push<Command_Set_Constants>(Command_Type::Set_Constants,
+                    count * sizeof(uint32_t));
+                packet = {
+                    .first_constant = first,
+                    .count = count,
+                    .graphics = side == 1
+                };
+                std::memcpy(get_trailing_data(packet), constants.data() + first, count * sizeof(uint32_t));
+                std::copy(constants.begin() + first, constants.begin() + first + count,
+                    emitted_constants.begin() + first);
+                emitted.set_constants[side] |= get_constant_bits(packet);
+                dirty &= ~get_constant_bits(packet);
+            }
+        }
+    };
+    // Runs carry a copy of the state, sorting their indices avoids moving them.
+    std::vector<uint32_t> run_order;
+    auto sort_runs = [&]() {
+        run_order.resize(runs.size());
+        for (uint32_t i = 0; i < uint32_t(runs.size()); ++i)
+        {
+            run_order[i] = i;
+        }
+        std::ranges::stable_sort(run_order, {}, [&](uint32_t i) { return runs[i].pipeline; });
+        for (auto i : run_order)
+        {
+            emit_state(runs[i].state);
+            sorted.copy(*runs[i].work);
+        }
+        runs.clear();
+        // Packets after the runs expect the state at their end.
+        emit_state(recorded);
+    };
+
+    for (auto packet : packets)
+    {
+        if (packet->type == Command_Type::Set_Constants || get_state_slot(packet->type) != NO_STATE_SLOT)
+        {
+            // Sorted work can't restore the state from before the stream, so the work that may use it
+            // stays in front of the first packet that replaces it.
+            if (is_first_set(recorded, *packet))
+            {
+                sort_runs();
+            }
+            apply_state(recorded, *packet);
+        }
+        else if (is_work(packet->type))
+        {
+            auto pipeline = recorded.packets[STATE_SLOT_PIPELINE];
+            runs.push_back({
+                .pipeline = pipeline != nullptr ? get_payload<Command_Set_Pipeline_State>(*pipeline).pipeline : 0,
+                .work = packet,
+                .state = recorded
+            });
+        }
+        else
+        {
+            sort_runs();
+            sorted.copy(*packet);
+        }
+    }
+    sort_runs();
+    std::swap(m_chunks, sorted.m_chunks);
+    std::swap(m_current_chunk, sorted.m_current_chunk);
+    std::swap(m_packet_count, sorted.m_packet_count);
+    std::swap(m_sort_chunks, sorted.m_chunks);
+}
+
+void Command_Stream::reset()
+{
+    for (auto& chunk : m_chunks)
+    {
+        chunk.used = 0;
+    }
+    m_current_chunk = 0;
+    m_packet_count = 0;
+}
+
+uint64_t Command_Stream::get_size() const
+{
+    uint64_t size = 0;
+    for (const auto& chunk : m_chunks)
+    {
+        size += chunk.used;
+    }
+    return size;
+}
+
+void* Command_Stream::allocate(Command_Type type, uint32_t payload_size)
+{
+    auto size = (uint32_t(sizeof(Command_Header)) + payload_size + 7) & ~7u;
+    if (m_chunks.empty() || m_chunks[m_current_chunk].used + size > m_chunks[m_current_chunk].capacity)
+    {
+        if (!m_chunks.empty())
+        {
+            m_current_chunk += 1;
+        }
+        // Reused chunks that are too small for an oversized packet are replaced.
+        if (m_current_chunk == m_chunks.size())
+        {
+            m_chunks.emplace_back();
+        }
+        auto& chunk = m_chunks[m_current_chunk];
+        if (chunk.capacity < size)
+        {
+            chunk.capacity = (std::max(m_chunk_size, size) + 7) & ~7u;
+            chunk.data = std::make_unique_for_overwrite<uint64_t[]>(chunk.capacity / sizeof(uint64_t));
+        }
+        chunk.used = 0;
+    }
+    auto& chunk = m_chunks[m_current_chunk];
+    auto header = new (reinterpret_cast<std::byte*>(chunk.data.get()) + chunk.used) Command_Header{
+        .type = type,
+        .size = size
+    };
+    // Zeroed padding keeps identical packets bitwise equal, see `is_same_packet`.
+    std::memset(header + 1, 0, size - sizeof(Command_Header));
+    chunk.used += size;
+    m_packet_count += 1;
+    return header + 1;
+}
+
+void Command_Stream::copy(const Command_Header& header)
+{
+    auto payload = allocate(header.type, header.size - uint32_t(sizeof(Command_Header)));
+    std::memcpy(payload, &header + 1, header.size - sizeof(Command_Header));
+}
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace owge
+{
+static constexpr uint32_t COMMAND_STREAM_MAX_CONSTANTS = 64;
+static constexpr uint32_t COMMAND_STREAM_MAX_RENDER_TARGETS = 8;
+static constexpr uint32_t COMMAND_STREAM_DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+enum class Command_Type : uint8_t
+{
+    // State, sorting may move and drop these as long as every work packet sees the state it was recorded with.
+    Set_Pipeline_State,
+    Set_Constants,
+    Set_Index_Buffer,
+    Set_Primitive_Topology,
+    Set_Render_Targets,
+    Set_Viewport,
+    Set_Scissor,
+    // Work
+    Dispatch,
+    Dispatch_Mesh,
+    Draw,
+    Draw_Indexed,
+    // Everything else keeps its position, work is never sorted across it.
+    Clear_Render_Target,
+    Clear_Depth_Stencil,
+    Barrier,
+    Begin_Event,
+    End_Event,
+    Set_Marker,
+    Count
+};
+
+// `size` includes the header, the payload and any trailing data and is a multiple of 8.
+struct Command_Header
+{
+    Command_Type type;
+    uint32_t size;
+};
+
+// Resources, pipelines and swapchains are opaque 64 bit values, resolving them is up to the translator.
+struct Command_Set_Pipeline_State
+{
+    uint64_t pipeline;
+};
+
+// Followed by `count` 32 bit constants.
+struct Command_Set_Constants
+{
+    uint32_t first_constant;
+    uint32_t count;
+    bool graphics;
+};
+
+struct Command_Set_Index_Buffer
+{
+    uint64_t buffer;
+    bool uint16_indices;
+};
+
+struct Command_Set_Primitive_Topology
+{
+    uint32_t topology;
+};
+
+// The swapchain's current image is the only render target if `swapchain` isn't 0.
+struct Command_Set_Render_Targets
+{
+    uint64_t swapchain;
+    uint64_t render_targets[COMMAND_STREAM_MAX_RENDER_TARGETS];
+    uint64_t depth_stencil;
+    uint32_t render_target_count;
+    bool has_depth_stencil;
+};
+
+struct Command_Set_Viewport
+{
+    float x;
+    float y;
+    float width;
+    float height;
+    float min_depth;
+    float max_depth;
+};
+
+struct Command_Set_Scissor
+{
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+};
+
+// Dispatch and Dispatch_Mesh.
+struct Command_Dispatch
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t z;
+};
+
+struct Command_Draw
+{
+    uint32_t vertex_count;
+    uint32_t vertex_offset;
+    uint32_t instance_count;
+    uint32_t instance_offset;
+};
+
+struct Command_Draw_Indexed
+{
+    uint32_t index_count;
+    uint32_t index_offset;
+    uint32_t instance_count;
+    uint32_t instance_offset;
+    uint32_t base_vertex;
+};
+
+// The swapchain's current image is cleared if `swapchain` isn't 0.
+struct Command_Clear_Render_Target
+{
+    uint64_t swapchain;
+    uint64_t texture;
+    float color[4];
+};
+
+struct Command_Clear_Depth_Stencil
+{
+    uint64_t texture;
+    uint32_t flags;
+    float depth;
+    uint8_t stencil;
+};
+
+// Followed by the backend's texture, buffer and global barrier descriptions in that order.
+struct Command_Barrier
+{
+    uint32_t texture_barrier_count;
+    uint32_t buffer_barrier_count;
+    uint32_t global_barrier_count;
+};
+
+// Begin_Event and Set_Marker, followed by `length` characters and a null terminator.
+struct Command_Event
+{
+    uint32_t length;
+};
+
+// Packets that are recorded into a list of linearly allocated chunks and replayed onto an API by a translator.
+// Chunks are kept when the stream is reset, so recording and sorting allocate only until the stream has grown
+// to the size of the largest frame. Not thread-safe.
+class Command_Stream
+{
+public:
+    Command_Stream(uint32_t chunk_size = COMMAND_STREAM_DEFAULT_CHUNK_SIZE);
+
+    // Returns the zeroed payload, followed by `trailing_size` bytes starting at `get_trailing_data`. State
+    // packets should be filled field by field, assigning a braced payload may overwrite the zeroed padding
+    // `sort_by_pipeline` compares.
+    template<typename T>
+    T& push(Command_Type type, uint32_t trailing_size = 0)
+    {
+        return *new (allocate(type, get_trailing_offset<T>() + trailing_size)) T{};
+    }
+    void push(Command_Type type)
+    {
+        allocate(type, 0);
+    }
+
+    template<typename T>
+    [[nodiscard]] static const T& get_payload(const Command_Header& header)
+    {
+        return *std::launder(reinterpret_cast<const T*>(&header + 1));
+    }
+    template<typename T>
+    [[nodiscard]] static const std::byte* get_trailing_data(const Command_Header& header)
+    {
+        return reinterpret_cast<const std::byte*>(&header + 1) + get_trailing_offset<T>();
+    }
+    template<typename T>
+    [[nodiscard]] static std::byte* get_trailing_data(T& payload)
+    {
+        return reinterpret_cast<std::byte*>(&payload) + get_trailing_offset<T>();
+    }
+
+    template<typename Fn>
+    void for_each(Fn&& fn) const
+    {
+        for (uint32_t i = 0; i <= m_current_chunk && i < m_chunks.size(); ++i)
+        {
+            auto data = reinterpret_cast<const std::byte*>(m_chunks[i].data.get());
+            for (uint32_t offset = 0; offset < m_chunks[i].used;)
+            {
+                auto& header = *reinterpret_cast<const Command_Header*>(data + offset);
+                fn(header);
+                offset += header.size;
+            }
+        }
+    }
+
+    // Checks the packet sizes and contents the translator relies on and that no End_Event packet is
+    // unmatched. `open_event_count` carries the events left open by previously validated streams.
+    [[nodiscard]] bool validate(uint32_t& open_event_count) const;
+    // Reorders the work between two packets that aren't state or work by pipeline, keeping the record order
+    // of work using the same pipeline. State is re-emitted where it differs from the state the work was
+    // recorded with, redundant state is dropped. State set for the first time in the stream also ends the
+    // reordered range, the work before it may use state set before the stream started. Only valid if the
+    // reordered work doesn't depend on its order, which draws blending into the same render target do.
+    void sort_by_pipeline();
+    void reset();
+
+    [[nodiscard]] bool empty() const
+    {
+        return m_packet_count == 0;
+    }
+    [[nodiscard]] uint32_t get_packet_count() const
+    {
+        return m_packet_count;
+    }
+    [[nodiscard]] uint64_t get_size() const;
+
+private:
+    struct Chunk
+    {
+        std::unique_ptr<uint64_t[]> data;
+        uint32_t capacity;
+        uint32_t used;
+    };
+
+    template<typename T>
+    [[nodiscard]] static constexpr uint32_t get_trailing_offset()
+    {
+        return (sizeof(T) + 7) & ~7u;
+    }
+
+    void* allocate(Command_Type type, uint32_t payload_size);
+    void copy(const Command_Header& header);
+
+private:
+    uint32_t m_chunk_size;
+    uint32_t m_current_chunk = 0;
+    uint32_t m_packet_count = 0;
+    std::vector<Chunk> m_chunks;
+    // The chunks `sort_by_pipeline` copies into, swapped with `m_chunks` so both sets are reused.
+    std::vector<Chunk> m_sort_chunks;
+};
+}
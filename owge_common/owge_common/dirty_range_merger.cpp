@@ -0,0 +1,26 @@
+#include "owge_common/dirty_range_merger.hpp"
+
+namespace owge
+{
+void merge_dirty_ranges(std::vector<Dirty_Range>& ranges)
+{
+    std::ranges::sort(ranges, [](const Dirty_Range& a, const Dirty_Range& b) {
+        return a.buffer != b.buffer
+            ? a.buffer < b.buffer
+            : a.begin < b.begin;
+    });
+    uint32_t merged_count = 0;
+    for (const auto& range : ranges)
+    {
+        if (merged_count > 0 &&
+            ranges[merged_count - 1].buffer == range.buffer &&
+            ranges[merged_count - 1].end >= range.begin)
+        {
+            ranges[merged_count - 1].end = std::max(ranges[merged_count - 1].end, range.end);
+            continue;
+        }
+        ranges[merged_count++] = range;
+    }
+    ranges.resize(merged_count);
+}
+}
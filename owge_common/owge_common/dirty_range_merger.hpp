@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace owge
+{
+// Byte range [begin, end) of a buffer that is identified by an opaque, caller defined key.
+struct Dirty_Range
+{
+    uint64_t buffer;
+    uint64_t begin;
+    uint64_t end;
+};
+
+// Sorts `ranges` by buffer and offset and merges the ones that overlap or touch.
+void merge_dirty_ranges(std::vector<Dirty_Range>& ranges);
+
+// Appends every page of `page_size` bytes that the merged `dirty_ranges` cover with at least
+// `dense_size` bytes to `pages`, clamped to the end of the buffer as returned by `get_buffer_size`.
+// Uploading such a page as a whole is cheaper than issuing a copy per dirty range in it.
+template<typename Fn>
+void append_dense_pages(const std::vector<Dirty_Range>& dirty_ranges, uint64_t page_size, uint64_t dense_size,
+    Fn&& get_buffer_size, std::vector<Dirty_Range>& pages)
+{
+    const Dirty_Range* page_range = nullptr;
+    uint64_t page = ~0ull;
+    uint64_t page_dirty_size = 0;
+    auto flush_page = [&]() {
+        if (page_range != nullptr && page_dirty_size >= dense_size)
+        {
+            pages.push_back({
+                .buffer = page_range->buffer,
+                .begin = page * page_size,
+                .end = std::min((page + 1) * page_size, uint64_t(get_buffer_size(page_range->buffer)))
+            });
+        }
+    };
+    for (const auto& range : dirty_ranges)
+    {
+        for (auto begin = range.begin; begin < range.end;)
+        {
+            auto range_page = begin / page_size;
+            auto end = std::min(range.end, (range_page + 1) * page_size);
+            if (page_range == nullptr || range.buffer != page_range->buffer || range_page != page)
+            {
+                flush_page();
+                page_range = &range;
+                page = range_page;
+                page_dirty_size = 0;
+            }
+            page_dirty_size += end - begin;
+            begin = end;
+        }
+    }
+    flush_page();
+}
+}
@@ -0,0 +1,98 @@
+#include "owge_common/fence_ring_allocator.hpp"
+
+#include <algorithm>
+
+namespace owge
+{
+Fence_Ring_Allocator::Fence_Ring_Allocator(uint64_t capacity)
+    : m_capacity(capacity)
+    , m_head(0)
+    , m_tail(0)
+    , m_submitted_head(0)
+    , m_submissions()
+    , m_window_peak(0)
+    , m_last_window_peak(0)
+    , m_window_submit_count(0)
+    , m_has_full_window(false)
+{}
+
+uint64_t Fence_Ring_Allocator::allocate(uint64_t size, uint64_t alignment)
+{
+    alignment = std::max<uint64_t>(alignment, 1);
+    if (size == 0 || size > m_capacity)
+    {
+        return FENCE_RING_NO_ALLOCATION;
+    }
+
+    auto head = (m_head + alignment - 1) & ~(alignment - 1);
+    auto offset = head % m_capacity;
+    if (offset + size > m_capacity)
+    {
+        // Skip the remainder of the ring, it is reclaimed together with this allocation.
+        head += m_capacity - offset;
+        offset = 0;
+    }
+    if (head + size - m_tail > m_capacity)
+    {
+        return FENCE_RING_NO_ALLOCATION;
+    }
+
+    m_head = head + size;
+    return offset;
+}
+
+void Fence_Ring_Allocator::submit(uint64_t fence_value)
+{
+    if (m_head != m_submitted_head)
+    {
+        m_submissions.push_back({
+            .fence_value = fence_value,
+            .end = m_head
+        });
+        m_submitted_head = m_head;
+    }
+
+    m_window_peak = std::max(m_window_peak, used_size());
+    m_window_submit_count += 1;
+    if (m_window_submit_count == SHRINK_WINDOW)
+    {
+        m_last_window_peak = m_window_peak;
+        m_has_full_window = true;
+        m_window_peak = 0;
+        m_window_submit_count = 0;
+    }
+}
+
+void Fence_Ring_Allocator::reclaim(uint64_t completed_fence_value)
+{
+    while (!m_submissions.empty() && m_submissions.front().fence_value <= completed_fence_value)
+    {
+        m_tail = m_submissions.front().end;
+        m_submissions.pop_front();
+    }
+}
+
+void Fence_Ring_Allocator::reset(uint64_t capacity)
+{
+    m_capacity = capacity;
+    m_head = 0;
+    m_tail = 0;
+    m_submitted_head = 0;
+    m_submissions.clear();
+    m_window_peak = 0;
+    m_last_window_peak = 0;
+    m_window_submit_count = 0;
+    m_has_full_window = false;
+}
+
+uint64_t Fence_Ring_Allocator::get_shrink_capacity(uint64_t min_capacity) const
+{
+    if (!m_has_full_window ||
+        m_capacity / 2 < min_capacity ||
+        m_last_window_peak > m_capacity / 4)
+    {
+        return m_capacity;
+    }
+    return m_capacity / 2;
+}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+namespace owge
+{
+static constexpr uint64_t FENCE_RING_NO_ALLOCATION = ~0ull;
+
+// Ring allocator over an abstract range [0, capacity) for transient per-submission data.
+// Allocations are grouped by the fence value they are submitted with and their space is
+// reclaimed once that fence value has completed.
+// Alignments must be powers of two that divide the capacity. Not thread-safe.
+class Fence_Ring_Allocator
+{
+public:
+    static constexpr uint32_t SHRINK_WINDOW = 256;
+
+    Fence_Ring_Allocator(uint64_t capacity);
+
+    [[nodiscard]] uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+    // Closes all allocations made since the previous submit and tags them with `fence_value`.
+    // Fence values must increase monotonically.
+    void submit(uint64_t fence_value);
+    void reclaim(uint64_t completed_fence_value);
+    // Starts over with an empty ring, the caller has to keep the memory of pending allocations alive.
+    void reset(uint64_t capacity);
+
+    // Returns half the capacity once usage stayed at or below a quarter of it for a full
+    // SHRINK_WINDOW submits, never going below `min_capacity`. Otherwise returns the current capacity.
+    [[nodiscard]] uint64_t get_shrink_capacity(uint64_t min_capacity) const;
+
+    [[nodiscard]] uint64_t capacity() const
+    {
+        return m_capacity;
+    }
+    [[nodiscard]] uint64_t used_size() const
+    {
+        return m_head - m_tail;
+    }
+
+private:
+    struct Submission
+    {
+        uint64_t fence_value;
+        uint64_t end;
+    };
+
+    uint64_t m_capacity;
+    // Head and tail grow monotonically, the physical offset is taken modulo the capacity.
+    uint64_t m_head;
+    uint64_t m_tail;
+    uint64_t m_submitted_head;
+    std::deque<Submission> m_submissions;
+
+    uint64_t m_window_peak;
+    uint64_t m_last_window_peak;
+    uint32_t m_window_submit_count;
+    bool m_has_full_window;
+};
+}
@@ -1,6 +1,7 @@
 #include "owge_common/file_util.hpp"
 
 #include <fstream>
+#include <iterator>
 
 namespace owge
 {
@@ -0,0 +1,151 @@
+#include "owge_common/index_range_allocator.hpp"
+
+#include <cassert>
+
+namespace owge
+{
+static constexpr uint32_t NO_HEAD = ~0u;
+// Allocations of cached ranges encode their offset and count, TLSF nodes never reach the cached bit.
+static constexpr uint32_t CACHED_RANGE_BIT = 1u << 31;
+static constexpr uint32_t CACHED_RANGE_COUNT_SHIFT = 26;
+static constexpr uint32_t CACHED_RANGE_OFFSET_MASK = (1u << CACHED_RANGE_COUNT_SHIFT) - 1;
+// Ranges carved from the TLSF allocator at once when the list of a count runs empty.
+static constexpr uint32_t CACHED_RANGE_BATCH_SIZE = 64;
+
+static_assert(INDEX_RANGE_MAX_CACHED_COUNT <= (CACHED_RANGE_BIT >> CACHED_RANGE_COUNT_SHIFT));
+
+[[nodiscard]] static Index_Range make_cached_range(uint32_t offset, uint32_t count)
+{
+    return {
+        .offset = offset,
+        .count = count,
+        .allocation = CACHED_RANGE_BIT | ((count - 1) << CACHED_RANGE_COUNT_SHIFT) | offset
+    };
+}
+
+[[nodiscard]] static uint32_t pop_range(std::atomic<uint64_t>& head_slot, std::atomic<uint32_t>* next) noexcept
+{
+    uint64_t head = head_slot.load(std::memory_order_acquire);
+    while (uint32_t(head) != NO_HEAD)
+    {
+        auto new_head = (((head >> 32) + 1) << 32) | next[uint32_t(head)].load(std::memory_order_relaxed);
+        if (head_slot.compare_exchange_weak(head, new_head,
+            std::memory_order_acquire, std::memory_order_acquire))
+        {
+            return uint32_t(head);
+        }
+    }
+    return NO_HEAD;
+}
+
+static void push_range(std::atomic<uint64_t>& head_slot, std::atomic<uint32_t>* next, uint32_t offset) noexcept
+{
+    uint64_t head = head_slot.load(std::memory_order_relaxed);
+    do
+    {
+        next[offset].store(uint32_t(head), std::memory_order_relaxed);
+    } while (!head_slot.compare_exchange_weak(head, (head & 0xFFFFFFFF00000000ull) | offset,
+        std::memory_order_release, std::memory_order_relaxed));
+}
+
+Index_Range_Allocator::Index_Range_Allocator(uint32_t size)
+    : m_size(size)
+    , m_heads()
+    , m_next(std::make_unique<std::atomic<uint32_t>[]>(size))
+    , m_allocated_count(0)
+    , m_mutex()
+    , m_allocator(size)
+{
+    assert(size <= CACHED_RANGE_OFFSET_MASK + 1);
+    for (auto& head : m_heads)
+    {
+        head.store(NO_HEAD, std::memory_order_relaxed);
+    }
+}
+
+Index_Range Index_Range_Allocator::allocate(uint32_t count)
+{
+    Index_Range range = {
+        .offset = 0,
+        .count = 0,
+        .allocation = INDEX_RANGE_NO_ALLOCATION
+    };
+    if (count == 0)
+    {
+        return range;
+    }
+    if (count <= INDEX_RANGE_MAX_CACHED_COUNT)
+    {
+        auto offset = pop_range(m_heads[count - 1], m_next.get());
+        range = offset != NO_HEAD ? make_cached_range(offset, count) : allocate_batch(count);
+    }
+    else
+    {
+        std::scoped_lock lock(m_mutex);
+        auto allocation = m_allocator.allocate(count);
+        if (allocation.is_valid())
+        {
+            assert(allocation.node < CACHED_RANGE_BIT);
+            range = {
+                .offset = uint32_t(allocation.offset),
+                .count = count,
+                .allocation = allocation.node
+            };
+        }
+    }
+    if (range.is_valid())
+    {
+        m_allocated_count.fetch_add(count, std::memory_order_relaxed);
+    }
+    return range;
+}
+
+void Index_Range_Allocator::free(uint32_t allocation) noexcept
+{
+    if (allocation == INDEX_RANGE_NO_ALLOCATION)
+    {
+        return;
+    }
+    if ((allocation & CACHED_RANGE_BIT) != 0)
+    {
+        auto count = ((allocation & ~CACHED_RANGE_BIT) >> CACHED_RANGE_COUNT_SHIFT) + 1;
+        m_allocated_count.fetch_sub(count, std::memory_order_relaxed);
+        push_range(m_heads[count - 1], m_next.get(), allocation & CACHED_RANGE_OFFSET_MASK);
+        return;
+    }
+    std::scoped_lock lock(m_mutex);
+    m_allocated_count.fetch_sub(uint32_t(m_allocator.get_allocation_size(allocation)), std::memory_order_relaxed);
+    m_allocator.free(allocation);
+}
+
+Index_Range Index_Range_Allocator::allocate_batch(uint32_t count)
+{
+    std::scoped_lock lock(m_mutex);
+    // Another thread may have refilled the list while this one waited for the lock.
+    auto offset = pop_range(m_heads[count - 1], m_next.get());
+    if (offset != NO_HEAD)
+    {
+        return make_cached_range(offset, count);
+    }
+    // Smaller batches still fit when the allocator is nearly full.
+    for (auto batch_size = CACHED_RANGE_BATCH_SIZE; batch_size > 0; batch_size /= 2)
+    {
+        auto allocation = m_allocator.allocate(uint64_t(count) * batch_size);
+        if (!allocation.is_valid())
+        {
+            continue;
+        }
+        auto first = uint32_t(allocation.offset);
+        for (uint32_t i = 1; i < batch_size; ++i)
+        {
+            push_range(m_heads[count - 1], m_next.get(), first + i * count);
+        }
+        return make_cached_range(first, count);
+    }
+    return {
+        .offset = 0,
+        .count = 0,
+        .allocation = INDEX_RANGE_NO_ALLOCATION
+    };
+}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "owge_common/tlsf_allocator.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace owge
+{
+static constexpr uint32_t INDEX_RANGE_NO_ALLOCATION = ~0u;
+// Ranges up to this many indices are cached per count, descriptor tables of buffers and textures fit.
+static constexpr uint32_t INDEX_RANGE_MAX_CACHED_COUNT = 16;
+
+struct Index_Range
+{
+    uint32_t offset;
+    uint32_t count;
+    uint32_t allocation;
+
+    [[nodiscard]] bool is_valid() const
+    {
+        return allocation != INDEX_RANGE_NO_ALLOCATION;
+    }
+};
+
+// Allocates contiguous ranges of indices in [0, size) from multiple threads.
+// Ranges of up to INDEX_RANGE_MAX_CACHED_COUNT indices are popped from and pushed back onto lock-free free lists,
+// one per count. An empty list is refilled with a batch of ranges carved from a TLSF allocator under a mutex,
+// larger ranges always take the mutex. Cached ranges never return to the TLSF allocator, so memory freed in
+// one count is only reused by that count.
+class Index_Range_Allocator
+{
+public:
+    Index_Range_Allocator(uint32_t size);
+
+    // Returns an invalid range once no contiguous `count` indices are left.
+    [[nodiscard]] Index_Range allocate(uint32_t count);
+    void free(uint32_t allocation) noexcept;
+
+    [[nodiscard]] uint32_t size() const
+    {
+        return m_size;
+    }
+    [[nodiscard]] uint32_t get_allocated_count() const noexcept
+    {
+        return m_allocated_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    [[nodiscard]] Index_Range allocate_batch(uint32_t count);
+
+    uint32_t m_size;
+    // Heads pack the offset of the first free range with an ABA tag, m_next links free ranges by offset.
+    std::atomic<uint64_t> m_heads[INDEX_RANGE_MAX_CACHED_COUNT];
+    std::unique_ptr<std::atomic<uint32_t>[]> m_next;
+    std::atomic<uint32_t> m_allocated_count;
+    std::mutex m_mutex;
+    Tlsf_Allocator m_allocator;
+};
+}
@@ -0,0 +1,452 @@
+#include "owge_common/render_graph.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <iterator>
+#include <queue>
+
+namespace owge
+{
+static constexpr uint32_t WRITE_ACCESS_BITS =
+    get_render_graph_access_bit(Render_Graph_Access::Unordered_Access) |
+    get_render_graph_access_bit(Render_Graph_Access::Render_Target) |
+    get_render_graph_access_bit(Render_Graph_Access::Depth_Stencil_Write) |
+    get_render_graph_access_bit(Render_Graph_Access::Copy_Dest);
+static constexpr uint32_t ASYNC_COMPUTE_ACCESS_BITS =
+    get_render_graph_access_bit(Render_Graph_Access::Compute_Shader_Read) |
+    get_render_graph_access_bit(Render_Graph_Access::Unordered_Access) |
+    get_render_graph_access_bit(Render_Graph_Access::Copy_Source) |
+    get_render_graph_access_bit(Render_Graph_Access::Copy_Dest);
+
+[[nodiscard]] static bool is_write_access(Render_Graph_Access access)
+{
+    return (get_render_graph_access_bit(access) & WRITE_ACCESS_BITS) != 0;
+}
+
+// Copies overwrite the destination range completely, every other write may depend on the previous contents,
+// e.g. through depth testing, blending or read-modify-write.
+[[nodiscard]] static bool depends_on_previous_contents(Render_Graph_Access access)
+{
+    return access != Render_Graph_Access::Copy_Dest;
+}
+
+// Shader reads from different stages share a texture layout, every other access has its own.
+[[nodiscard]] static Render_Graph_Access get_texture_layout_access(Render_Graph_Access access)
+{
+    switch (access)
+    {
+    case Render_Graph_Access::Vertex_Shader_Read:
+    case Render_Graph_Access::Pixel_Shader_Read:
+    case Render_Graph_Access::Compute_Shader_Read:
+        return Render_Graph_Access::Compute_Shader_Read;
+    default:
+        return access;
+    }
+}
+
+[[nodiscard]] static uint8_t get_queue_bit(Render_Graph_Queue queue)
+{
+    return uint8_t(1u << uint32_t(queue));
+}
+
+uint32_t Render_Graph::add_resource(const Render_Graph_Resource_Desc& desc)
+{
+    m_resources.push_back(desc);
+    return uint32_t(m_resources.size() - 1);
+}
+
+uint32_t Render_Graph::add_pass(const Render_Graph_Pass_Desc& desc)
+{
+    m_passes.push_back(desc);
+    return uint32_t(m_passes.size() - 1);
+}
+
+void Render_Graph::use(uint32_t pass, uint32_t resource, Render_Graph_Access access)
+{
+    assert(pass < m_passes.size());
+    assert(resource < m_resources.size());
+    assert(access != Render_Graph_Access::None);
+    m_usages.push_back({
+        .pass = pass,
+        .resource = resource,
+        .access = access
+    });
+}
+
+void Render_Graph::clear()
+{
+    m_resources.clear();
+    m_passes.clear();
+    m_usages.clear();
+}
+
+Compiled_Render_Graph Render_Graph::compile() const
+{
+    struct Edge
+    {
+        uint32_t from;
+        uint32_t to;
+        // The pass at `to` consumes what `from` produced, as opposed to only having to run after it.
+        bool consumes;
+    };
+
+    auto pass_count = uint32_t(m_passes.size());
+    auto resource_count = uint32_t(m_resources.size());
+
+    // Walk the usages of each resource in pass order, which is the order its contents are produced in.
+    auto usages = m_usages;
+    std::ranges::stable_sort(usages, [](const Usage& a, const Usage& b) {
+        return a.resource != b.resource ? a.resource < b.resource : a.pass < b.pass;
+    });
+
+    std::vector<bool> kept(pass_count);
+    for (uint32_t pass = 0; pass < pass_count; ++pass)
+    {
+        kept[pass] = m_passes[pass].side_effects;
+    }
+
+    std::vector<Edge> edges;
+    std::vector<uint32_t> readers;
+    std::vector<uint32_t> incoming_offsets(pass_count + 1, 0);
+    auto build_edges = [&](bool kept_only) {
+        edges.clear();
+        for (size_t begin = 0; begin < usages.size();)
+        {
+            auto resource = usages[begin].resource;
+            auto last_writer = RENDER_GRAPH_NO_PASS;
+            readers.clear();
+            auto end = begin;
+            for (; end < usages.size() && usages[end].resource == resource; ++end)
+            {
+                const auto& usage = usages[end];
+                if (kept_only && !kept[usage.pass])
+                {
+                    continue;
+                }
+                if (last_writer != RENDER_GRAPH_NO_PASS && last_writer != usage.pass)
+                {
+                    edges.push_back({
+                        .from = last_writer,
+                        .to = usage.pass,
+                        .consumes = depends_on_previous_contents(usage.access)
+                    });
+                }
+                if (!is_write_access(usage.access))
+                {
+                    readers.push_back(usage.pass);
+                    continue;
+                }
+                for (auto reader : readers)
+                {
+                    if (reader != usage.pass)
+                    {
+                        edges.push_back({ .from = reader, .to = usage.pass, .consumes = false });
+                    }
+                }
+                readers.clear();
+                last_writer = usage.pass;
+            }
+            if (!kept_only && m_resources[resource].exported && last_writer != RENDER_GRAPH_NO_PASS)
+            {
+                kept[last_writer] = true;
+            }
+            begin = end;
+        }
+
+        std::ranges::sort(edges, [](const Edge& a, const Edge& b) {
+            return a.to != b.to ? a.to < b.to : a.from < b.from;
+        });
+        auto merged_end = edges.begin();
+        for (auto it = edges.begin(); it != edges.end(); ++it)
+        {
+            if (merged_end != edges.begin() &&
+                std::prev(merged_end)->from == it->from &&
+                std::prev(merged_end)->to == it->to)
+            {
+                std::prev(merged_end)->consumes = std::prev(merged_end)->consumes || it->consumes;
+                continue;
+            }
+            *merged_end++ = *it;
+        }
+        edges.erase(merged_end, edges.end());
+
+        std::ranges::fill(incoming_offsets, 0);
+        for (const auto& edge : edges)
+        {
+            incoming_offsets[edge.to + 1] += 1;
+        }
+        for (uint32_t pass = 0; pass < pass_count; ++pass)
+        {
+            incoming_offsets[pass + 1] += incoming_offsets[pass];
+        }
+    };
+
+    // Edges always point to later passes, so a single backwards sweep finds every pass a kept pass consumes.
+    build_edges(false);
+    for (uint32_t pass = pass_count; pass-- > 0;)
+    {
+        if (!kept[pass])
+        {
+            continue;
+        }
+        for (auto i = incoming_offsets[pass]; i < incoming_offsets[pass + 1]; ++i)
+        {
+            if (edges[i].consumes)
+            {
+                kept[edges[i].from] = true;
+            }
+        }
+    }
+    // Culled passes may have ordered kept passes transitively, so the edges are rebuilt without them.
+    build_edges(true);
+
+    std::vector<uint32_t> pass_access_bits(pass_count, 0);
+    for (const auto& usage : usages)
+    {
+        pass_access_bits[usage.pass] |= get_render_graph_access_bit(usage.access);
+    }
+    std::vector<Render_Graph_Queue> queues(pass_count, Render_Graph_Queue::Direct);
+    for (uint32_t pass = 0; pass < pass_count; ++pass)
+    {
+        if (m_passes[pass].async_compute && (pass_access_bits[pass] & ~ASYNC_COMPUTE_ACCESS_BITS) == 0)
+        {
+            queues[pass] = Render_Graph_Queue::Async_Compute;
+        }
+    }
+
+    // Topological order over the kept passes. Ready async compute passes go first so they can start
+    // overlapping with direct work as early as possible, otherwise the order passes were added in is kept.
+    std::vector<uint32_t> outgoing_offsets(pass_count + 1, 0);
+    std::vector<uint32_t> outgoing(edges.size());
+    std::vector<uint32_t> in_degree(pass_count, 0);
+    for (const auto& edge : edges)
+    {
+        outgoing_offsets[edge.from + 1] += 1;
+        in_degree[edge.to] += 1;
+    }
+    for (uint32_t pass = 0; pass < pass_count; ++pass)
+    {
+        outgoing_offsets[pass + 1] += outgoing_offsets[pass];
+    }
+    {
+        auto cursors = outgoing_offsets;
+        for (const auto& edge : edges)
+        {
+            outgoing[cursors[edge.from]++] = edge.to;
+        }
+    }
+
+    auto get_ready_key = [&](uint32_t pass) {
+        return (uint64_t(queues[pass] == Render_Graph_Queue::Direct) << 32) | pass;
+    };
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> ready;
+    Compiled_Render_Graph result = {};
+    for (uint32_t pass = 0; pass < pass_count; ++pass)
+    {
+        if (!kept[pass])
+        {
+            result.culled_passes.push_back(pass);
+        }
+        else if (in_degree[pass] == 0)
+        {
+            ready.push(get_ready_key(pass));
+        }
+    }
+
+    std::vector<uint32_t> pass_order(pass_count, RENDER_GRAPH_NO_PASS);
+    result.passes.reserve(pass_count - result.culled_passes.size());
+    while (!ready.empty())
+    {
+        auto pass = uint32_t(ready.top() & 0xFFFFFFFF);
+        ready.pop();
+        pass_order[pass] = uint32_t(result.passes.size());
+        result.passes.push_back({
+            .pass = pass,
+            .queue = queues[pass],
+            .wait_pass = RENDER_GRAPH_NO_PASS,
+            .signal = false,
+            .first_barrier = 0,
+            .barrier_count = 0
+        });
+        for (auto i = outgoing_offsets[pass]; i < outgoing_offsets[pass + 1]; ++i)
+        {
+            if (--in_degree[outgoing[i]] == 0)
+            {
+                ready.push(get_ready_key(outgoing[i]));
+            }
+        }
+    }
+    assert(result.passes.size() == pass_count - result.culled_passes.size());
+
+    // Queues execute in order, so only the latest dependency on the other queue needs a wait and
+    // waits already covered by an earlier wait of the same queue are dropped.
+    std::array<uint32_t, 2> last_waited = { RENDER_GRAPH_NO_PASS, RENDER_GRAPH_NO_PASS };
+    for (uint32_t order = 0; order < uint32_t(result.passes.size()); ++order)
+    {
+        auto& compiled_pass = result.passes[order];
+        auto wait_pass = RENDER_GRAPH_NO_PASS;
+        for (auto i = incoming_offsets[compiled_pass.pass]; i < incoming_offsets[compiled_pass.pass + 1]; ++i)
+        {
+            auto from = edges[i].from;
+            if (queues[from] != compiled_pass.queue &&
+                (wait_pass == RENDER_GRAPH_NO_PASS || pass_order[from] > wait_pass))
+            {
+                wait_pass = pass_order[from];
+            }
+        }
+        auto& queue_last_waited = last_waited[uint32_t(compiled_pass.queue)];
+        if (wait_pass != RENDER_GRAPH_NO_PASS &&
+            (queue_last_waited == RENDER_GRAPH_NO_PASS || wait_pass > queue_last_waited))
+        {
+            compiled_pass.wait_pass = wait_pass;
+            result.passes[wait_pass].signal = true;
+            queue_last_waited = wait_pass;
+        }
+    }
+
+    struct Resource_State
+    {
+        uint32_t access_bits;
+        Render_Graph_Access layout_access;
+        uint8_t queue_bits;
+        uint32_t last_order;
+        uint32_t first_order;
+        bool used_on_async_compute;
+    };
+    std::vector<Resource_State> states(resource_count);
+    for (uint32_t resource = 0; resource < resource_count; ++resource)
+    {
+        const auto& desc = m_resources[resource];
+        auto initial_access = desc.imported ? desc.initial_access : Render_Graph_Access::None;
+        states[resource] = {
+            .access_bits = get_render_graph_access_bit(initial_access),
+            .layout_access = initial_access,
+            .queue_bits = initial_access != Render_Graph_Access::None
+                ? get_queue_bit(Render_Graph_Queue::Direct)
+                : uint8_t(0),
+            .last_order = RENDER_GRAPH_NO_PASS,
+            .first_order = RENDER_GRAPH_NO_PASS,
+            .used_on_async_compute = false
+        };
+    }
+
+    // Barriers are only needed around writes and texture layout changes, reads in the same layout
+    // accumulate into the next barrier's access_before.
+    auto transition = [&](uint32_t resource, Render_Graph_Access access, Render_Graph_Queue queue,
+        std::vector<Render_Graph_Barrier>& barriers)
+    {
+        auto& state = states[resource];
+        auto texture = m_resources[resource].texture;
+        auto undefined = state.access_bits == 0;
+        auto hazard = is_write_access(access) || (state.access_bits & WRITE_ACCESS_BITS) != 0;
+        auto layout_change = get_texture_layout_access(state.layout_access) != get_texture_layout_access(access);
+        if (undefined ? texture : (hazard || (texture && layout_change)))
+        {
+            barriers.push_back({
+                .resource = resource,
+                .access_before = state.access_bits,
+                .access_after = access,
+                .queue_transfer = state.queue_bits != 0 && (state.queue_bits & get_queue_bit(queue)) == 0
+            });
+            state.access_bits = 0;
+            state.queue_bits = 0;
+        }
+        state.access_bits |= get_render_graph_access_bit(access);
+        state.layout_access = access;
+        state.queue_bits |= get_queue_bit(queue);
+    };
+
+    std::ranges::stable_sort(usages, [](const Usage& a, const Usage& b) {
+        return a.pass < b.pass;
+    });
+    std::vector<uint32_t> usage_offsets(pass_count + 1, 0);
+    for (const auto& usage : usages)
+    {
+        usage_offsets[usage.pass + 1] += 1;
+    }
+    for (uint32_t pass = 0; pass < pass_count; ++pass)
+    {
+        usage_offsets[pass + 1] += usage_offsets[pass];
+    }
+
+    for (uint32_t order = 0; order < uint32_t(result.passes.size()); ++order)
+    {
+        auto& compiled_pass = result.passes[order];
+        compiled_pass.first_barrier = uint32_t(result.barriers.size());
+        for (auto i = usage_offsets[compiled_pass.pass]; i < usage_offsets[compiled_pass.pass + 1]; ++i)
+        {
+            const auto& usage = usages[i];
+            auto& state = states[usage.resource];
+            if (state.first_order == RENDER_GRAPH_NO_PASS)
+            {
+                state.first_order = order;
+            }
+            state.used_on_async_compute = state.used_on_async_compute ||
+                compiled_pass.queue == Render_Graph_Queue::Async_Compute;
+            // The same access declared twice by a pass needs no barrier in between.
+            if (state.last_order == order && (state.access_bits & get_render_graph_access_bit(usage.access)))
+            {
+                continue;
+            }
+            state.last_order = order;
+            transition(usage.resource, usage.access, compiled_pass.queue, result.barriers);
+        }
+        compiled_pass.barrier_count = uint32_t(result.barriers.size()) - compiled_pass.first_barrier;
+    }
+
+    for (uint32_t resource = 0; resource < resource_count; ++resource)
+    {
+        const auto& desc = m_resources[resource];
+        if (desc.exported && desc.final_access != Render_Graph_Access::None)
+        {
+            transition(resource, desc.final_access, Render_Graph_Queue::Direct, result.final_barriers);
+        }
+    }
+
+    // Async compute passes overlap with direct passes they are not ordered against, the resources
+    // they use are kept alive for the whole graph instead of tracking the overlap.
+    std::vector<Transient_Resource_Desc> transient_descs;
+    std::vector<uint32_t> transient_resources;
+    auto last_order = result.passes.empty() ? 0u : uint32_t(result.passes.size() - 1);
+    for (uint32_t resource = 0; resource < resource_count; ++resource)
+    {
+        const auto& desc = m_resources[resource];
+        const auto& state = states[resource];
+        if (desc.imported || state.first_order == RENDER_GRAPH_NO_PASS)
+        {
+            continue;
+        }
+        transient_descs.push_back({
+            .size = desc.size,
+            .alignment = desc.alignment,
+            .first_use = state.used_on_async_compute ? 0u : state.first_order,
+            .last_use = state.used_on_async_compute ? last_order : state.last_order
+        });
+        transient_resources.push_back(resource);
+    }
+    auto transient_plan = plan_transient_resources(transient_descs);
+    result.transient_heap_size = transient_plan.heap_size;
+    result.transient_placements.assign(resource_count, {
+        .offset = RENDER_GRAPH_NO_OFFSET,
+        .previous_resource = TRANSIENT_NO_RESOURCE,
+        .next_resource = TRANSIENT_NO_RESOURCE
+    });
+    for (uint32_t i = 0; i < uint32_t(transient_resources.size()); ++i)
+    {
+        const auto& placement = transient_plan.placements[i];
+        result.transient_placements[transient_resources[i]] = {
+            .offset = placement.offset,
+            .previous_resource = placement.previous_resource != TRANSIENT_NO_RESOURCE
+                ? transient_resources[placement.previous_resource]
+                : TRANSIENT_NO_RESOURCE,
+            .next_resource = placement.next_resource != TRANSIENT_NO_RESOURCE
+                ? transient_resources[placement.next_resource]
+                : TRANSIENT_NO_RESOURCE
+        };
+    }
+
+    return result;
+}
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "owge_common/transient_planner.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace owge
+{
+static constexpr uint32_t RENDER_GRAPH_NO_PASS = ~0u;
+static constexpr uint64_t RENDER_GRAPH_NO_OFFSET = ~0ull;
+
+enum class Render_Graph_Queue : uint8_t
+{
+    Direct,
+    Async_Compute
+};
+
+// Abstract resource usages, translating them into API barriers is up to the caller.
+enum class Render_Graph_Access : uint8_t
+{
+    // Undefined contents, only valid as the initial access of an imported resource.
+    None,
+    Vertex_Shader_Read,
+    Pixel_Shader_Read,
+    Compute_Shader_Read,
+    // Reads and writes, so a pass using it always depends on the previous writer.
+    Unordered_Access,
+    Render_Target,
+    Depth_Stencil_Write,
+    Depth_Stencil_Read,
+    Index_Buffer,
+    Copy_Source,
+    Copy_Dest,
+    Present
+};
+
+[[nodiscard]] constexpr uint32_t get_render_graph_access_bit(Render_Graph_Access access)
+{
+    return access == Render_Graph_Access::None ? 0u : 1u << uint32_t(access);
+}
+
+struct Render_Graph_Resource_Desc
+{
+    // Textures need barriers between reads in different layouts, buffers don't.
+    bool texture;
+    // Imported resources outlive the graph, all others are transient and placed in a shared heap.
+    bool imported;
+    // The contents are used after the graph ran, so the passes producing them are never culled.
+    bool exported;
+    Render_Graph_Access initial_access;
+    // Access exported resources are transitioned to after the last pass, None keeps the last access.
+    Render_Graph_Access final_access;
+    uint64_t size;
+    uint64_t alignment;
+};
+
+struct Render_Graph_Pass_Desc
+{
+    // Only honored if the pass exclusively uses compute shader and copy accesses.
+    bool async_compute;
+    // Passes with effects outside of the graph, e.g. readbacks, are never culled.
+    bool side_effects;
+};
+
+struct Render_Graph_Barrier
+{
+    uint32_t resource;
+    // Bits of all accesses since the previous barrier, 0 if the contents are undefined.
+    uint32_t access_before;
+    Render_Graph_Access access_after;
+    // The previous accesses happened on the other queue and are already synchronized by a fence wait.
+    bool queue_transfer;
+};
+
+struct Render_Graph_Compiled_Pass
+{
+    uint32_t pass;
+    Render_Graph_Queue queue;
+    // Index of a compiled pass on the other queue that has to finish before this one starts.
+    uint32_t wait_pass;
+    // A pass on the other queue waits for this one, so its queue has to signal after it.
+    bool signal;
+    // Barriers to record before the pass.
+    uint32_t first_barrier;
+    uint32_t barrier_count;
+};
+
+struct Compiled_Render_Graph
+{
+    // Execution order, passes on different queues only synchronize through `wait_pass`.
+    std::vector<Render_Graph_Compiled_Pass> passes;
+    std::vector<Render_Graph_Barrier> barriers;
+    // Barriers to record after the last pass.
+    std::vector<Render_Graph_Barrier> final_barriers;
+    std::vector<uint32_t> culled_passes;
+    uint64_t transient_heap_size;
+    // Indexed by resource, imported and unused resources are placed at RENDER_GRAPH_NO_OFFSET.
+    // Aliasing resources are referred to by their resource index.
+    std::vector<Transient_Resource_Placement> transient_placements;
+};
+
+// Collects passes and the resources they use, then orders them by their dependencies,
+// culls passes whose results are never consumed, assigns queues and transient memory and
+// computes the barriers between the remaining passes.
+// A pass sees the writes of all passes added before it, the order usages are declared in doesn't matter.
+// Pure bookkeeping, nothing is recorded or allocated. Not thread-safe.
+class Render_Graph
+{
+public:
+    [[nodiscard]] uint32_t add_resource(const Render_Graph_Resource_Desc& desc);
+    [[nodiscard]] uint32_t add_pass(const Render_Graph_Pass_Desc& desc);
+    void use(uint32_t pass, uint32_t resource, Render_Graph_Access access);
+    void clear();
+
+    [[nodiscard]] Compiled_Render_Graph compile() const;
+
+    [[nodiscard]] uint32_t get_pass_count() const
+    {
+        return uint32_t(m_passes.size());
+    }
+    [[nodiscard]] uint32_t get_resource_count() const
+    {
+        return uint32_t(m_resources.size());
+    }
+
+private:
+    struct Usage
+    {
+        uint32_t pass;
+        uint32_t resource;
+        Render_Graph_Access access;
+    };
+
+    std::vector<Render_Graph_Resource_Desc> m_resources;
+    std::vector<Render_Graph_Pass_Desc> m_passes;
+    std::vector<Usage> m_usages;
+};
+}
@@ -0,0 +1,41 @@
+#include "owge_common/texture_footprint.hpp"
+
+#include <algorithm>
+
+namespace owge
+{
+static constexpr uint64_t TEXTURE_DATA_PITCH_ALIGNMENT = 256;
+static constexpr uint64_t TEXTURE_DATA_PLACEMENT_ALIGNMENT = 512;
+
+[[nodiscard]] static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint64_t compute_subresource_footprints(const Texture_Footprint_Desc& desc,
+    uint32_t first_subresource, std::span<Subresource_Footprint> footprints)
+{
+    uint64_t size = 0;
+    for (uint32_t i = 0; i < uint32_t(footprints.size()); ++i)
+    {
+        auto mip = (first_subresource + i) % desc.mip_levels;
+        auto width = std::max(desc.width >> mip, 1u);
+        auto height = std::max(desc.height >> mip, 1u);
+        auto depth = std::max(desc.depth >> mip, 1u);
+        // Block compressed mips smaller than a block still occupy a whole one.
+        auto blocks_x = (width + desc.block.width - 1) / desc.block.width;
+        auto blocks_y = (height + desc.block.height - 1) / desc.block.height;
+
+        auto& footprint = footprints[i];
+        footprint.offset = align_up(size, TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+        footprint.width = blocks_x * desc.block.width;
+        footprint.height = blocks_y * desc.block.height;
+        footprint.depth = depth;
+        footprint.row_size = blocks_x * desc.block.size;
+        footprint.row_pitch = uint32_t(align_up(footprint.row_size, TEXTURE_DATA_PITCH_ALIGNMENT));
+        footprint.row_count = blocks_y;
+        size = footprint.offset + uint64_t(footprint.row_pitch) * blocks_y * depth;
+    }
+    return size;
+}
+}
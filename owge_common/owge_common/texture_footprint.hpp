@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace owge
+{
+// Block compressed formats store `size` bytes per `width` x `height` texel block,
+// uncompressed formats use 1x1 blocks.
+struct Texel_Block_Info
+{
+    uint32_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct Texture_Footprint_Desc
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t array_layers;
+    uint32_t mip_levels;
+    Texel_Block_Info block;
+};
+
+// Layout of one subresource inside an upload buffer, following the D3D12 placement rules:
+// rows are 256 byte aligned and subresources start on 512 byte boundaries.
+// Width and height are rounded up to whole texel blocks, as copies expect them.
+struct Subresource_Footprint
+{
+    uint64_t offset;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t row_pitch;
+    uint32_t row_count;
+    uint32_t row_size;
+};
+
+// Subresources are indexed like D3D12 does, mip levels first, then array layers.
+// Fills one footprint per entry in `footprints` starting at `first_subresource`
+// and returns the total size needed to hold them.
+uint64_t compute_subresource_footprints(const Texture_Footprint_Desc& desc,
+    uint32_t first_subresource, std::span<Subresource_Footprint> footprints);
+}
@@ -0,0 +1,294 @@
+#include "owge_common/tlsf_allocator.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace owge
+{
+Tlsf_Allocator::Tlsf_Allocator(uint64_t size)
+    : m_size(size)
+    , m_used_size(0)
+    , m_allocation_count(0)
+    , m_fl_bitmap(0)
+    , m_sl_bitmaps()
+    , m_free_heads()
+    , m_nodes()
+    , m_node_freelist()
+{
+    for (auto& fl : m_free_heads)
+    {
+        std::ranges::fill(fl, NO_NODE);
+    }
+    if (size > 0)
+    {
+        insert_free_node(create_node(0, size));
+    }
+}
+
+Tlsf_Allocation Tlsf_Allocator::allocate(uint64_t size, uint64_t alignment)
+{
+    Tlsf_Allocation result = {
+        .offset = 0,
+        .size = 0,
+        .node = TLSF_NO_ALLOCATION
+    };
+    if (size == 0)
+    {
+        return result;
+    }
+    alignment = std::max<uint64_t>(alignment, 1);
+
+    // Search for a block that fits the request even if its offset is misaligned.
+    uint32_t node = find_free_node(size + alignment - 1);
+    if (node == NO_NODE)
+    {
+        return result;
+    }
+    remove_free_node(node);
+
+    auto offset = m_nodes[node].offset;
+    auto aligned_offset = (offset + alignment - 1) & ~(alignment - 1);
+    auto padding = aligned_offset - offset;
+    if (padding > 0)
+    {
+        // The physical predecessor of a free block is never free, so the padding
+        // becomes a standalone free block in front of the allocation.
+        auto front = create_node(offset, padding);
+        m_nodes[front].prev_physical = m_nodes[node].prev_physical;
+        m_nodes[front].next_physical = node;
+        if (m_nodes[front].prev_physical != NO_NODE)
+        {
+            m_nodes[m_nodes[front].prev_physical].next_physical = front;
+        }
+        m_nodes[node].prev_physical = front;
+        m_nodes[node].offset = aligned_offset;
+        m_nodes[node].size -= padding;
+        insert_free_node(front);
+    }
+
+    if (m_nodes[node].size > size)
+    {
+        auto back = create_node(aligned_offset + size, m_nodes[node].size - size);
+        m_nodes[back].prev_physical = node;
+        m_nodes[back].next_physical = m_nodes[node].next_physical;
+        if (m_nodes[back].next_physical != NO_NODE)
+        {
+            m_nodes[m_nodes[back].next_physical].prev_physical = back;
+        }
+        m_nodes[node].next_physical = back;
+        m_nodes[node].size = size;
+        insert_free_node(back);
+    }
+
+    m_nodes[node].used = true;
+    m_used_size += size;
+    m_allocation_count += 1;
+
+    result.offset = aligned_offset;
+    result.size = size;
+    result.node = node;
+    return result;
+}
+
+void Tlsf_Allocator::free(Tlsf_Allocation allocation)
+{
+    free(allocation.node);
+}
+
+void Tlsf_Allocator::free(uint32_t node)
+{
+    if (node == TLSF_NO_ALLOCATION)
+    {
+        return;
+    }
+
+    m_nodes[node].used = false;
+    m_used_size -= m_nodes[node].size;
+    m_allocation_count -= 1;
+
+    auto prev = m_nodes[node].prev_physical;
+    if (prev != NO_NODE && !m_nodes[prev].used)
+    {
+        remove_free_node(prev);
+        m_nodes[prev].size += m_nodes[node].size;
+        m_nodes[prev].next_physical = m_nodes[node].next_physical;
+        if (m_nodes[prev].next_physical != NO_NODE)
+        {
+            m_nodes[m_nodes[prev].next_physical].prev_physical = prev;
+        }
+        release_node(node);
+        node = prev;
+    }
+
+    auto next = m_nodes[node].next_physical;
+    if (next != NO_NODE && !m_nodes[next].used)
+    {
+        remove_free_node(next);
+        m_nodes[node].size += m_nodes[next].size;
+        m_nodes[node].next_physical = m_nodes[next].next_physical;
+        if (m_nodes[node].next_physical != NO_NODE)
+        {
+            m_nodes[m_nodes[node].next_physical].prev_physical = node;
+        }
+        release_node(next);
+    }
+
+    insert_free_node(node);
+}
+
+Tlsf_Stats Tlsf_Allocator::get_stats() const
+{
+    Tlsf_Stats stats = {
+        .total_size = m_size,
+        .used_size = m_used_size,
+        .largest_free_block = 0,
+        .allocation_count = m_allocation_count,
+        .free_block_count = 0
+    };
+    for (uint32_t fl = 0; fl < FL_COUNT; ++fl)
+    {
+        for (uint32_t sl = 0; sl < SL_COUNT; ++sl)
+        {
+            for (auto node = m_free_heads[fl][sl]; node != NO_NODE; node = m_nodes[node].next_free)
+            {
+                stats.largest_free_block = std::max(stats.largest_free_block, m_nodes[node].size);
+                stats.free_block_count += 1;
+            }
+        }
+    }
+    return stats;
+}
+
+Tlsf_Allocator::Bin Tlsf_Allocator::bin_round_down(uint64_t size)
+{
+    if (size < SL_COUNT)
+    {
+        return { .fl = 0, .sl = uint32_t(size) };
+    }
+    auto log2 = uint32_t(std::bit_width(size) - 1);
+    return {
+        .fl = log2 - SL_COUNT_LOG2 + 1,
+        .sl = uint32_t(size >> (log2 - SL_COUNT_LOG2)) & (SL_COUNT - 1)
+    };
+}
+
+Tlsf_Allocator::Bin Tlsf_Allocator::bin_round_up(uint64_t size)
+{
+    if (size >= SL_COUNT)
+    {
+        auto log2 = uint32_t(std::bit_width(size) - 1);
+        auto round = (1ull << (log2 - SL_COUNT_LOG2)) - 1;
+        if (size > ~0ull - round)
+        {
+            return { .fl = FL_COUNT, .sl = 0 };
+        }
+        size += round;
+    }
+    return bin_round_down(size);
+}
+
+uint32_t Tlsf_Allocator::find_free_node(uint64_t size) const
+{
+    auto bin = bin_round_up(size);
+    if (bin.fl >= FL_COUNT)
+    {
+        return NO_NODE;
+    }
+
+    auto sl_map = m_sl_bitmaps[bin.fl] & (~0u << bin.sl);
+    if (sl_map == 0)
+    {
+        auto fl_map = bin.fl + 1 < 64
+            ? m_fl_bitmap & (~0ull << (bin.fl + 1))
+            : 0;
+        if (fl_map == 0)
+        {
+            // Rounding up skips blocks in the request's own bin that would still fit,
+            // which matters when the allocator is nearly full.
+            auto exact_bin = bin_round_down(size);
+            for (auto node = m_free_heads[exact_bin.fl][exact_bin.sl]; node != NO_NODE; node = m_nodes[node].next_free)
+            {
+                if (m_nodes[node].size >= size)
+                {
+                    return node;
+                }
+            }
+            return NO_NODE;
+        }
+        bin.fl = uint32_t(std::countr_zero(fl_map));
+        sl_map = m_sl_bitmaps[bin.fl];
+    }
+    bin.sl = uint32_t(std::countr_zero(sl_map));
+    return m_free_heads[bin.fl][bin.sl];
+}
+
+uint32_t Tlsf_Allocator::create_node(uint64_t offset, uint64_t size)
+{
+    Node node = {
+        .offset = offset,
+        .size = size,
+        .prev_physical = NO_NODE,
+        .next_physical = NO_NODE,
+        .prev_free = NO_NODE,
+        .next_free = NO_NODE,
+        .used = false
+    };
+    if (!m_node_freelist.empty())
+    {
+        auto index = m_node_freelist.back();
+        m_node_freelist.pop_back();
+        m_nodes[index] = node;
+        return index;
+    }
+    m_nodes.push_back(node);
+    return uint32_t(m_nodes.size() - 1);
+}
+
+void Tlsf_Allocator::release_node(uint32_t node)
+{
+    m_node_freelist.push_back(node);
+}
+
+void Tlsf_Allocator::insert_free_node(uint32_t node)
+{
+    auto bin = bin_round_down(m_nodes[node].size);
+    auto head = m_free_heads[bin.fl][bin.sl];
+    m_nodes[node].prev_free = NO_NODE;
+    m_nodes[node].next_free = head;
+    if (head != NO_NODE)
+    {
+        m_nodes[head].prev_free = node;
+    }
+    m_free_heads[bin.fl][bin.sl] = node;
+    m_fl_bitmap |= 1ull << bin.fl;
+    m_sl_bitmaps[bin.fl] |= 1u << bin.sl;
+}
+
+void Tlsf_Allocator::remove_free_node(uint32_t node)
+{
+    auto& data = m_nodes[node];
+    if (data.prev_free != NO_NODE)
+    {
+        m_nodes[data.prev_free].next_free = data.next_free;
+    }
+    else
+    {
+        auto bin = bin_round_down(data.size);
+        m_free_heads[bin.fl][bin.sl] = data.next_free;
+        if (data.next_free == NO_NODE)
+        {
+            m_sl_bitmaps[bin.fl] &= ~(1u << bin.sl);
+            if (m_sl_bitmaps[bin.fl] == 0)
+            {
+                m_fl_bitmap &= ~(1ull << bin.fl);
+            }
+        }
+    }
+    if (data.next_free != NO_NODE)
+    {
+        m_nodes[data.next_free].prev_free = data.prev_free;
+    }
+    data.prev_free = NO_NODE;
+    data.next_free = NO_NODE;
+}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace owge
+{
+static constexpr uint32_t TLSF_NO_ALLOCATION = ~0u;
+
+struct Tlsf_Allocation
+{
+    uint64_t offset;
+    uint64_t size;
+    uint32_t node;
+
+    [[nodiscard]] bool is_valid() const
+    {
+        return node != TLSF_NO_ALLOCATION;
+    }
+};
+
+struct Tlsf_Stats
+{
+    uint64_t total_size;
+    uint64_t used_size;
+    uint64_t largest_free_block;
+    uint32_t allocation_count;
+    uint32_t free_block_count;
+};
+
+// Two-level segregated fit allocator over an abstract range [0, size).
+// It only does bookkeeping, the caller maps offsets to whatever is being suballocated.
+// Allocation and free are O(1), adjacent free blocks are coalesced on free.
+// Not thread-safe.
+class Tlsf_Allocator
+{
+public:
+    Tlsf_Allocator(uint64_t size);
+
+    [[nodiscard]] Tlsf_Allocation allocate(uint64_t size, uint64_t alignment = 1);
+    void free(Tlsf_Allocation allocation);
+    void free(uint32_t node);
+
+    [[nodiscard]] uint64_t get_allocation_size(uint32_t node) const
+    {
+        return m_nodes[node].size;
+    }
+    [[nodiscard]] uint64_t size() const
+    {
+        return m_size;
+    }
+    [[nodiscard]] bool empty() const
+    {
+        return m_allocation_count == 0;
+    }
+    [[nodiscard]] Tlsf_Stats get_stats() const;
+
+private:
+    static constexpr uint32_t SL_COUNT_LOG2 = 4;
+    static constexpr uint32_t SL_COUNT = 1u << SL_COUNT_LOG2;
+    static constexpr uint32_t FL_COUNT = 64 - SL_COUNT_LOG2 + 1;
+    static constexpr uint32_t NO_NODE = ~0u;
+
+    struct Node
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t prev_physical;
+        uint32_t next_physical;
+        uint32_t prev_free;
+        uint32_t next_free;
+        bool used;
+    };
+
+    struct Bin
+    {
+        uint32_t fl;
+        uint32_t sl;
+    };
+
+    [[nodiscard]] static Bin bin_round_down(uint64_t size);
+    [[nodiscard]] static Bin bin_round_up(uint64_t size);
+
+    [[nodiscard]] uint32_t find_free_node(uint64_t size) const;
+    [[nodiscard]] uint32_t create_node(uint64_t offset, uint64_t size);
+    void release_node(uint32_t node);
+    void insert_free_node(uint32_t node);
+    void remove_free_node(uint32_t node);
+
+    uint64_t m_size;
+    uint64_t m_used_size;
+    uint32_t m_allocation_count;
+    uint64_t m_fl_bitmap;
+    uint32_t m_sl_bitmaps[FL_COUNT];
+    uint32_t m_free_heads[FL_COUNT][SL_COUNT];
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_node_freelist;
+};
+}
@@ -0,0 +1,112 @@
+#include "owge_common/transient_planner.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace owge
+{
+[[nodiscard]] static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+[[nodiscard]] static bool lifetimes_overlap(const Transient_Resource_Desc& a, const Transient_Resource_Desc& b)
+{
+    return a.first_use <= b.last_use && b.first_use <= a.last_use;
+}
+
+Transient_Plan plan_transient_resources(std::span<const Transient_Resource_Desc> resources)
+{
+    auto count = uint32_t(resources.size());
+    Transient_Plan plan = {
+        .heap_size = 0,
+        .placements = std::vector<Transient_Resource_Placement>(count, {
+            .offset = 0,
+            .previous_resource = TRANSIENT_NO_RESOURCE,
+            .next_resource = TRANSIENT_NO_RESOURCE
+        })
+    };
+
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::stable_sort(order, [&](uint32_t a, uint32_t b) {
+        return resources[a].size > resources[b].size;
+    });
+
+    std::vector<uint32_t> placed;
+    std::vector<uint32_t> conflicts;
+    placed.reserve(count);
+    conflicts.reserve(count);
+    for (auto resource : order)
+    {
+        const auto& desc = resources[resource];
+        auto alignment = std::max<uint64_t>(desc.alignment, 1);
+
+        // `placed` is kept sorted by offset, so the conflicts are too.
+        conflicts.clear();
+        for (auto other : placed)
+        {
+            if (lifetimes_overlap(desc, resources[other]))
+            {
+                conflicts.push_back(other);
+            }
+        }
+
+        // First fit into the gaps between conflicting resources.
+        uint64_t offset = 0;
+        for (auto other : conflicts)
+        {
+            auto other_offset = plan.placements[other].offset;
+            if (offset + desc.size <= other_offset)
+            {
+                break;
+            }
+            offset = std::max(offset, align_up(other_offset + resources[other].size, alignment));
+        }
+
+        plan.placements[resource].offset = offset;
+        plan.heap_size = std::max(plan.heap_size, offset + desc.size);
+        placed.insert(std::ranges::upper_bound(placed, offset, {}, [&](uint32_t other) {
+            return plan.placements[other].offset;
+        }), resource);
+    }
+
+    // Resources that share memory can't be alive at the same time, so each one is either before or after.
+    // Ties go to the resource with the lower index.
+    for (uint32_t a = 0; a < count; ++a)
+    {
+        auto& placement = plan.placements[a];
+        auto a_begin = placement.offset;
+        for (auto b : placed)
+        {
+            auto b_begin = plan.placements[b].offset;
+            if (b_begin >= a_begin + resources[a].size)
+            {
+                break;
+            }
+            if (a == b || a_begin >= b_begin + resources[b].size)
+            {
+                continue;
+            }
+            auto previous = placement.previous_resource;
+            if (resources[b].last_use < resources[a].first_use &&
+                (previous == TRANSIENT_NO_RESOURCE ||
+                 resources[b].last_use > resources[previous].last_use ||
+                 (resources[b].last_use == resources[previous].last_use && b < previous)))
+            {
+                placement.previous_resource = b;
+            }
+            auto next = placement.next_resource;
+            if (resources[b].first_use > resources[a].last_use &&
+                (next == TRANSIENT_NO_RESOURCE ||
+                 resources[b].first_use < resources[next].first_use ||
+                 (resources[b].first_use == resources[next].first_use && b < next)))
+            {
+                placement.next_resource = b;
+            }
+        }
+    }
+
+    return plan;
+}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace owge
+{
+static constexpr uint32_t TRANSIENT_NO_RESOURCE = ~0u;
+
+// Lifetimes are inclusive and measured in an arbitrary, caller defined pass order.
+struct Transient_Resource_Desc
+{
+    uint64_t size;
+    uint64_t alignment;
+    uint32_t first_use;
+    uint32_t last_use;
+};
+
+struct Transient_Resource_Placement
+{
+    uint64_t offset;
+    // Closest resources that occupy overlapping memory before and after this one.
+    uint32_t previous_resource;
+    uint32_t next_resource;
+
+    [[nodiscard]] bool is_aliased() const
+    {
+        return previous_resource != TRANSIENT_NO_RESOURCE || next_resource != TRANSIENT_NO_RESOURCE;
+    }
+};
+
+struct Transient_Plan
+{
+    uint64_t heap_size;
+    std::vector<Transient_Resource_Placement> placements;
+};
+
+// Assigns heap offsets so that resources with overlapping lifetimes never overlap in memory.
+// The lifetimes form an interval graph, which is colored greedily with memory ranges as colors:
+// resources are placed largest first at the lowest offset that doesn't conflict with an already
+// placed resource that is alive at the same time.
+[[nodiscard]] Transient_Plan plan_transient_resources(std::span<const Transient_Resource_Desc> resources);
+}
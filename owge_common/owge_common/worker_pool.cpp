@@ -0,0 +1,108 @@
+#include "owge_common/worker_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace owge
+{
+Worker_Pool::Worker_Pool(uint32_t worker_count)
+{
+    if (worker_count == 0)
+    {
+        worker_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    m_threads.reserve(worker_count - 1);
+    for (uint32_t worker = 1; worker < worker_count; ++worker)
+    {
+        m_threads.emplace_back(&Worker_Pool::work, this, worker);
+    }
+}
+
+Worker_Pool::~Worker_Pool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_exit = true;
+    }
+    m_batch_started.notify_all();
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void Worker_Pool::run(uint32_t task_count, const std::function<void(uint32_t, uint32_t)>& task)
+{
+    // Waking up workers costs more than recording a single task.
+    if (task_count <= 1 || m_threads.empty())
+    {
+        for (uint32_t i = 0; i < task_count; ++i)
+        {
+            task(i, i % get_worker_count());
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_task = &task;
+        m_task_count = task_count;
+        m_busy_worker_count = uint32_t(m_threads.size());
+        m_batch += 1;
+    }
+    m_batch_started.notify_all();
+    run_tasks(0);
+
+    // The workers still use `task`, so the batch has to finish before an exception leaves this function.
+    std::unique_lock lock(m_mutex);
+    m_batch_finished.wait(lock, [this] { return m_busy_worker_count == 0; });
+    m_task = nullptr;
+    if (m_exception)
+    {
+        std::rethrow_exception(std::exchange(m_exception, nullptr));
+    }
+}
+
+void Worker_Pool::work(uint32_t worker)
+{
+    uint64_t batch = 0;
+    while (true)
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_batch_started.wait(lock, [&] { return m_exit || m_batch != batch; });
+            if (m_exit)
+            {
+                return;
+            }
+            batch = m_batch;
+        }
+        run_tasks(worker);
+        {
+            std::lock_guard lock(m_mutex);
+            m_busy_worker_count -= 1;
+        }
+        m_batch_finished.notify_one();
+    }
+}
+
+void Worker_Pool::run_tasks(uint32_t worker)
+{
+    try
+    {
+        for (auto i = worker; i < m_task_count; i += get_worker_count())
+        {
+            (*m_task)(i, worker);
+        }
+    }
+    catch (...)
+    {
+        // Only the first exception is rethrown, the remaining tasks of the worker are skipped.
+        std::lock_guard lock(m_mutex);
+        if (!m_exception)
+        {
+            m_exception = std::current_exception();
+        }
+    }
+}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace owge
+{
+// Fixed set of worker threads that run batches of indexed tasks. Task `i` always runs on worker
+// `i % get_worker_count()`, so per-worker resources are used deterministically. Worker 0 is the
+// thread calling `run`. Only one batch runs at a time.
+class Worker_Pool
+{
+public:
+    // 0 uses one worker per hardware thread.
+    Worker_Pool(uint32_t worker_count);
+    ~Worker_Pool();
+
+    Worker_Pool(const Worker_Pool&) = delete;
+    Worker_Pool& operator=(const Worker_Pool&) = delete;
+
+    // Runs `task(index, worker)` for every index in [0, task_count) and returns once all of them finished.
+    // If tasks throw, the first exception is rethrown after the batch finished.
+    void run(uint32_t task_count, const std::function<void(uint32_t, uint32_t)>& task);
+
+    [[nodiscard]] uint32_t get_worker_count() const
+    {
+        return uint32_t(m_threads.size()) + 1;
+    }
+
+private:
+    void work(uint32_t worker);
+    void run_tasks(uint32_t worker);
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_batch_started;
+    std::condition_variable m_batch_finished;
+    const std::function<void(uint32_t, uint32_t)>* m_task = nullptr;
+    uint32_t m_task_count = 0;
+    uint64_t m_batch = 0;
+    uint32_t m_busy_worker_count = 0;
+    std::exception_ptr m_exception;
+    bool m_exit = false;
+    std::vector<std::thread> m_threads;
+};
+}
@@ -1,7 +1,9 @@
 #include "owge_d3d12_base/d3d12_util.hpp"
 
+#include <algorithm>
 #include <wrl.h>
 #include <sstream>
+#include <stdexcept>
 
 namespace owge
 {
@@ -64,43 +66,191 @@ DWORD wait_for_d3d12_queue_idle(ID3D12Device* device, ID3D12CommandQueue* queue)
     return wait_for_d3d12_fence(fence.Get(), FENCE_SIGNAL_VALUE, INFINITE);
 }
 
-Descriptor_Allocator::Descriptor_Allocator(ID3D12DescriptorHeap* heap, ID3D12Device* device)
-    : m_heap(heap), m_device(device), m_free_list(), m_current_idx(0)
+Texel_Block_Info get_dxgi_format_block_info(DXGI_FORMAT format)
 {
-    auto desc = m_heap->GetDesc();
-    auto size = desc.Type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV
+    switch (format)
+    {
+    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+    case DXGI_FORMAT_R32G32B32A32_SINT:
+        return { .size = 16, .width = 1, .height = 1 };
+    case DXGI_FORMAT_R32G32B32_TYPELESS:
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+    case DXGI_FORMAT_R32G32B32_UINT:
+    case DXGI_FORMAT_R32G32B32_SINT:
+        return { .size = 12, .width = 1, .height = 1 };
+    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+    case DXGI_FORMAT_R16G16B16A16_SINT:
+    case DXGI_FORMAT_R32G32_TYPELESS:
+    case DXGI_FORMAT_R32G32_FLOAT:
+    case DXGI_FORMAT_R32G32_UINT:
+    case DXGI_FORMAT_R32G32_SINT:
+        return { .size = 8, .width = 1, .height = 1 };
+    case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+    case DXGI_FORMAT_R10G10B10A2_UINT:
+    case DXGI_FORMAT_R11G11B10_FLOAT:
+    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_R8G8B8A8_UINT:
+    case DXGI_FORMAT_R8G8B8A8_SNORM:
+    case DXGI_FORMAT_R8G8B8A8_SINT:
+    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_R16G16_TYPELESS:
+    case DXGI_FORMAT_R16G16_FLOAT:
+    case DXGI_FORMAT_R16G16_UNORM:
+    case DXGI_FORMAT_R16G16_UINT:
+    case DXGI_FORMAT_R16G16_SNORM:
+    case DXGI_FORMAT_R16G16_SINT:
+    case DXGI_FORMAT_R32_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT:
+    case DXGI_FORMAT_R32_FLOAT:
+    case DXGI_FORMAT_R32_UINT:
+    case DXGI_FORMAT_R32_SINT:
+    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+        return { .size = 4, .width = 1, .height = 1 };
+    case DXGI_FORMAT_R8G8_TYPELESS:
+    case DXGI_FORMAT_R8G8_UNORM:
+    case DXGI_FORMAT_R8G8_UINT:
+    case DXGI_FORMAT_R8G8_SNORM:
+    case DXGI_FORMAT_R8G8_SINT:
+    case DXGI_FORMAT_R16_TYPELESS:
+    case DXGI_FORMAT_R16_FLOAT:
+    case DXGI_FORMAT_D16_UNORM:
+    case DXGI_FORMAT_R16_UNORM:
+    case DXGI_FORMAT_R16_UINT:
+    case DXGI_FORMAT_R16_SNORM:
+    case DXGI_FORMAT_R16_SINT:
+        return { .size = 2, .width = 1, .height = 1 };
+    case DXGI_FORMAT_R8_TYPELESS:
+    case DXGI_FORMAT_R8_UNORM:
+    case DXGI_FORMAT_R8_UINT:
+    case DXGI_FORMAT_R8_SNORM:
+    case DXGI_FORMAT_R8_SINT:
+    case DXGI_FORMAT_A8_UNORM:
+        return { .size = 1, .width = 1, .height = 1 };
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+        return { .size = 8, .width = 4, .height = 4 };
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return { .size = 16, .width = 4, .height = 4 };
+    default:
+        return { .size = 0, .width = 1, .height = 1 };
+    }
+}
+
+Descriptor_Allocator::Descriptor_Allocator(ID3D12DescriptorHeap* heap, ID3D12Device* device,
+    uint32_t single_descriptor_count)
+    : m_heap(heap)
+    , m_type(heap->GetDesc().Type)
+    , m_increment_size(device->GetDescriptorHandleIncrementSize(m_type))
+    , m_cpu_start(heap->GetCPUDescriptorHandleForHeapStart())
+    , m_gpu_start()
+    , m_capacity(m_type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV
         ? D3D12_MAX_SHADER_VISIBLE_DESCRIPTOR_HEAP_SIZE_TIER_2
-        : desc.Type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER
+        : m_type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER
             ? D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE
-            : MAX_RTV_DSV_DESCRIPTORS;
-    m_free_list.reserve(size);
+            : MAX_RTV_DSV_DESCRIPTORS)
+    , m_single_count(std::min(single_descriptor_count, m_capacity))
+    , m_head(NO_HEAD)
+    , m_next(std::make_unique<std::atomic<uint32_t>[]>(m_single_count))
+    , m_single_size(0)
+    , m_single_allocated_count(0)
+    , m_range_allocator(m_capacity - m_single_count)
+{
+    if (m_type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV || m_type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER)
+    {
+        m_gpu_start = m_heap->GetGPUDescriptorHandleForHeapStart();
+    }
 }
 
-Descriptor Descriptor_Allocator::allocate() noexcept
+Descriptor Descriptor_Allocator::allocate()
 {
-    uint32_t index = m_current_idx;
-    if (m_free_list.size() > 0)
+    uint32_t index = pop_free_index();
+    if (index == NO_HEAD)
     {
-        index = m_free_list.back();
-        m_free_list.pop_back();
+        index = m_single_size.load(std::memory_order_relaxed);
+        do
+        {
+            if (index >= m_single_count)
+            {
+                throw std::runtime_error("Descriptor heap is out of single descriptors.");
+            }
+        } while (!m_single_size.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
     }
-    else
+    m_single_allocated_count.fetch_add(1, std::memory_order_relaxed);
+    return get_descriptor(index);
+}
+
+void Descriptor_Allocator::free(uint32_t index) noexcept
+{
+    m_single_allocated_count.fetch_sub(1, std::memory_order_relaxed);
+    push_free_index(index);
+}
+
+Descriptor_Range Descriptor_Allocator::allocate_range(uint32_t count)
+{
+    auto range = m_range_allocator.allocate(count);
+    if (!range.is_valid())
     {
-        m_current_idx += 1;
+        throw std::runtime_error("Descriptor heap is out of contiguous descriptors.");
     }
+    return {
+        .index = m_single_count + range.offset,
+        .count = count,
+        .allocation = range.allocation
+    };
+}
 
-    D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle = {};
-    D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle = {};
+void Descriptor_Allocator::free_range(uint32_t allocation)
+{
+    m_range_allocator.free(allocation);
+}
+
+Descriptor_Allocator_Stats Descriptor_Allocator::get_stats() const noexcept
+{
+    return {
+        .capacity = m_capacity,
+        .allocated = m_single_allocated_count.load(std::memory_order_relaxed) + m_range_allocator.get_allocated_count()
+    };
+}
 
-    auto desc = m_heap->GetDesc(); // TODO: store type
-    auto increment_size = m_device->GetDescriptorHandleIncrementSize(desc.Type);
-    cpu_handle = m_heap->GetCPUDescriptorHandleForHeapStart();
-    cpu_handle.ptr += uint64_t(index) * increment_size;
+Descriptor Descriptor_Allocator::get_descriptor(uint32_t index) const noexcept
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle = m_cpu_start;
+    cpu_handle.ptr += uint64_t(index) * m_increment_size;
 
-    if (desc.Type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV || desc.Type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER)
+    D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle = {};
+    if (m_gpu_start.ptr != 0)
     {
-        gpu_handle = m_heap->GetGPUDescriptorHandleForHeapStart();
-        gpu_handle.ptr += uint64_t(index) * increment_size;
+        gpu_handle = m_gpu_start;
+        gpu_handle.ptr += uint64_t(index) * m_increment_size;
     }
 
     return {
@@ -110,8 +260,29 @@ Descriptor Descriptor_Allocator::allocate() noexcept
     };
 }
 
-void Descriptor_Allocator::free(uint32_t index) noexcept
+uint32_t Descriptor_Allocator::pop_free_index() noexcept
 {
-    m_free_list.push_back(index);
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    while (uint32_t(head) != NO_HEAD)
+    {
+        auto next = m_next[uint32_t(head)].load(std::memory_order_relaxed);
+        auto new_head = (((head >> 32) + 1) << 32) | next;
+        if (m_head.compare_exchange_weak(head, new_head,
+            std::memory_order_acquire, std::memory_order_acquire))
+        {
+            return uint32_t(head);
+        }
+    }
+    return NO_HEAD;
+}
+
+void Descriptor_Allocator::push_free_index(uint32_t index) noexcept
+{
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    do
+    {
+        m_next[index].store(uint32_t(head), std::memory_order_relaxed);
+    } while (!m_head.compare_exchange_weak(head, (head & 0xFFFFFFFF00000000ull) | index,
+        std::memory_order_release, std::memory_order_relaxed));
 }
 }
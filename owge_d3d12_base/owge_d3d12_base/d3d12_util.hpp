@@ -1,10 +1,14 @@
 #pragma once
 
+#include "owge_common/index_range_allocator.hpp"
+#include "owge_common/texture_footprint.hpp"
+
+#include <atomic>
 #include <cstdint>
 #include <include/d3d12.h>
 #include <exception>
+#include <memory>
 #include <string>
-#include <vector>
 
 namespace owge
 {
@@ -26,6 +30,9 @@ void throw_if_failed(HRESULT hr, const char* message);
 
 [[nodiscard]] DWORD wait_for_d3d12_queue_idle(ID3D12Device* device, ID3D12CommandQueue* queue);
 
+// Returns a zero sized block for formats that can't be uploaded to, like planar or video formats.
+[[nodiscard]] Texel_Block_Info get_dxgi_format_block_info(DXGI_FORMAT format);
+
 static constexpr uint32_t MAX_RTV_DSV_DESCRIPTORS = 128;
 
 struct Descriptor
@@ -35,18 +42,57 @@ struct Descriptor
     uint32_t index;
 };
 
+struct Descriptor_Allocator_Stats
+{
+    uint32_t capacity;
+    uint32_t allocated;
+};
+
+struct Descriptor_Range
+{
+    uint32_t index;
+    uint32_t count;
+    uint32_t allocation;
+};
+
+// The first `single_descriptor_count` descriptors of the heap are served one at a time from a
+// lock-free free list, the rest is suballocated in contiguous ranges by an Index_Range_Allocator,
+// which serves the descriptor tables of buffers and textures without locking. Keeping both
+// apart means freed single descriptors never fragment the ranges.
+// allocate and allocate_range throw std::runtime_error once their part of the heap is full.
 class Descriptor_Allocator
 {
 public:
-    Descriptor_Allocator(ID3D12DescriptorHeap* heap, ID3D12Device* device);
+    Descriptor_Allocator(ID3D12DescriptorHeap* heap, ID3D12Device* device, uint32_t single_descriptor_count);
 
-    [[nodiscard]] Descriptor allocate() noexcept;
+    [[nodiscard]] Descriptor allocate();
     void free(uint32_t index) noexcept;
 
+    [[nodiscard]] Descriptor_Range allocate_range(uint32_t count);
+    void free_range(uint32_t allocation);
+
+    [[nodiscard]] Descriptor get_descriptor(uint32_t index) const noexcept;
+    [[nodiscard]] Descriptor_Allocator_Stats get_stats() const noexcept;
+
 private:
+    static constexpr uint32_t NO_HEAD = ~0u;
+
+    [[nodiscard]] uint32_t pop_free_index() noexcept;
+    void push_free_index(uint32_t index) noexcept;
+
     ID3D12DescriptorHeap* m_heap;
-    ID3D12Device* m_device;
-    std::vector<uint32_t> m_free_list;
-    uint32_t m_current_idx;
+    D3D12_DESCRIPTOR_HEAP_TYPE m_type;
+    uint32_t m_increment_size;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_cpu_start;
+    D3D12_GPU_DESCRIPTOR_HANDLE m_gpu_start;
+    uint32_t m_capacity;
+    uint32_t m_single_count;
+    // Free list head packs the descriptor index with an ABA tag, m_next links free descriptors.
+    // Single descriptors that were never allocated are claimed by bumping m_single_size.
+    std::atomic<uint64_t> m_head;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_next;
+    std::atomic<uint32_t> m_single_size;
+    std::atomic<uint32_t> m_single_allocated_count;
+    Index_Range_Allocator m_range_allocator;
 };
 }
@@ -2,40 +2,73 @@
 #include "owge_render_engine/resource.hpp"
 #include "owge_render_engine/render_engine.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <functional>
+
 namespace owge
 {
-static constexpr uint64_t MAX_BINDSETS_IN_RESOURCE = 65536;
-static constexpr uint64_t BINDSET_ALLOCATOR_BUFFER_SIZE =
-    sizeof(uint32_t) * MAX_BINDSET_VALUES * MAX_BINDSETS_IN_RESOURCE;
+static constexpr uint64_t BINDSET_ALLOCATOR_BUFFER_SIZE = 4194304; // 4 MB
+static constexpr uint64_t BINDSET_PAGE_SIZE = 4096;
+static constexpr uint64_t DYNAMIC_BINDSET_RING_SIZE = 1048576; // 1 MB
+static constexpr uint64_t DYNAMIC_BINDSET_ALIGNMENT = 16;
+
+[[nodiscard]] static uint64_t get_bindset_all_dirty_mask(uint32_t value_count)
+{
+    return value_count == 64 ? ~0ull : (1ull << value_count) - 1;
+}
 
-void Bindset::write_data(uint32_t first_element, uint32_t element_count, void* values)
+void Bindset::write_data(uint32_t first_element, uint32_t element_count, const void* values)
 {
-    memcpy(static_cast<void*>(&data[first_element]), values, element_count * sizeof(uint32_t));
+    assert(first_element + element_count <= allocation.value_count());
+    for (uint32_t i = 0; i < element_count; ++i)
+    {
+        uint32_t value;
+        memcpy(&value, &static_cast<const uint32_t*>(values)[i], sizeof(uint32_t));
+        if (data[first_element + i] != value)
+        {
+            data[first_element + i] = value;
+            dirty_mask |= 1ull << (first_element + i);
+        }
+    }
 }
 
 void Bindset_Allocator::release_resources()
 {
-    for (auto resource : m_resources)
+    for (auto& size_class : m_size_classes)
     {
-        m_render_engine->destroy_buffer(resource);
+        for (auto resource : size_class.resources)
+        {
+            m_render_engine->destroy_buffer(resource);
+        }
     }
 }
 
 Bindset_Allocator::Bindset_Allocator(Render_Engine* render_engine)
     : m_render_engine(render_engine),
-    m_current_index(0)
+    m_size_classes()
 {}
 
-Bindset Bindset_Allocator::allocate_bindset()
+Bindset Bindset_Allocator::allocate_bindset(uint32_t value_count)
 {
+    auto size_class_index = get_size_class(value_count);
+    auto& size_class = m_size_classes[size_class_index];
+
     Bindset_Allocation allocation = {};
-    if (!m_freelist.empty())
+    if (!size_class.freelist.empty())
     {
-        allocation = m_freelist.back();
-        m_freelist.pop_back();
-        return Bindset(allocation);
+        allocation = size_class.freelist.back();
+        size_class.freelist.pop_back();
+        return Bindset{
+            .allocation = allocation,
+            .data = {},
+            .dirty_mask = get_bindset_all_dirty_mask(allocation.value_count())
+        };
     }
-    if (m_resources.empty() || m_current_index >= MAX_BINDSETS_IN_RESOURCE)
+    allocation.size_class = size_class_index;
+    auto bindset_size = uint32_t(sizeof(uint32_t)) * allocation.value_count();
+    if (size_class.resources.empty() || size_class.current_index >= BINDSET_ALLOCATOR_BUFFER_SIZE / bindset_size)
     {
         Buffer_Desc buffer_desc = {
             .size = BINDSET_ALLOCATOR_BUFFER_SIZE,
@@ -45,50 +78,185 @@ Bindset Bindset_Allocator::allocate_bindset()
         auto buffer_handle = m_render_engine->create_buffer(buffer_desc);
         auto& buffer = m_render_engine->get_buffer(buffer_handle);
         buffer.resource->SetName(L"Buffer:Bindset");
-        m_resources.push_back(buffer_handle);
+        size_class.resources.push_back(buffer_handle);
+        size_class.current_index = 0;
     }
-    allocation.offset = m_current_index * sizeof(uint32_t) * MAX_BINDSET_VALUES;
-    allocation.index = m_current_index;
-    allocation.bindless_idx = m_resources.back().bindless_idx;
-    allocation.resource = m_resources.back();
-    m_current_index += 1;
-    return Bindset(allocation);
+    allocation.offset = size_class.current_index * bindset_size;
+    allocation.index = size_class.current_index;
+    allocation.bindless_idx = size_class.resources.back().get_bindless_idx();
+    allocation.resource = size_class.resources.back();
+    size_class.current_index += 1;
+    // The memory behind a new bindset holds stale data, so the first update uploads everything.
+    return Bindset{
+        .allocation = allocation,
+        .data = {},
+        .dirty_mask = get_bindset_all_dirty_mask(allocation.value_count())
+    };
+}
+
+Bindset Bindset_Allocator::allocate_dynamic_bindset(uint32_t value_count)
+{
+    Bindset_Allocation allocation = {};
+    allocation.size_class = get_size_class(value_count);
+    allocation.dynamic = true;
+    return Bindset{
+        .allocation = allocation,
+        .data = {},
+        .dirty_mask = get_bindset_all_dirty_mask(allocation.value_count())
+    };
 }
 
 void Bindset_Allocator::delete_bindset(const Bindset& bindset)
 {
-    m_freelist.push_back(bindset.allocation);
+    m_size_classes[bindset.allocation.size_class].freelist.push_back(bindset.allocation);
+}
+
+uint16_t Bindset_Allocator::get_size_class(uint32_t value_count)
+{
+    assert(value_count <= MAX_BINDSET_VALUES);
+    return uint16_t(std::countr_zero(std::bit_ceil(std::max(value_count, MIN_BINDSET_VALUES)) / MIN_BINDSET_VALUES));
 }
 
-void Bindset_Stager::stage_bindset(
-    Render_Engine* render_engine,
-    const Bindset& bindset,
-    Staging_Buffer_Allocator* staging_buffer_allocator)
+Dynamic_Bindset_Allocator::Dynamic_Bindset_Allocator(Render_Engine* render_engine)
+    : m_render_engine(render_engine)
+    , m_ring(DYNAMIC_BINDSET_RING_SIZE)
+    , m_buffer()
+    , m_mapped_data(nullptr)
 {
-    static constexpr uint64_t ALLOC_SIZE = sizeof(uint32_t) * MAX_BINDSET_VALUES;
+    replace_ring(DYNAMIC_BINDSET_RING_SIZE);
+}
+
+void Dynamic_Bindset_Allocator::release_resources()
+{
+    if (m_mapped_data)
+    {
+        m_render_engine->destroy_buffer(m_buffer);
+        m_mapped_data = nullptr;
+    }
+}
+
+void Dynamic_Bindset_Allocator::write_bindset(Bindset& bindset)
+{
+    auto size = uint64_t(sizeof(uint32_t)) * bindset.allocation.value_count();
+    auto offset = m_ring.allocate(size, DYNAMIC_BINDSET_ALIGNMENT);
+    if (offset == FENCE_RING_NO_ALLOCATION)
+    {
+        // Frames in flight still read the old ring, it is destroyed once they retired.
+        replace_ring(m_ring.capacity() * 2);
+        offset = m_ring.allocate(size, DYNAMIC_BINDSET_ALIGNMENT);
+    }
+    memcpy(&static_cast<uint8_t*>(m_mapped_data)[offset], bindset.data, size);
+
+    auto& allocation = bindset.allocation;
+    allocation.bindless_idx = m_buffer.get_bindless_idx();
+    allocation.offset = uint32_t(offset);
+    allocation.resource = m_buffer;
+    bindset.dirty_mask = 0;
+}
+
+void Dynamic_Bindset_Allocator::submit(uint64_t frame)
+{
+    m_ring.submit(frame);
+}
+
+void Dynamic_Bindset_Allocator::reclaim(uint64_t retired_frame)
+{
+    m_ring.reclaim(retired_frame);
+}
+
+void Dynamic_Bindset_Allocator::replace_ring(uint64_t capacity)
+{
+    release_resources();
+    Buffer_Desc buffer_desc = {
+        .size = capacity,
+        .heap_type = D3D12_HEAP_TYPE_UPLOAD,
+        .usage = Resource_Usage::Read_Only
+    };
+    m_buffer = m_render_engine->create_buffer(buffer_desc, L"Buffer:Bindset:Dynamic_Ring");
+    m_render_engine->get_buffer(m_buffer).resource->Map(0, nullptr, &m_mapped_data);
+    m_ring.reset(capacity);
+}
+
+Bindset_Stager::Bindset_Stager(float page_upload_density)
+    : m_page_upload_density(page_upload_density)
+{}
+
+void Bindset_Stager::stage_bindset(Render_Engine* render_engine, Bindset& bindset)
+{
+    std::scoped_lock lock(m_mutex);
     auto& bindset_allocation = bindset.allocation;
-    auto& bindset_allocation_buffer = render_engine->get_buffer(bindset_allocation.resource);
-    auto staging_buffer_alloc = staging_buffer_allocator->allocate(ALLOC_SIZE);
-    memcpy(
-        &static_cast<uint8_t*>(staging_buffer_alloc.data)[staging_buffer_alloc.offset],
-        bindset.data,
-        ALLOC_SIZE);
-    auto& staged_bindset_copy = m_bindset_staged_copies.emplace_back();
-    staged_bindset_copy.src = staging_buffer_alloc.resource;
-    staged_bindset_copy.src_offset = staging_buffer_alloc.offset;
-    staged_bindset_copy.dst = bindset_allocation_buffer.resource;
-    staged_bindset_copy.dst_offset = bindset.allocation.offset;
-}
-
-void Bindset_Stager::process(ID3D12GraphicsCommandList7* cmd)
-{
-    for (const auto& staged_copy : m_bindset_staged_copies)
+    auto buffer = get_shadow_key(bindset_allocation.resource);
+    auto& shadow = m_shadows[buffer];
+    shadow.dst = render_engine->get_buffer(bindset_allocation.resource).resource;
+    auto first_dword = bindset_allocation.offset / sizeof(uint32_t);
+    if (shadow.data.size() < first_dword + bindset_allocation.value_count())
+    {
+        shadow.data.resize(first_dword + bindset_allocation.value_count());
+    }
+    while (bindset.dirty_mask != 0)
     {
+        auto first = uint32_t(std::countr_zero(bindset.dirty_mask));
+        auto count = uint32_t(std::countr_one(bindset.dirty_mask >> first));
+        memcpy(&shadow.data[first_dword + first], &bindset.data[first], count * sizeof(uint32_t));
+        m_dirty_ranges.push_back({
+            .buffer = buffer,
+            .begin = (first_dword + first) * sizeof(uint32_t),
+            .end = (first_dword + first + count) * sizeof(uint32_t)
+        });
+        bindset.dirty_mask &= count == 64 ? 0ull : ~(((1ull << count) - 1) << first);
+    }
+}
+
+void Bindset_Stager::process(ID3D12GraphicsCommandList7* cmd, Staging_Buffer_Allocator* staging_buffer_allocator)
+{
+    std::scoped_lock lock(m_mutex);
+    // The data lives in the shadows, so ranges staged twice in a frame just collapse.
+    merge_dirty_ranges(m_dirty_ranges);
+    m_flush_ranges.assign(m_dirty_ranges.begin(), m_dirty_ranges.end());
+
+    if (m_page_upload_density > 0.0f)
+    {
+        // Pull in the clean gaps of densely written pages, uploading them from the shadow is cheaper
+        // than issuing a copy per dirty range.
+        auto dense_size = uint64_t(float(BINDSET_PAGE_SIZE) * m_page_upload_density);
+        append_dense_pages(m_dirty_ranges, BINDSET_PAGE_SIZE, dense_size, [this](uint64_t buffer) {
+            return m_shadows[buffer].data.size() * sizeof(uint32_t);
+        }, m_flush_ranges);
+        merge_dirty_ranges(m_flush_ranges);
+    }
+
+    for (const auto& range : m_flush_ranges)
+    {
+        auto size = range.end - range.begin;
+        auto& shadow = m_shadows[range.buffer];
+        auto staging_buffer_alloc = staging_buffer_allocator->allocate(size);
+        memcpy(
+            &static_cast<uint8_t*>(staging_buffer_alloc.data)[staging_buffer_alloc.offset],
+            &shadow.data[range.begin / sizeof(uint32_t)],
+            size);
         cmd->CopyBufferRegion(
-            staged_copy.dst, staged_copy.dst_offset,
-            staged_copy.src, staged_copy.src_offset,
-            sizeof(uint32_t) * MAX_BINDSET_VALUES);
+            shadow.dst, range.begin,
+            staging_buffer_alloc.resource, staging_buffer_alloc.offset,
+            size);
+    }
+    m_dirty_ranges.clear();
+    m_flush_ranges.clear();
+}
+
+void Bindset_Stager::remove_buffer(Buffer_Handle buffer)
+{
+    std::scoped_lock lock(m_mutex);
+    auto key = get_shadow_key(buffer);
+    if (m_shadows.erase(key) > 0)
+    {
+        std::erase_if(m_dirty_ranges, [key](const Dirty_Range& range) {
+            return range.buffer == key;
+        });
     }
-    m_bindset_staged_copies.clear();
+}
+
+uint64_t Bindset_Stager::get_shadow_key(Buffer_Handle buffer)
+{
+    return (uint64_t(buffer.gen) << 32) | buffer.resource_idx;
 }
 }
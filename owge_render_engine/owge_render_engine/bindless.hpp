@@ -2,38 +2,68 @@
 
 #include "owge_render_engine/resource.hpp"
 
+#include <owge_common/dirty_range_merger.hpp>
+#include <owge_common/fence_ring_allocator.hpp>
+
+#include <array>
 #include <cstdint>
 #include <include/d3d12.h>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace owge
 {
-static constexpr uint32_t MAX_BINDSET_VALUES = 16;
+// Bindsets come in power of two size classes from MIN_BINDSET_VALUES to MAX_BINDSET_VALUES dwords.
+static constexpr uint32_t MIN_BINDSET_VALUES = 4;
+static constexpr uint32_t MAX_BINDSET_VALUES = 64;
+static constexpr uint32_t DEFAULT_BINDSET_VALUES = 16;
+static constexpr uint32_t BINDSET_SIZE_CLASS_COUNT = 5;
 
 struct Bindset_Allocation
 {
     uint32_t bindless_idx;
     uint32_t offset;
     uint32_t index;
+    uint16_t size_class;
+    // Dynamic bindsets live in the upload ring and are rewritten every frame they are used.
+    bool dynamic;
     Buffer_Handle resource;
+
+    [[nodiscard]] uint32_t value_count() const
+    {
+        return MIN_BINDSET_VALUES << size_class;
+    }
 };
 
+template<typename T>
+[[nodiscard]] constexpr uint32_t get_bindset_value_count()
+{
+    return uint32_t((sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+}
+
 struct Buffer;
 struct Texture;
 
 struct Bindset
 {
-    void write_data(uint32_t first_element, uint32_t element_count, void* values);
+    // Only dwords whose value changed are marked dirty and uploaded by the next `update_bindings`.
+    void write_data(uint32_t first_element, uint32_t element_count, const void* values);
 
     template<typename T>
     void write_data(const T& values)
     {
         static_assert(sizeof(T) <= sizeof(uint32_t) * MAX_BINDSET_VALUES);
-        memcpy(data, &values, sizeof(T));
+        uint32_t dwords[MAX_BINDSET_VALUES] = {};
+        memcpy(dwords, &values, sizeof(T));
+        write_data(0, get_bindset_value_count<T>(), dwords);
     }
 
     Bindset_Allocation allocation;
+    // Only the first `allocation.value_count()` values are backed by GPU memory.
     uint32_t data[MAX_BINDSET_VALUES];
+    // One bit per dword in `data`.
+    uint64_t dirty_mask;
 };
 
 class Render_Engine;
@@ -44,32 +74,81 @@ public:
     Bindset_Allocator(Render_Engine* render_engine);
 
     void release_resources();
-    [[nodiscard]] Bindset allocate_bindset();
+    [[nodiscard]] Bindset allocate_bindset(uint32_t value_count);
+    // Dynamic bindsets own no memory until they are written by the Dynamic_Bindset_Allocator.
+    [[nodiscard]] Bindset allocate_dynamic_bindset(uint32_t value_count);
     void delete_bindset(const Bindset& bindset);
 
+private:
+    [[nodiscard]] static uint16_t get_size_class(uint32_t value_count);
+
+private:
+    // Each size class fills its own bindset buffers and recycles through its own free list.
+    struct Bindset_Size_Class
+    {
+        std::vector<Bindset_Allocation> freelist;
+        std::vector<Buffer_Handle> resources;
+        uint32_t current_index;
+    };
+
+    Render_Engine* m_render_engine;
+    std::array<Bindset_Size_Class, BINDSET_SIZE_CLASS_COUNT> m_size_classes;
+};
+
+// Hands out per-frame bindset memory from a persistently mapped upload heap ring that shaders
+// read directly, so dynamic bindsets need neither a staging copy nor a copy barrier.
+class Dynamic_Bindset_Allocator
+{
+public:
+    Dynamic_Bindset_Allocator(Render_Engine* render_engine);
+
+    void release_resources();
+    // Copies all values of `bindset` into this frame's ring memory and points its allocation there.
+    void write_bindset(Bindset& bindset);
+    void submit(uint64_t frame);
+    void reclaim(uint64_t retired_frame);
+
+private:
+    void replace_ring(uint64_t capacity);
+
 private:
     Render_Engine* m_render_engine;
-    std::vector<Bindset_Allocation> m_freelist;
-    std::vector<Buffer_Handle> m_resources;
-    uint32_t m_current_index;
+    Fence_Ring_Allocator m_ring;
+    Buffer_Handle m_buffer;
+    void* m_mapped_data;
 };
 
 class Staging_Buffer_Allocator;
 
+// Collects dirty bindset ranges during the frame and flushes them as few, contiguous copies.
+// A CPU shadow of every bindset buffer is kept so neighbouring ranges can be uploaded together.
+// Shadows are keyed by buffer handle, so a destroyed buffer's shadow can't be picked up by a new
+// resource that reuses its address.
 class Bindset_Stager
 {
 public:
-    void stage_bindset(Render_Engine* render_engine, const Bindset& bindset, Staging_Buffer_Allocator* staging_buffer_allocator);
-    void process(ID3D12GraphicsCommandList7* cmd);
+    // Pages whose dirty fraction reaches `page_upload_density` are uploaded as a whole, 0 disables this.
+    Bindset_Stager(float page_upload_density);
+
+    void stage_bindset(Render_Engine* render_engine, Bindset& bindset);
+    void process(ID3D12GraphicsCommandList7* cmd, Staging_Buffer_Allocator* staging_buffer_allocator);
+    // Drops the shadow and the pending ranges of a destroyed buffer.
+    void remove_buffer(Buffer_Handle buffer);
 
 private:
-    struct Bindset_Staged_Allocation
+    struct Bindset_Shadow
     {
-        ID3D12Resource* src;
         ID3D12Resource* dst;
-        uint64_t src_offset;
-        uint64_t dst_offset;
+        std::vector<uint32_t> data;
     };
-    std::vector<Bindset_Staged_Allocation> m_bindset_staged_copies;
+
+    [[nodiscard]] static uint64_t get_shadow_key(Buffer_Handle buffer);
+
+    float m_page_upload_density;
+    // Buffers are destroyed from any thread, staging and processing are already serialized by the caller.
+    std::mutex m_mutex;
+    std::unordered_map<uint64_t, Bindset_Shadow> m_shadows;
+    std::vector<Dirty_Range> m_dirty_ranges;
+    std::vector<Dirty_Range> m_flush_ranges;
 };
 }
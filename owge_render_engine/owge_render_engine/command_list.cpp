@@ -8,16 +8,410 @@
 #include <WinPixEventRuntime/pix3.h>
 #endif // OWGE_USE_WIN_PIX_EVENT_RUNTIME
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cassert>
+#include <cstring>
 
 namespace owge
 {
-Barrier_Builder::Barrier_Builder(Render_Engine* render_engine, ID3D12GraphicsCommandList7* cmd)
-    : m_render_engine(render_engine)
-    , m_cmd(cmd)
+static constexpr D3D12_BARRIER_ACCESS WRITE_ACCESS_BITS =
+    D3D12_BARRIER_ACCESS_RENDER_TARGET |
+    D3D12_BARRIER_ACCESS_UNORDERED_ACCESS |
+    D3D12_BARRIER_ACCESS_DEPTH_STENCIL_WRITE |
+    D3D12_BARRIER_ACCESS_STREAM_OUTPUT |
+    D3D12_BARRIER_ACCESS_COPY_DEST |
+    D3D12_BARRIER_ACCESS_RESOLVE_DEST |
+    D3D12_BARRIER_ACCESS_RAYTRACING_ACCELERATION_STRUCTURE_WRITE;
+// Accesses whose barriers don't depend on a texture layout and can be expressed with a global barrier.
+static constexpr D3D12_BARRIER_ACCESS MERGEABLE_ACCESS_BITS =
+    D3D12_BARRIER_ACCESS_VERTEX_BUFFER |
+    D3D12_BARRIER_ACCESS_CONSTANT_BUFFER |
+    D3D12_BARRIER_ACCESS_INDEX_BUFFER |
+    D3D12_BARRIER_ACCESS_UNORDERED_ACCESS |
+    D3D12_BARRIER_ACCESS_SHADER_RESOURCE |
+    D3D12_BARRIER_ACCESS_INDIRECT_ARGUMENT |
+    D3D12_BARRIER_ACCESS_COPY_DEST |
+    D3D12_BARRIER_ACCESS_COPY_SOURCE;
+
+// COMMON allows any access the layout supports, so it is treated as a write.
+[[nodiscard]] static bool has_write_access(D3D12_BARRIER_ACCESS access)
+{
+    return access == D3D12_BARRIER_ACCESS_COMMON || (access & WRITE_ACCESS_BITS) != 0;
+}
+
+[[nodiscard]] static bool is_mergeable_access(D3D12_BARRIER_ACCESS access)
+{
+    return access != D3D12_BARRIER_ACCESS_COMMON && (access & ~MERGEABLE_ACCESS_BITS) == 0;
+}
+
+template<typename Fn>
+static void for_each_subresource(const Texture_Subresource_Layout& layout,
+    const D3D12_BARRIER_SUBRESOURCE_RANGE& range, Fn&& fn)
+{
+    if (range.NumMipLevels == 0)
+    {
+        if (range.IndexOrFirstMipLevel != 0xFFFFFFFF)
+        {
+            fn(range.IndexOrFirstMipLevel);
+            return;
+        }
+        for (uint32_t subresource = 0; subresource < layout.subresource_count(); ++subresource)
+        {
+            fn(subresource);
+        }
+        return;
+    }
+    for (uint32_t plane = range.FirstPlane; plane < range.FirstPlane + std::max(range.NumPlanes, 1u); ++plane)
+    {
+        for (uint32_t array_layer = range.FirstArraySlice;
+            array_layer < range.FirstArraySlice + std::max(range.NumArraySlices, 1u); ++array_layer)
+        {
+            for (uint32_t mip = range.IndexOrFirstMipLevel; mip < range.IndexOrFirstMipLevel + range.NumMipLevels; ++mip)
+            {
+                fn(layout.get_subresource(mip, array_layer, plane));
+            }
+        }
+    }
+}
+
+Barrier_Builder::Barrier_Builder(Render_Engine* render_engine, Command_Stream* stream, D3D12_COMMAND_LIST_TYPE queue,
+    Resource_State_Tracker* tracker)
+    : m_stream(stream)
+    , m_render_engine(render_engine)
+    , m_tracker(tracker != nullptr ? tracker : render_engine->get_resource_state_tracker())
+    , m_queue(queue)
 {}
 
 void Barrier_Builder::push(const Texture_Barrier& barrier)
+{
+    m_requested_barrier_count += 1;
+    push_texture_barrier(barrier);
+    if (barrier.texture.is_null_handle())
+    {
+        return;
+    }
+    auto states = m_tracker->get_texture_states(barrier.texture);
+    for_each_subresource(m_tracker->get_texture_subresource_layout(barrier.texture), barrier.subresources,
+        [&](uint32_t subresource) {
+            states[subresource] = {
+                .sync = barrier.sync_after,
+                .access = barrier.access_after,
+                .layout = barrier.layout_after,
+                .queue = m_queue
+            };
+        });
+}
+
+void Barrier_Builder::push(const Buffer_Barrier& barrier)
+{
+    m_requested_barrier_count += 1;
+    auto& buffer = m_render_engine->get_buffer(barrier.buffer);
+    m_buffer_barriers.push_back({
+        .SyncBefore = barrier.sync_before,
+        .SyncAfter = barrier.sync_after,
+        .AccessBefore = barrier.access_before,
+        .AccessAfter = barrier.access_after,
+        .pResource = buffer.resource,
+        .Offset = 0,
+        .Size = ~0ull
+        });
+    m_tracker->get_buffer_state(barrier.buffer) = {
+        .sync = barrier.sync_after,
+        .access = barrier.access_after,
+        .queue = m_queue
+    };
+}
+
+void Barrier_Builder::push(const Memory_Barrier& barrier)
+{
+    m_requested_barrier_count += 1;
+    m_global_barriers.push_back({
+        .SyncBefore = barrier.sync_before,
+        .SyncAfter = barrier.sync_after,
+        .AccessBefore = barrier.access_before,
+        .AccessAfter = barrier.access_after
+        });
+}
+
+void Barrier_Builder::use(const Texture_Usage& usage)
+{
+    use_texture(usage, false);
+}
+
+void Barrier_Builder::begin_use(const Texture_Usage& usage)
+{
+    use_texture(usage, true);
+}
+
+void Barrier_Builder::end_split_barriers()
+{
+    for (const auto& split : m_split_barriers)
+    {
+        auto end = split.begin;
+        end.SyncBefore = D3D12_BARRIER_SYNC_SPLIT;
+        end.SyncAfter = split.usage.sync;
+        m_texture_barriers.push_back(end);
+        auto states = m_tracker->get_texture_states(split.usage.texture);
+        for_each_subresource(m_tracker->get_texture_subresource_layout(split.usage.texture), end.Subresources,
+            [&](uint32_t subresource) {
+                states[subresource].sync = split.usage.sync;
+            });
+    }
+    m_split_barriers.clear();
+}
+
+void Barrier_Builder::use_texture(const Texture_Usage& usage, bool split)
+{
+    m_requested_barrier_count += 1;
+    if (end_split_barriers(usage))
+    {
+        return;
+    }
+    auto states = m_tracker->get_texture_states(usage.texture);
+    const auto& layout = m_tracker->get_texture_subresource_layout(usage.texture);
+
+    uint32_t covered_count = 0;
+    uint32_t pending_count = 0;
+    bool uniform = true;
+    Texture_State reference = {};
+    for_each_subresource(layout, usage.subresources, [&](uint32_t subresource) {
+        const auto& state = states[subresource];
+        covered_count += 1;
+        if (!needs_barrier(state, usage))
+        {
+            return;
+        }
+        if (pending_count == 0)
+        {
+            reference = state;
+        }
+        uniform = uniform &&
+            state.sync == reference.sync &&
+            state.access == reference.access &&
+            state.layout == reference.layout &&
+            state.queue == reference.queue;
+        pending_count += 1;
+    });
+
+    // One barrier covers the whole range if every subresource in it needs the same transition.
+    if (pending_count > 0 && pending_count == covered_count && uniform)
+    {
+        push_tracked_texture_barrier(usage, reference, usage.subresources, split);
+    }
+    Texture_State state_after = {
+        .sync = split ? D3D12_BARRIER_SYNC_SPLIT : usage.sync,
+        .access = usage.access,
+        .layout = usage.layout,
+        .queue = m_queue
+    };
+    for_each_subresource(layout, usage.subresources, [&](uint32_t subresource) {
+        auto& state = states[subresource];
+        if (state.queue == D3D12_COMMAND_LIST_TYPE_NONE)
+        {
+            m_tracker->get_texture_requirements(usage.texture)[subresource] = {
+                .required = true,
+                .discard = usage.discard,
+                .sync = usage.sync,
+                .access = usage.access,
+                .layout = usage.layout
+            };
+            state = {
+                .sync = usage.sync,
+                .access = usage.access,
+                .layout = usage.layout,
+                .queue = m_queue
+            };
+        }
+        else if (needs_barrier(state, usage))
+        {
+            if (pending_count != covered_count || !uniform)
+            {
+                push_tracked_texture_barrier(usage, state, {
+                    .IndexOrFirstMipLevel = subresource,
+                    .NumMipLevels = 0
+                }, split);
+            }
+            state = state_after;
+        }
+        else if (usage.access == D3D12_BARRIER_ACCESS_NO_ACCESS)
+        {
+            return;
+        }
+        else if (state.access == D3D12_BARRIER_ACCESS_NO_ACCESS || state.queue != m_queue)
+        {
+            state.sync = usage.sync;
+            state.access = usage.access;
+            state.queue = m_queue;
+        }
+        else
+        {
+            state.sync |= usage.sync;
+            state.access |= usage.access;
+        }
+    });
+}
+
+void Barrier_Builder::use(const Buffer_Usage& usage)
+{
+    m_requested_barrier_count += 1;
+    auto& state = m_tracker->get_buffer_state(usage.buffer);
+    if (state.queue == D3D12_COMMAND_LIST_TYPE_NONE)
+    {
+        m_tracker->get_buffer_requirement(usage.buffer) = {
+            .required = true,
+            .sync = usage.sync,
+            .access = usage.access
+        };
+        state = {
+            .sync = usage.sync,
+            .access = usage.access,
+            .queue = m_queue
+        };
+        return;
+    }
+    // Buffers that weren't used through a barrier yet only hold uploads, which the upload barrier made visible.
+    auto untouched = state.access == D3D12_BARRIER_ACCESS_COMMON && state.sync == D3D12_BARRIER_SYNC_NONE;
+    auto needed = untouched
+        ? has_write_access(usage.access)
+        : has_write_access(state.access) ||
+          has_write_access(usage.access) ||
+          (state.access == D3D12_BARRIER_ACCESS_NO_ACCESS &&
+           state.queue == m_queue &&
+           usage.access != D3D12_BARRIER_ACCESS_NO_ACCESS);
+    if (!needed)
+    {
+        if (usage.access != D3D12_BARRIER_ACCESS_NO_ACCESS)
+        {
+            state.sync |= usage.sync;
+            state.access |= usage.access;
+            state.queue = m_queue;
+        }
+        return;
+    }
+
+    auto synchronized_by_fence = untouched || state.queue != m_queue;
+    m_buffer_barriers.push_back({
+        .SyncBefore = synchronized_by_fence ? D3D12_BARRIER_SYNC_NONE : state.sync,
+        .SyncAfter = usage.sync,
+        .AccessBefore = synchronized_by_fence ? D3D12_BARRIER_ACCESS_NO_ACCESS : state.access,
+        .AccessAfter = usage.access,
+        .pResource = m_render_engine->get_buffer(usage.buffer).resource,
+        .Offset = 0,
+        .Size = ~0ull
+        });
+    state = {
+        .sync = usage.sync,
+        .access = usage.access,
+        .queue = m_queue
+    };
+}
+
+void Barrier_Builder::flush()
+{
+    if (m_requested_barrier_count == 0 &&
+        m_texture_barriers.empty() && m_buffer_barriers.empty() && m_global_barriers.empty())
+    {
+        return;
+    }
+    merge_memory_barriers();
+    auto emitted_barrier_count = uint32_t(
+        m_texture_barriers.size() + m_buffer_barriers.size() + m_global_barriers.size());
+    m_render_engine->add_barrier_stats(m_requested_barrier_count, emitted_barrier_count);
+    m_requested_barrier_count = 0;
+    if (emitted_barrier_count == 0)
+    {
+        return;
+    }
+
+    auto texture_barrier_size = m_texture_barriers.size() * sizeof(D3D12_TEXTURE_BARRIER);
+    auto buffer_barrier_size = m_buffer_barriers.size() * sizeof(D3D12_BUFFER_BARRIER);
+    auto global_barrier_size = m_global_barriers.size() * sizeof(D3D12_GLOBAL_BARRIER);
+    auto& packet = m_stream->push<Command_Barrier>(Command_Type::Barrier,
+        uint32_t(texture_barrier_size + buffer_barrier_size + global_barrier_size));
+    packet = {
+        .texture_barrier_count = uint32_t(m_texture_barriers.size()),
+        .buffer_barrier_count = uint32_t(m_buffer_barriers.size()),
+        .global_barrier_count = uint32_t(m_global_barriers.size())
+    };
+    auto data = Command_Stream::get_trailing_data(packet);
+    std::ranges::copy(m_texture_barriers, reinterpret_cast<D3D12_TEXTURE_BARRIER*>(data));
+    std::ranges::copy(m_buffer_barriers, reinterpret_cast<D3D12_BUFFER_BARRIER*>(data + texture_barrier_size));
+    std::ranges::copy(m_global_barriers,
+        reinterpret_cast<D3D12_GLOBAL_BARRIER*>(data + texture_barrier_size + buffer_barrier_size));
+    m_texture_barriers.clear();
+    m_buffer_barriers.clear();
+    m_global_barriers.clear();
+}
+
+void Barrier_Builder::resolve(Resource_State_Tracker& local_tracker)
+{
+    for (auto texture : local_tracker.get_used_textures())
+    {
+        auto requirements = local_tracker.get_texture_requirements(texture);
+        const auto& first = requirements.front();
+        auto uniform = std::ranges::all_of(requirements, [&](const Texture_Requirement& requirement) {
+            return requirement.required &&
+                requirement.discard == first.discard &&
+                requirement.sync == first.sync &&
+                requirement.access == first.access &&
+                requirement.layout == first.layout;
+        });
+        for (uint32_t subresource = 0; subresource < uint32_t(requirements.size()); ++subresource)
+        {
+            const auto& requirement = requirements[subresource];
+            if (!requirement.required)
+            {
+                continue;
+            }
+            use(Texture_Usage{
+                .texture = texture,
+                .sync = requirement.sync,
+                .access = requirement.access,
+                .layout = requirement.layout,
+                .subresources = uniform
+                    ? ALL_SUBRESOURCES
+                    : D3D12_BARRIER_SUBRESOURCE_RANGE{ .IndexOrFirstMipLevel = subresource, .NumMipLevels = 0 },
+                .discard = requirement.discard
+                });
+            if (uniform)
+            {
+                break;
+            }
+        }
+
+        auto local_states = local_tracker.get_texture_states(texture);
+        auto states = m_tracker->get_texture_states(texture);
+        for (uint32_t subresource = 0; subresource < uint32_t(local_states.size()); ++subresource)
+        {
+            if (local_states[subresource].queue != D3D12_COMMAND_LIST_TYPE_NONE)
+            {
+                states[subresource] = local_states[subresource];
+            }
+        }
+    }
+    for (auto buffer : local_tracker.get_used_buffers())
+    {
+        const auto& requirement = local_tracker.get_buffer_requirement(buffer);
+        if (requirement.required)
+        {
+            use(Buffer_Usage{
+                .buffer = buffer,
+                .sync = requirement.sync,
+                .access = requirement.access
+                });
+        }
+        const auto& local_state = local_tracker.get_buffer_state(buffer);
+        if (local_state.queue != D3D12_COMMAND_LIST_TYPE_NONE)
+        {
+            m_tracker->get_buffer_state(buffer) = local_state;
+        }
+    }
+    local_tracker.clear();
+}
+
+void Barrier_Builder::push_texture_barrier(const Texture_Barrier& barrier)
 {
     if (barrier.texture.is_null_handle())
     {
@@ -37,8 +431,16 @@ void Barrier_Builder::push(const Texture_Barrier& barrier)
     else
     {
         auto& texture = m_render_engine->get_texture(barrier.texture);
+        // Acquiring aliased memory has to wait for whatever used it before, not only for this texture's accesses.
+        auto sync_before = barrier.sync_before;
+        if ((barrier.texture.flags & TEXTURE_FLAG_ALIASED) &&
+            barrier.layout_before == D3D12_BARRIER_LAYOUT_UNDEFINED &&
+            sync_before == D3D12_BARRIER_SYNC_NONE)
+        {
+            sync_before = D3D12_BARRIER_SYNC_ALL;
+        }
         m_texture_barriers.push_back({
-            .SyncBefore = barrier.sync_before,
+            .SyncBefore = sync_before,
             .SyncAfter = barrier.sync_after,
             .AccessBefore = barrier.access_before,
             .AccessAfter = barrier.access_after,
@@ -51,92 +453,234 @@ void Barrier_Builder::push(const Texture_Barrier& barrier)
     }
 }
 
-void Barrier_Builder::push(const Buffer_Barrier& barrier)
+void Barrier_Builder::push_tracked_texture_barrier(const Texture_Usage& usage, const Texture_State& state,
+    const D3D12_BARRIER_SUBRESOURCE_RANGE& subresources, bool split)
 {
-    auto& buffer = m_render_engine->get_buffer(barrier.buffer);
-    m_buffer_barriers.push_back({
-        .SyncBefore = barrier.sync_before,
-        .SyncAfter = barrier.sync_after,
-        .AccessBefore = barrier.access_before,
-        .AccessAfter = barrier.access_after,
-        .pResource = buffer.resource,
-        .Offset = 0,
-        .Size = ~0ull
+    // Accesses on another queue were already waited for through a fence. Discarding aliased memory
+    // leaves sync_before to push_texture_barrier, which has to wait for the other resources in it.
+    auto synchronized_by_fence = state.queue != m_queue;
+    auto aliased_discard = usage.discard && (usage.texture.flags & TEXTURE_FLAG_ALIASED);
+    auto layout_before = usage.discard ? D3D12_BARRIER_LAYOUT_UNDEFINED : state.layout;
+    push_texture_barrier({
+        .texture = usage.texture,
+        .swapchain = nullptr,
+        .sync_before = synchronized_by_fence || aliased_discard ? D3D12_BARRIER_SYNC_NONE : state.sync,
+        .sync_after = split ? D3D12_BARRIER_SYNC_SPLIT : usage.sync,
+        .access_before = synchronized_by_fence || layout_before == D3D12_BARRIER_LAYOUT_UNDEFINED
+            ? D3D12_BARRIER_ACCESS_NO_ACCESS
+            : state.access,
+        .access_after = usage.access,
+        .layout_before = layout_before,
+        .layout_after = usage.layout,
+        .subresources = subresources,
+        .flags = D3D12_TEXTURE_BARRIER_FLAG_NONE
+    });
+    if (split)
+    {
+        m_split_barriers.push_back({
+            .usage = usage,
+            .begin = m_texture_barriers.back()
         });
+    }
 }
 
-void Barrier_Builder::push(const Memory_Barrier& barrier)
+bool Barrier_Builder::end_split_barriers(const Texture_Usage& usage)
 {
-    m_global_barriers.push_back({
-        .SyncBefore = barrier.sync_before,
-        .SyncAfter = barrier.sync_after,
-        .AccessBefore = barrier.access_before,
-        .AccessAfter = barrier.access_after
+    auto states = m_tracker->get_texture_states(usage.texture);
+    const auto& layout = m_tracker->get_texture_subresource_layout(usage.texture);
+    auto pending = false;
+    auto completes_usage = !usage.discard;
+    for_each_subresource(layout, usage.subresources, [&](uint32_t subresource) {
+        const auto& state = states[subresource];
+        if (state.sync != D3D12_BARRIER_SYNC_SPLIT)
+        {
+            completes_usage = false;
+            return;
+        }
+        pending = true;
+        completes_usage = completes_usage && state.layout == usage.layout && state.access == usage.access;
+    });
+    if (!pending)
+    {
+        return false;
+    }
+
+    // The end barrier has to match the begin barrier. If it doesn't transition to the requested state,
+    // the barrier emitted afterwards is chained to it through `usage.sync`.
+    std::erase_if(m_split_barriers, [&](const Split_Barrier& split) {
+        if (split.usage.texture != usage.texture)
+        {
+            return false;
+        }
+        auto end = split.begin;
+        end.SyncBefore = D3D12_BARRIER_SYNC_SPLIT;
+        end.SyncAfter = usage.sync;
+        m_texture_barriers.push_back(end);
+        for_each_subresource(layout, end.Subresources, [&](uint32_t subresource) {
+            states[subresource].sync = usage.sync;
         });
+        return true;
+    });
+    return completes_usage;
 }
 
-void Barrier_Builder::flush()
+bool Barrier_Builder::needs_barrier(const Texture_State& state, const Texture_Usage& usage) const
 {
-    uint32_t barrier_group_count = 0;
-    std::array<D3D12_BARRIER_GROUP, 3> barrier_groups = {};
-    if (m_texture_barriers.size() > 0)
+    // Unknown states become requirements, which are resolved after recording.
+    if (state.queue == D3D12_COMMAND_LIST_TYPE_NONE)
     {
-        auto& barrier_group = barrier_groups[barrier_group_count];
-        barrier_group.Type = D3D12_BARRIER_TYPE_TEXTURE;
-        barrier_group.NumBarriers = uint32_t(m_texture_barriers.size());
-        barrier_group.pTextureBarriers = m_texture_barriers.data();
-        barrier_group_count += 1;
+        return false;
     }
-    if (m_buffer_barriers.size() > 0)
+    if (usage.discard ||
+        state.layout != usage.layout ||
+        has_write_access(state.access) ||
+        has_write_access(usage.access))
     {
-        auto& barrier_group = barrier_groups[barrier_group_count];
-        barrier_group.Type = D3D12_BARRIER_TYPE_BUFFER;
-        barrier_group.NumBarriers = uint32_t(m_buffer_barriers.size());
-        barrier_group.pBufferBarriers = m_buffer_barriers.data();
-        barrier_group_count += 1;
+        return true;
     }
-    if (m_global_barriers.size() > 0)
+    // Accesses were revoked on this queue, on other queues the fence makes the texture accessible again.
+    return state.access == D3D12_BARRIER_ACCESS_NO_ACCESS &&
+        state.queue == m_queue &&
+        usage.access != D3D12_BARRIER_ACCESS_NO_ACCESS;
+}
+
+void Barrier_Builder::merge_memory_barriers()
+{
+    auto is_mergeable_texture_barrier = [](const D3D12_TEXTURE_BARRIER& barrier) {
+        return barrier.LayoutBefore == barrier.LayoutAfter &&
+            barrier.SyncBefore != D3D12_BARRIER_SYNC_SPLIT &&
+            barrier.SyncAfter != D3D12_BARRIER_SYNC_SPLIT &&
+            barrier.Flags == D3D12_TEXTURE_BARRIER_FLAG_NONE &&
+            is_mergeable_access(barrier.AccessBefore) &&
+            is_mergeable_access(barrier.AccessAfter);
+    };
+    auto is_mergeable_buffer_barrier = [](const D3D12_BUFFER_BARRIER& barrier) {
+        return is_mergeable_access(barrier.AccessBefore) && is_mergeable_access(barrier.AccessAfter);
+    };
+    auto mergeable_count =
+        std::ranges::count_if(m_texture_barriers, is_mergeable_texture_barrier) +
+        std::ranges::count_if(m_buffer_barriers, is_mergeable_buffer_barrier);
+    if (mergeable_count < 2)
     {
-        auto& barrier_group = barrier_groups[barrier_group_count];
-        barrier_group.Type = D3D12_BARRIER_TYPE_GLOBAL;
-        barrier_group.NumBarriers = uint32_t(m_global_barriers.size());
-        barrier_group.pGlobalBarriers = m_global_barriers.data();
-        barrier_group_count += 1;
+        return;
     }
-    m_cmd->Barrier(barrier_group_count, barrier_groups.data());
-    m_texture_barriers.clear();
-    m_buffer_barriers.clear();
-    m_global_barriers.clear();
+
+    D3D12_GLOBAL_BARRIER merged = {
+        .SyncBefore = D3D12_BARRIER_SYNC_NONE,
+        .SyncAfter = D3D12_BARRIER_SYNC_NONE,
+        .AccessBefore = D3D12_BARRIER_ACCESS_COMMON,
+        .AccessAfter = D3D12_BARRIER_ACCESS_COMMON
+    };
+    auto merge = [&](const auto& barrier) {
+        merged.SyncBefore |= barrier.SyncBefore;
+        merged.SyncAfter |= barrier.SyncAfter;
+        merged.AccessBefore |= barrier.AccessBefore;
+        merged.AccessAfter |= barrier.AccessAfter;
+    };
+    std::erase_if(m_texture_barriers, [&](const D3D12_TEXTURE_BARRIER& barrier) {
+        if (!is_mergeable_texture_barrier(barrier))
+        {
+            return false;
+        }
+        merge(barrier);
+        return true;
+    });
+    std::erase_if(m_buffer_barriers, [&](const D3D12_BUFFER_BARRIER& barrier) {
+        if (!is_mergeable_buffer_barrier(barrier))
+        {
+            return false;
+        }
+        merge(barrier);
+        return true;
+    });
+    m_global_barriers.push_back(merged);
+}
+
+template<typename Handle>
+[[nodiscard]] static uint64_t to_packet_handle(Handle handle)
+{
+    return std::bit_cast<uint64_t>(handle);
+}
+
+template<typename Handle>
+[[nodiscard]] static Handle from_packet_handle(uint64_t handle)
+{
+    return std::bit_cast<Handle>(handle);
+}
+
+static void push_constants(Command_Stream* stream, bool graphics,
+    uint32_t count, const void* constants, uint32_t first_constant)
+{
+    auto& packet = stream->push<Command_Set_Constants>(Command_Type::Set_Constants, count * sizeof(uint32_t));
+    packet = {
+        .first_constant = first_constant,
+        .count = count,
+        .graphics = graphics
+    };
+    std::memcpy(Command_Stream::get_trailing_data(packet), constants, count * sizeof(uint32_t));
+}
+
+static void push_event(Command_Stream* stream, Command_Type type, const char* message)
+{
+    auto length = uint32_t(std::strlen(message));
+    auto& packet = stream->push<Command_Event>(type, length + 1);
+    packet.length = length;
+    std::memcpy(Command_Stream::get_trailing_data(packet), message, length + 1);
 }
 
-Command_List::Command_List(Render_Engine* render_engine, ID3D12GraphicsCommandList7* cmd)
-    : m_render_engine(render_engine), m_cmd(cmd)
+Command_List::Command_List(Render_Engine* render_engine, ID3D12GraphicsCommandList7* cmd, Command_Stream* stream,
+    Resource_State_Tracker* tracker)
+    : m_render_engine(render_engine)
+    , m_cmd(cmd)
+    , m_stream(stream)
+    , m_barrier_builder(render_engine, stream, cmd->GetType(), tracker)
 {}
 
-Barrier_Builder Command_List::acquire_barrier_builder()
+void Command_List::flush()
+{
+    m_barrier_builder.end_split_barriers();
+    m_barrier_builder.flush();
+    translate();
+    assert(m_open_event_count == 0);
+}
+
+void Command_List::sort_by_pipeline()
 {
-    return Barrier_Builder(m_render_engine, m_cmd);
+    m_stream->sort_by_pipeline();
 }
 
 void Command_List::clear_depth_stencil(Texture_Handle texture, D3D12_CLEAR_FLAGS flags, float depth, uint8_t stencil)
 {
-    m_cmd->ClearDepthStencilView(m_render_engine->get_cpu_descriptor_from_texture(texture), flags, depth, stencil, 0, nullptr);
+    m_barrier_builder.flush();
+    auto& packet = m_stream->push<Command_Clear_Depth_Stencil>(Command_Type::Clear_Depth_Stencil);
+    packet = {
+        .texture = to_packet_handle(texture),
+        .flags = uint32_t(flags),
+        .depth = depth,
+        .stencil = stencil
+    };
 }
 
 void Command_List::clear_render_target(D3D12_Swapchain* swapchain, float clear_color[4])
 {
-    auto swapchain_resources = swapchain->get_acquired_resources();
-    m_cmd->ClearRenderTargetView(swapchain_resources.rtv_descriptor, clear_color, 0, nullptr);
+    m_barrier_builder.flush();
+    auto& packet = m_stream->push<Command_Clear_Render_Target>(Command_Type::Clear_Render_Target);
+    packet.swapchain = reinterpret_cast<uint64_t>(swapchain);
+    std::copy_n(clear_color, 4, packet.color);
 }
 
 void Command_List::clear_render_target(Texture_Handle texture, float clear_color[4])
 {
-    m_cmd->ClearRenderTargetView(m_render_engine->get_cpu_descriptor_from_texture(texture), clear_color, 0, nullptr);
+    m_barrier_builder.flush();
+    auto& packet = m_stream->push<Command_Clear_Render_Target>(Command_Type::Clear_Render_Target);
+    packet.texture = to_packet_handle(texture);
+    std::copy_n(clear_color, 4, packet.color);
 }
 
 void Command_List::dispatch(uint32_t x, uint32_t y, uint32_t z)
 {
-    m_cmd->Dispatch(x, y, z);
+    m_barrier_builder.flush();
+    m_stream->push<Command_Dispatch>(Command_Type::Dispatch) = { .x = x, .y = y, .z = z };
 }
 
 void Command_List::dispatch_div_by_workgroups(Pipeline_Handle pso, uint32_t x, uint32_t y, uint32_t z,
@@ -146,12 +690,13 @@ void Command_List::dispatch_div_by_workgroups(Pipeline_Handle pso, uint32_t x, u
     auto groups_x = x / (div_x ? pipeline.workgroups_x : 1);
     auto groups_y = y / (div_y ? pipeline.workgroups_y : 1);
     auto groups_z = z / (div_z ? pipeline.workgroups_z : 1);
-    m_cmd->Dispatch(groups_x, groups_y, groups_z);
+    dispatch(groups_x, groups_y, groups_z);
 }
 
 void Command_List::dispatch_mesh(uint32_t x, uint32_t y, uint32_t z)
 {
-    m_cmd->DispatchMesh(x, y, z);
+    m_barrier_builder.flush();
+    m_stream->push<Command_Dispatch>(Command_Type::Dispatch_Mesh) = { .x = x, .y = y, .z = z };
 }
 
 void Command_List::dispatch_mesh_div_by_workgroups(Pipeline_Handle pso, uint32_t x, uint32_t y, uint32_t z,
@@ -161,139 +706,328 @@ void Command_List::dispatch_mesh_div_by_workgroups(Pipeline_Handle pso, uint32_t
     auto groups_x = x / ( div_x ? pipeline.workgroups_x : 1 );
     auto groups_y = y / ( div_y ? pipeline.workgroups_y : 1 );
     auto groups_z = z / ( div_z ? pipeline.workgroups_z : 1 );
-    m_cmd->DispatchMesh(groups_x, groups_y, groups_z);
+    dispatch_mesh(groups_x, groups_y, groups_z);
 }
 
 void Command_List::draw(uint32_t vertex_count, uint32_t vertex_offset,
     uint32_t instance_count, uint32_t instance_offset)
 {
-    m_cmd->DrawInstanced(vertex_count, instance_count, vertex_offset, instance_offset);
+    m_barrier_builder.flush();
+    m_stream->push<Command_Draw>(Command_Type::Draw) = {
+        .vertex_count = vertex_count,
+        .vertex_offset = vertex_offset,
+        .instance_count = instance_count,
+        .instance_offset = instance_offset
+    };
 }
 
 void Command_List::draw_indexed(uint32_t index_count, uint32_t index_offset,
     uint32_t instance_count, uint32_t instance_offset, uint32_t base_vertex)
 {
-    m_cmd->DrawIndexedInstanced(index_count, instance_count, index_offset, base_vertex, instance_offset);
+    m_barrier_builder.flush();
+    m_stream->push<Command_Draw_Indexed>(Command_Type::Draw_Indexed) = {
+        .index_count = index_count,
+        .index_offset = index_offset,
+        .instance_count = instance_count,
+        .instance_offset = instance_offset,
+        .base_vertex = base_vertex
+    };
 }
 
 void Command_List::set_bindset_compute(const Bindset& bindset, uint32_t first_element)
 {
-    auto& alloc = bindset.allocation;
-    m_cmd->SetComputeRoot32BitConstants(0, 2, &alloc, first_element);
+    push_constants(m_stream, false, 2, &bindset.allocation, first_element);
 }
 
 void Command_List::set_bindset_graphics(const Bindset& bindset, uint32_t first_element)
 {
-    auto& alloc = bindset.allocation;
-    m_cmd->SetGraphicsRoot32BitConstants(0, 2, &alloc, first_element);
+    push_constants(m_stream, true, 2, &bindset.allocation, first_element);
 }
 
 void Command_List::set_constants_compute(uint32_t count, void* constants, uint32_t first_constant)
 {
-    m_cmd->SetComputeRoot32BitConstants(0, count, constants, first_constant);
+    push_constants(m_stream, false, count, constants, first_constant);
 }
 
 void Command_List::set_constants_graphics(uint32_t count, void* constants, uint32_t first_constant)
 {
-    m_cmd->SetGraphicsRoot32BitConstants(0, count, constants, first_constant);
+    push_constants(m_stream, true, count, constants, first_constant);
 }
 
 void Command_List::set_index_buffer(Buffer_Handle handle, Index_Type index_type)
 {
-    auto& buffer = m_render_engine->get_buffer(handle);
-    D3D12_INDEX_BUFFER_VIEW ibv = { // TODO: look into performance issues that could arise here?
-        .BufferLocation = buffer.resource->GetGPUVirtualAddress(),
-        .SizeInBytes = uint32_t(buffer.resource->GetDesc().Width),
-        .Format = index_type == Index_Type::Uint16
-            ? DXGI_FORMAT_R16_UINT
-            : DXGI_FORMAT_R32_UINT
-    };
-    m_cmd->IASetIndexBuffer(&ibv);
+    // State packets are compared bytewise when sorted, assigning the fields keeps the padding zeroed.
+    auto& packet = m_stream->push<Command_Set_Index_Buffer>(Command_Type::Set_Index_Buffer);
+    packet.buffer = to_packet_handle(handle);
+    packet.uint16_indices = index_type == Index_Type::Uint16;
 }
 
 void Command_List::set_pipeline_state(Pipeline_Handle handle)
 {
-    auto& pipeline = m_render_engine->get_pipeline(handle);
-    m_cmd->SetPipelineState(pipeline.pso);
+    m_stream->push<Command_Set_Pipeline_State>(Command_Type::Set_Pipeline_State).pipeline = to_packet_handle(handle);
 }
 
 void Command_List::set_primitive_topology(D3D_PRIMITIVE_TOPOLOGY topology)
 {
-    m_cmd->IASetPrimitiveTopology(topology);
+    m_stream->push<Command_Set_Primitive_Topology>(Command_Type::Set_Primitive_Topology).topology = uint32_t(topology);
 }
 
 void Command_List::set_render_targets(std::span<Texture_Handle> textures, Texture_Handle depth_stencil)
 {
-    if (!depth_stencil.is_null_handle())
-    {
-        uint32_t render_target_count = 0;
-        std::array<D3D12_CPU_DESCRIPTOR_HANDLE, 8> render_targets;
-        for (auto texture : textures)
-        {
-            render_targets[render_target_count] = m_render_engine->get_cpu_descriptor_from_texture(texture);
-            render_target_count += 1;
-        }
-        D3D12_CPU_DESCRIPTOR_HANDLE ds_cpu_handle = m_render_engine->get_cpu_descriptor_from_texture(depth_stencil);
-        m_cmd->OMSetRenderTargets(render_target_count, render_targets.data(), false, &ds_cpu_handle);
-    }
-    else
-    {
-        uint32_t render_target_count = 0;
-        std::array<D3D12_CPU_DESCRIPTOR_HANDLE, 8> render_targets;
-        for (auto texture : textures)
-        {
-            render_targets[render_target_count] = m_render_engine->get_cpu_descriptor_from_texture(texture);
-            render_target_count += 1;
-        }
-        m_cmd->OMSetRenderTargets(render_target_count, render_targets.data(), false, nullptr);
-    }
+    assert(textures.size() <= COMMAND_STREAM_MAX_RENDER_TARGETS);
+    auto& packet = m_stream->push<Command_Set_Render_Targets>(Command_Type::Set_Render_Targets);
+    std::ranges::transform(textures, packet.render_targets, to_packet_handle<Texture_Handle>);
+    packet.render_target_count = uint32_t(textures.size());
+    packet.depth_stencil = to_packet_handle(depth_stencil);
+    packet.has_depth_stencil = !depth_stencil.is_null_handle();
 }
 
 void Command_List::set_render_target_swapchain(D3D12_Swapchain* swapchain, Texture_Handle depth_stencil)
 {
-    if (!depth_stencil.is_null_handle())
-    {
-        auto swapchain_cpu_handle = swapchain->get_acquired_resources().rtv_descriptor;
-        D3D12_CPU_DESCRIPTOR_HANDLE ds_cpu_handle = m_render_engine->get_cpu_descriptor_from_texture(depth_stencil);
-        m_cmd->OMSetRenderTargets(1, &swapchain_cpu_handle, 0, &ds_cpu_handle);
-    }
-    else
-    {
-        auto swapchain_cpu_handle = swapchain->get_acquired_resources().rtv_descriptor;
-        m_cmd->OMSetRenderTargets(1, &swapchain_cpu_handle, 0, nullptr);
-    }
+    auto& packet = m_stream->push<Command_Set_Render_Targets>(Command_Type::Set_Render_Targets);
+    packet.swapchain = reinterpret_cast<uint64_t>(swapchain);
+    packet.render_target_count = 1;
+    packet.depth_stencil = to_packet_handle(depth_stencil);
+    packet.has_depth_stencil = !depth_stencil.is_null_handle();
 }
 
 void Command_List::set_scissor(const D3D12_RECT& scissor)
 {
-    m_cmd->RSSetScissorRects(1, &scissor);
+    auto& packet = m_stream->push<Command_Set_Scissor>(Command_Type::Set_Scissor);
+    packet.left = int32_t(scissor.left);
+    packet.top = int32_t(scissor.top);
+    packet.right = int32_t(scissor.right);
+    packet.bottom = int32_t(scissor.bottom);
 }
 
 void Command_List::set_viewport(const D3D12_VIEWPORT& viewport)
 {
-    m_cmd->RSSetViewports(1, &viewport);
+    auto& packet = m_stream->push<Command_Set_Viewport>(Command_Type::Set_Viewport);
+    packet.x = viewport.TopLeftX;
+    packet.y = viewport.TopLeftY;
+    packet.width = viewport.Width;
+    packet.height = viewport.Height;
+    packet.min_depth = viewport.MinDepth;
+    packet.max_depth = viewport.MaxDepth;
 }
 
-void Command_List::begin_event([[maybe_unused]] const char* message)
+void Command_List::begin_event(const char* message)
 {
-#if OWGE_USE_WIN_PIX_EVENT_RUNTIME
-    PIXBeginEvent(m_cmd, PIX_COLOR_INDEX(m_event_index), message);
-#endif // OWGE_USE_WIN_PIX_EVENT_RUNTIME
+    push_event(m_stream, Command_Type::Begin_Event, message);
 }
 
 void Command_List::end_event()
 {
-#if OWGE_USE_WIN_PIX_EVENT_RUNTIME
-    PIXEndEvent(m_cmd);
-    m_event_index += 1;
-#endif // OWGE_USE_WIN_PIX_EVENT_RUNTIME
+    m_stream->push(Command_Type::End_Event);
+}
+
+void Command_List::set_marker(const char* message)
+{
+    push_event(m_stream, Command_Type::Set_Marker, message);
 }
 
-void Command_List::set_marker([[maybe_unused]] const char* message)
+void Command_List::translate()
 {
+#ifndef NDEBUG
+    auto valid = m_stream->validate(m_open_event_count);
+    assert(valid);
+#endif // NDEBUG
+    m_stream->for_each([this](const Command_Header& header) {
+        switch (header.type)
+        {
+        case Command_Type::Set_Pipeline_State:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Set_Pipeline_State>(header);
+            m_cmd->SetPipelineState(m_render_engine->get_pipeline(from_packet_handle<Pipeline_Handle>(packet.pipeline)).pso);
+            break;
+        }
+        case Command_Type::Set_Constants:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Set_Constants>(header);
+            auto constants = Command_Stream::get_trailing_data<Command_Set_Constants>(header);
+            if (packet.graphics)
+            {
+                m_cmd->SetGraphicsRoot32BitConstants(0, packet.count, constants, packet.first_constant);
+            }
+            else
+            {
+                m_cmd->SetComputeRoot32BitConstants(0, packet.count, constants, packet.first_constant);
+            }
+            break;
+        }
+        case Command_Type::Set_Index_Buffer:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Set_Index_Buffer>(header);
+            auto& buffer = m_render_engine->get_buffer(from_packet_handle<Buffer_Handle>(packet.buffer));
+            D3D12_INDEX_BUFFER_VIEW ibv = {
+                .BufferLocation = buffer.resource->GetGPUVirtualAddress() + buffer.offset,
+                .SizeInBytes = uint32_t(buffer.size),
+                .Format = packet.uint16_indices
+                    ? DXGI_FORMAT_R16_UINT
+                    : DXGI_FORMAT_R32_UINT
+            };
+            m_cmd->IASetIndexBuffer(&ibv);
+            break;
+        }
+        case Command_Type::Set_Primitive_Topology:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Set_Primitive_Topology>(header);
+            m_cmd->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY(packet.topology));
+            break;
+        }
+        case Command_Type::Set_Render_Targets:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Set_Render_Targets>(header);
+            std::array<D3D12_CPU_DESCRIPTOR_HANDLE, COMMAND_STREAM_MAX_RENDER_TARGETS> render_targets;
+            if (packet.swapchain != 0)
+            {
+                render_targets[0] = reinterpret_cast<D3D12_Swapchain*>(packet.swapchain)->get_acquired_resources().rtv_descriptor;
+            }
+            else
+            {
+                for (uint32_t i = 0; i < packet.render_target_count; ++i)
+                {
+                    render_targets[i] = m_render_engine->get_cpu_descriptor_from_texture(
+                        from_packet_handle<Texture_Handle>(packet.render_targets[i]));
+                }
+            }
+            D3D12_CPU_DESCRIPTOR_HANDLE ds_cpu_handle = {};
+            if (packet.has_depth_stencil)
+            {
+                ds_cpu_handle = m_render_engine->get_cpu_descriptor_from_texture(
+                    from_packet_handle<Texture_Handle>(packet.depth_stencil));
+            }
+            m_cmd->OMSetRenderTargets(packet.render_target_count, render_targets.data(), false,
+                packet.has_depth_stencil ? &ds_cpu_handle : nullptr);
+            break;
+        }
+        case Command_Type::Set_Viewport:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Set_Viewport>(header);
+            D3D12_VIEWPORT viewport = {
+                .TopLeftX = packet.x,
+                .TopLeftY = packet.y,
+                .Width = packet.width,
+                .Height = packet.height,
+                .MinDepth = packet.min_depth,
+                .MaxDepth = packet.max_depth
+            };
+            m_cmd->RSSetViewports(1, &viewport);
+            break;
+        }
+        case Command_Type::Set_Scissor:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Set_Scissor>(header);
+            D3D12_RECT scissor = {
+                .left = packet.left,
+                .top = packet.top,
+                .right = packet.right,
+                .bottom = packet.bottom
+            };
+            m_cmd->RSSetScissorRects(1, &scissor);
+            break;
+        }
+        case Command_Type::Dispatch:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Dispatch>(header);
+            m_cmd->Dispatch(packet.x, packet.y, packet.z);
+            break;
+        }
+        case Command_Type::Dispatch_Mesh:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Dispatch>(header);
+            m_cmd->DispatchMesh(packet.x, packet.y, packet.z);
+            break;
+        }
+        case Command_Type::Draw:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Draw>(header);
+            m_cmd->DrawInstanced(packet.vertex_count, packet.instance_count, packet.vertex_offset, packet.instance_offset);
+            break;
+        }
+        case Command_Type::Draw_Indexed:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Draw_Indexed>(header);
+            m_cmd->DrawIndexedInstanced(packet.index_count, packet.instance_count, packet.index_offset,
+                packet.base_vertex, packet.instance_offset);
+            break;
+        }
+        case Command_Type::Clear_Render_Target:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Clear_Render_Target>(header);
+            auto rtv = packet.swapchain != 0
+                ? reinterpret_cast<D3D12_Swapchain*>(packet.swapchain)->get_acquired_resources().rtv_descriptor
+                : m_render_engine->get_cpu_descriptor_from_texture(from_packet_handle<Texture_Handle>(packet.texture));
+            m_cmd->ClearRenderTargetView(rtv, packet.color, 0, nullptr);
+            break;
+        }
+        case Command_Type::Clear_Depth_Stencil:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Clear_Depth_Stencil>(header);
+            m_cmd->ClearDepthStencilView(
+                m_render_engine->get_cpu_descriptor_from_texture(from_packet_handle<Texture_Handle>(packet.texture)),
+                D3D12_CLEAR_FLAGS(packet.flags), packet.depth, packet.stencil, 0, nullptr);
+            break;
+        }
+        case Command_Type::Barrier:
+        {
+            auto& packet = Command_Stream::get_payload<Command_Barrier>(header);
+            auto data = Command_Stream::get_trailing_data<Command_Barrier>(header);
+            auto texture_barriers = reinterpret_cast<const D3D12_TEXTURE_BARRIER*>(data);
+            auto buffer_barriers = reinterpret_cast<const D3D12_BUFFER_BARRIER*>(texture_barriers + packet.texture_barrier_count);
+            auto global_barriers = reinterpret_cast<const D3D12_GLOBAL_BARRIER*>(buffer_barriers + packet.buffer_barrier_count);
+            uint32_t barrier_group_count = 0;
+            std::array<D3D12_BARRIER_GROUP, 3> barrier_groups = {};
+            if (packet.texture_barrier_count > 0)
+            {
+                auto& barrier_group = barrier_groups[barrier_group_count];
+                barrier_group.Type = D3D12_BARRIER_TYPE_TEXTURE;
+                barrier_group.NumBarriers = packet.texture_barrier_count;
+                barrier_group.pTextureBarriers = texture_barriers;
+                barrier_group_count += 1;
+            }
+            if (packet.buffer_barrier_count > 0)
+            {
+                auto& barrier_group = barrier_groups[barrier_group_count];
+                barrier_group.Type = D3D12_BARRIER_TYPE_BUFFER;
+                barrier_group.NumBarriers = packet.buffer_barrier_count;
+                barrier_group.pBufferBarriers = buffer_barriers;
+                barrier_group_count += 1;
+            }
+            if (packet.global_barrier_count > 0)
+            {
+                auto& barrier_group = barrier_groups[barrier_group_count];
+                barrier_group.Type = D3D12_BARRIER_TYPE_GLOBAL;
+                barrier_group.NumBarriers = packet.global_barrier_count;
+                barrier_group.pGlobalBarriers = global_barriers;
+                barrier_group_count += 1;
+            }
+            m_cmd->Barrier(barrier_group_count, barrier_groups.data());
+            break;
+        }
+        case Command_Type::Begin_Event:
+#if OWGE_USE_WIN_PIX_EVENT_RUNTIME
+            PIXBeginEvent(m_cmd, PIX_COLOR_INDEX(m_event_index),
+                reinterpret_cast<const char*>(Command_Stream::get_trailing_data<Command_Event>(header)));
+#endif // OWGE_USE_WIN_PIX_EVENT_RUNTIME
+            break;
+        case Command_Type::End_Event:
+#if OWGE_USE_WIN_PIX_EVENT_RUNTIME
+            PIXEndEvent(m_cmd);
+            m_event_index += 1;
+#endif // OWGE_USE_WIN_PIX_EVENT_RUNTIME
+            break;
+        case Command_Type::Set_Marker:
 #if OWGE_USE_WIN_PIX_EVENT_RUNTIME
-    PIXSetMarker(m_cmd, PIX_COLOR_INDEX(m_marker_index), message);
-    m_marker_index += 1;
+            PIXSetMarker(m_cmd, PIX_COLOR_INDEX(m_marker_index),
+                reinterpret_cast<const char*>(Command_Stream::get_trailing_data<Command_Event>(header)));
+            m_marker_index += 1;
 #endif // OWGE_USE_WIN_PIX_EVENT_RUNTIME
+            break;
+        default:
+            break;
+        }
+    });
+    m_stream->reset();
 }
 }
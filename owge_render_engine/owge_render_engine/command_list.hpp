@@ -1,6 +1,9 @@
 #pragma once
 
 #include "owge_render_engine/resource.hpp"
+#include "owge_render_engine/resource_state_tracker.hpp"
+
+#include <owge_common/command_stream.hpp>
 
 #include <cstdint>
 #include <include/d3d12.h>
@@ -50,34 +53,118 @@ struct Memory_Barrier
     D3D12_BARRIER_ACCESS access_after;
 };
 
+static constexpr D3D12_BARRIER_SUBRESOURCE_RANGE ALL_SUBRESOURCES = {
+    .IndexOrFirstMipLevel = 0xFFFFFFFF,
+    .NumMipLevels = 0,
+    .FirstArraySlice = 0,
+    .NumArraySlices = 0,
+    .FirstPlane = 0,
+    .NumPlanes = 0
+};
+
+// State a tracked texture is used in next, the state it is transitioned from is looked up.
+struct Texture_Usage
+{
+    Texture_Handle texture;
+    D3D12_BARRIER_SYNC sync;
+    D3D12_BARRIER_ACCESS access;
+    D3D12_BARRIER_LAYOUT layout;
+    D3D12_BARRIER_SUBRESOURCE_RANGE subresources = ALL_SUBRESOURCES;
+    // The previous contents are not needed, the transition starts from the UNDEFINED layout.
+    bool discard = false;
+};
+
+struct Buffer_Usage
+{
+    Buffer_Handle buffer;
+    D3D12_BARRIER_SYNC sync;
+    D3D12_BARRIER_ACCESS access;
+};
+
+// Barriers are batched until the command list records work that depends on them, so barriers
+// from consecutive procedures end up in the same Barrier packet.
 class Barrier_Builder
 {
 public:
-    Barrier_Builder(Render_Engine* render_engine, ID3D12GraphicsCommandList7* cmd);
+    // Tracks states in the render engine's tracker unless a local tracker is passed.
+    // `queue` is the type of the command list the stream is translated onto.
+    Barrier_Builder(Render_Engine* render_engine, Command_Stream* stream, D3D12_COMMAND_LIST_TYPE queue,
+        Resource_State_Tracker* tracker = nullptr);
 
+    Barrier_Builder(const Barrier_Builder&) = delete;
+    Barrier_Builder& operator=(const Barrier_Builder&) = delete;
+
+    // Explicit barriers, the tracked state of the resource is set to the state after the barrier.
     void push(const Texture_Barrier& barrier);
     void push(const Buffer_Barrier& barrier);
     void push(const Memory_Barrier& barrier);
+    // Tracked barriers. Reads in the layout the resource is already in don't need one, so they are dropped.
+    void use(const Texture_Usage& usage);
+    void use(const Buffer_Usage& usage);
+    // Begins a split barrier after the last access of the producer. The next `use()` of the texture ends it,
+    // so the transition can overlap with the work recorded in between.
+    void begin_use(const Texture_Usage& usage);
+    // Ends the split barriers still pending, they can't outlive the command list.
+    void end_split_barriers();
+    // Two or more barriers that only synchronize memory accesses are merged into a single global barrier.
     void flush();
+    // Records the barriers that move resources into the states required by a command list recorded with
+    // `local_tracker`, which runs right after this one. Then takes over the states it left them in
+    // and clears `local_tracker`.
+    void resolve(Resource_State_Tracker& local_tracker);
 
 private:
-    ID3D12GraphicsCommandList7* m_cmd;
+    struct Split_Barrier
+    {
+        Texture_Usage usage;
+        D3D12_TEXTURE_BARRIER begin;
+    };
+
+    void use_texture(const Texture_Usage& usage, bool split);
+    [[nodiscard]] bool end_split_barriers(const Texture_Usage& usage);
+    void push_texture_barrier(const Texture_Barrier& barrier);
+    void push_tracked_texture_barrier(const Texture_Usage& usage, const Texture_State& state,
+        const D3D12_BARRIER_SUBRESOURCE_RANGE& subresources, bool split);
+    [[nodiscard]] bool needs_barrier(const Texture_State& state, const Texture_Usage& usage) const;
+    void merge_memory_barriers();
+
+private:
+    Command_Stream* m_stream;
     Render_Engine* m_render_engine;
+    Resource_State_Tracker* m_tracker;
+    D3D12_COMMAND_LIST_TYPE m_queue;
     std::vector<D3D12_TEXTURE_BARRIER> m_texture_barriers;
     std::vector<D3D12_BUFFER_BARRIER> m_buffer_barriers;
     std::vector<D3D12_GLOBAL_BARRIER> m_global_barriers;
+    std::vector<Split_Barrier> m_split_barriers;
+    uint32_t m_requested_barrier_count = 0;
 };
 
+// Records commands into `stream`, which is translated onto `cmd` by `flush` or when the D3D12 command list
+// is accessed directly. The stream is reset after each translation.
 class Command_List
 {
 public:
-    Command_List(Render_Engine* render_engine, ID3D12GraphicsCommandList7* cmd);
+    Command_List(Render_Engine* render_engine, ID3D12GraphicsCommandList7* cmd, Command_Stream* stream,
+        Resource_State_Tracker* tracker = nullptr);
 
+    // Translates the commands and barriers recorded so far first, so commands recorded on the returned list
+    // are ordered after them.
     [[nodiscard]] ID3D12GraphicsCommandList7* d3d12_cmd()
     {
+        m_barrier_builder.flush();
+        translate();
         return m_cmd;
     }
-    [[nodiscard]] Barrier_Builder acquire_barrier_builder();
+    // The builder is shared by everything recorded on this list and flushed before the next work is recorded.
+    [[nodiscard]] Barrier_Builder& acquire_barrier_builder()
+    {
+        return m_barrier_builder;
+    }
+    // Ends pending split barriers and translates everything recorded so far, has to be called before closing the list.
+    void flush();
+    // See `Command_Stream::sort_by_pipeline`, applies to the commands recorded since the last translation.
+    void sort_by_pipeline();
 
     void clear_depth_stencil(Texture_Handle texture, D3D12_CLEAR_FLAGS flags, float depth, uint8_t stencil);
     void clear_render_target(D3D12_Swapchain* swapchain, float clear_color[4]);
@@ -108,10 +195,17 @@ public:
     void end_event();
     void set_marker(const char* message);
 
+private:
+    void translate();
+
 private:
     Render_Engine* m_render_engine;
     ID3D12GraphicsCommandList7* m_cmd;
+    Command_Stream* m_stream;
+    Barrier_Builder m_barrier_builder;
     uint8_t m_event_index = 0;
     uint8_t m_marker_index = 0;
+    // Only maintained by the validation of debug builds.
+    uint32_t m_open_event_count = 0;
 };
 }
@@ -0,0 +1,68 @@
+#include "owge_render_engine/deletion_ring.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace owge
+{
+Deletion_Ring::Deletion_Ring(uint32_t bucket_count)
+    : m_mutex()
+    , m_buckets(bucket_count)
+    , m_retiring()
+    , m_next_frame(0)
+{}
+
+void Deletion_Ring::retire(uint64_t frame)
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_next_frame = frame + 1;
+    }
+    retire_bucket(uint32_t(frame % m_buckets.size()));
+}
+
+void Deletion_Ring::retire_all()
+{
+    while (pending_count() > 0)
+    {
+        for (uint32_t i = 0; i < uint32_t(m_buckets.size()); ++i)
+        {
+            retire_bucket(i);
+        }
+    }
+}
+
+std::size_t Deletion_Ring::pending_count() const
+{
+    std::scoped_lock lock(m_mutex);
+    std::size_t count = 0;
+    for (const auto& bucket : m_buckets)
+    {
+        count += bucket.size();
+    }
+    return count;
+}
+
+void Deletion_Ring::push_record(uint64_t frame, const Record& record)
+{
+    std::scoped_lock lock(m_mutex);
+    // Records that are already due are retired with the next frame.
+    frame = std::max(frame, m_next_frame);
+    assert(frame - m_next_frame < m_buckets.size());
+    m_buckets[frame % m_buckets.size()].push_back(record);
+}
+
+void Deletion_Ring::retire_bucket(uint32_t bucket)
+{
+    // Retire callbacks may push new deletions, so they run outside of the lock.
+    {
+        std::scoped_lock lock(m_mutex);
+        std::swap(m_buckets[bucket], m_retiring);
+    }
+    for (const auto& record : m_retiring)
+    {
+        record.retire(record.context, record.payload);
+    }
+    m_retiring.clear();
+}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace owge
+{
+// Deferred deletions bucketed by the frame they become safe to retire in.
+// With `bucket_count` equal to the number of frames in flight plus one, every pending
+// record lives in exactly one bucket, so retiring a frame only touches the records due in it.
+class Deletion_Ring
+{
+public:
+    static constexpr std::size_t MAX_PAYLOAD_SIZE = 24;
+
+    Deletion_Ring(uint32_t bucket_count);
+
+    // Schedules `Fn(context, payload)` to run once `frame` is retired.
+    // `Fn` may be a free function or a member function pointer of `Context`.
+    template<auto Fn, typename Context, typename T>
+    void push(uint64_t frame, Context* context, const T& payload)
+    {
+        static_assert(sizeof(T) <= MAX_PAYLOAD_SIZE);
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        Record record = {
+            .retire = [](void* ctx, const std::byte* data) {
+                T value;
+                memcpy(&value, data, sizeof(T));
+                std::invoke(Fn, static_cast<Context*>(ctx), value);
+            },
+            .context = context,
+            .payload = {}
+        };
+        memcpy(record.payload, &payload, sizeof(T));
+        push_record(frame, record);
+    }
+
+    void retire(uint64_t frame);
+    void retire_all();
+
+    [[nodiscard]] std::size_t pending_count() const;
+
+private:
+    struct Record
+    {
+        void(*retire)(void* context, const std::byte* payload);
+        void* context;
+        alignas(8) std::byte payload[MAX_PAYLOAD_SIZE];
+    };
+
+    void push_record(uint64_t frame, const Record& record);
+    void retire_bucket(uint32_t bucket);
+
+    mutable std::mutex m_mutex;
+    std::vector<std::vector<Record>> m_buckets;
+    std::vector<Record> m_retiring;
+    uint64_t m_next_frame;
+};
+}
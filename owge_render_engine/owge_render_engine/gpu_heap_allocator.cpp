@@ -0,0 +1,242 @@
+#include "owge_render_engine/gpu_heap_allocator.hpp"
+
+#include "owge_d3d12_base/d3d12_util.hpp"
+
+#include <iterator>
+
+namespace owge
+{
+static constexpr uint64_t HEAP_BLOCK_SIZE = 67108864; // 64 MB
+static constexpr uint64_t MAX_PLACED_RESOURCE_SIZE = HEAP_BLOCK_SIZE / 4;
+static constexpr D3D12_HEAP_TYPE POOL_HEAP_TYPES[] = {
+    D3D12_HEAP_TYPE_DEFAULT,
+    D3D12_HEAP_TYPE_UPLOAD,
+    D3D12_HEAP_TYPE_READBACK
+};
+static constexpr uint32_t POOL_CATEGORY_COUNT = 2; // Buffers, non RT/DS textures.
+
+Gpu_Heap_Allocator::Gpu_Heap_Allocator(ID3D12Device10* device)
+    : m_device(device)
+    , m_resource_heap_tier(D3D12_RESOURCE_HEAP_TIER_1)
+    , m_mutex()
+    , m_pools()
+{
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    if (SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))))
+    {
+        m_resource_heap_tier = options.ResourceHeapTier;
+    }
+
+    m_pools.reserve(std::size(POOL_HEAP_TYPES) * POOL_CATEGORY_COUNT);
+    for (auto heap_type : POOL_HEAP_TYPES)
+    {
+        for (uint32_t category = 0; category < POOL_CATEGORY_COUNT; ++category)
+        {
+            auto heap_flags = D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES;
+            if (m_resource_heap_tier == D3D12_RESOURCE_HEAP_TIER_1)
+            {
+                heap_flags = category == 0
+                    ? D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS
+                    : D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+            }
+            m_pools.push_back({
+                .heap_type = heap_type,
+                .heap_flags = heap_flags,
+                .allocator = Block_Allocator(HEAP_BLOCK_SIZE),
+                .heaps = {}
+            });
+        }
+    }
+}
+
+Gpu_Heap_Allocator::~Gpu_Heap_Allocator()
+{
+    for (auto& pool : m_pools)
+    {
+        for (auto heap : pool.heaps)
+        {
+            if (heap)
+            {
+                heap->Release();
+            }
+        }
+    }
+}
+
+Gpu_Resource Gpu_Heap_Allocator::create_resource(
+    D3D12_HEAP_TYPE heap_type,
+    const D3D12_RESOURCE_DESC1& desc,
+    D3D12_BARRIER_LAYOUT initial_layout,
+    const D3D12_CLEAR_VALUE* clear_value)
+{
+    Gpu_Resource result = {
+        .resource = nullptr,
+        .allocation = {
+            .pool = GPU_HEAP_NO_POOL,
+            .block_allocation = {
+                .block = BLOCK_NO_ALLOCATION,
+                .node = TLSF_NO_ALLOCATION,
+                .offset = 0,
+                .size = 0
+            }
+        }
+    };
+
+    auto resource_desc = desc;
+    auto pool_index = get_pool_index(heap_type, resource_desc);
+    if (pool_index != GPU_HEAP_NO_POOL)
+    {
+        // Small textures may use 4 KB placement alignment if the driver agrees to it.
+        D3D12_RESOURCE_ALLOCATION_INFO allocation_info = {};
+        if (resource_desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER)
+        {
+            resource_desc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+            allocation_info = m_device->GetResourceAllocationInfo2(0, 1, &resource_desc, nullptr);
+            if (allocation_info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+            {
+                resource_desc.Alignment = 0;
+            }
+        }
+        if (resource_desc.Alignment == 0)
+        {
+            allocation_info = m_device->GetResourceAllocationInfo2(0, 1, &resource_desc, nullptr);
+        }
+
+        if (allocation_info.SizeInBytes <= MAX_PLACED_RESOURCE_SIZE &&
+            allocation_info.Alignment <= D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT)
+        {
+            std::scoped_lock lock(m_mutex);
+            auto& pool = m_pools[pool_index];
+            auto block_allocation = allocate(pool, allocation_info.SizeInBytes, allocation_info.Alignment);
+            auto hr = m_device->CreatePlacedResource2(
+                pool.heaps[block_allocation.block], block_allocation.offset,
+                &resource_desc, initial_layout, clear_value,
+                0, nullptr, IID_PPV_ARGS(&result.resource));
+            if (SUCCEEDED(hr))
+            {
+                result.allocation = {
+                    .pool = pool_index,
+                    .block_allocation = block_allocation
+                };
+                return result;
+            }
+            // Fall back to a committed resource if placement fails for any reason.
+            if (pool.allocator.free(block_allocation))
+            {
+                pool.heaps[block_allocation.block]->Release();
+                pool.heaps[block_allocation.block] = nullptr;
+                pool.allocator.remove_block(block_allocation.block);
+            }
+        }
+    }
+
+    D3D12_HEAP_PROPERTIES heap_properties = {
+        .Type = heap_type,
+        .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+        .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
+        .CreationNodeMask = 0,
+        .VisibleNodeMask = 0
+    };
+    throw_if_failed(m_device->CreateCommittedResource3(
+        &heap_properties, D3D12_HEAP_FLAG_NONE,
+        &desc, initial_layout, clear_value,
+        nullptr, 0, nullptr, IID_PPV_ARGS(&result.resource)),
+        "Failed to create committed resource.");
+    return result;
+}
+
+void Gpu_Heap_Allocator::free(const Gpu_Heap_Allocation& allocation)
+{
+    if (!allocation.is_placed())
+    {
+        return;
+    }
+
+    std::scoped_lock lock(m_mutex);
+    auto& pool = m_pools[allocation.pool];
+    if (pool.allocator.free(allocation.block_allocation))
+    {
+        pool.heaps[allocation.block_allocation.block]->Release();
+        pool.heaps[allocation.block_allocation.block] = nullptr;
+        pool.allocator.remove_block(allocation.block_allocation.block);
+    }
+}
+
+Gpu_Heap_Stats Gpu_Heap_Allocator::get_stats() const
+{
+    Gpu_Heap_Stats stats = {
+        .heap_size = 0,
+        .used_size = 0,
+        .heap_count = 0,
+        .placed_resource_count = 0
+    };
+    std::scoped_lock lock(m_mutex);
+    for (const auto& pool : m_pools)
+    {
+        auto pool_stats = pool.allocator.get_stats();
+        stats.heap_size += pool_stats.block_size * pool_stats.block_count;
+        stats.used_size += pool_stats.used_size;
+        stats.heap_count += pool_stats.block_count;
+        stats.placed_resource_count += pool_stats.allocation_count;
+    }
+    return stats;
+}
+
+uint32_t Gpu_Heap_Allocator::get_pool_index(D3D12_HEAP_TYPE heap_type, const D3D12_RESOURCE_DESC1& desc) const
+{
+    // Placed render targets and depth stencils would have to be initialized with a clear,
+    // copy or discard before first use, which committed resources don't require.
+    if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+    {
+        return GPU_HEAP_NO_POOL;
+    }
+    bool is_buffer = desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER;
+    if (!is_buffer && heap_type != D3D12_HEAP_TYPE_DEFAULT)
+    {
+        return GPU_HEAP_NO_POOL;
+    }
+    for (uint32_t i = 0; i < uint32_t(std::size(POOL_HEAP_TYPES)); ++i)
+    {
+        if (POOL_HEAP_TYPES[i] == heap_type)
+        {
+            auto category = (is_buffer || m_resource_heap_tier != D3D12_RESOURCE_HEAP_TIER_1) ? 0u : 1u;
+            return i * POOL_CATEGORY_COUNT + category;
+        }
+    }
+    return GPU_HEAP_NO_POOL;
+}
+
+Block_Allocation Gpu_Heap_Allocator::allocate(Pool& pool, uint64_t size, uint64_t alignment)
+{
+    auto allocation = pool.allocator.allocate(size, alignment);
+    if (allocation.is_valid())
+    {
+        return allocation;
+    }
+
+    auto block = pool.allocator.add_block();
+    if (block >= pool.heaps.size())
+    {
+        pool.heaps.resize(block + 1, nullptr);
+    }
+    D3D12_HEAP_DESC heap_desc = {
+        .SizeInBytes = pool.allocator.block_size(),
+        .Properties = {
+            .Type = pool.heap_type,
+            .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+            .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
+            .CreationNodeMask = 0,
+            .VisibleNodeMask = 0
+        },
+        .Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
+        .Flags = pool.heap_flags
+    };
+    auto hr = m_device->CreateHeap(&heap_desc, IID_PPV_ARGS(&pool.heaps[block]));
+    if (FAILED(hr))
+    {
+        pool.allocator.remove_block(block);
+        throw_if_failed(hr, "Failed to create GPU heap.");
+    }
+    return pool.allocator.allocate(size, alignment);
+}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "owge_common/block_allocator.hpp"
+
+#include <include/d3d12.h>
+#include <mutex>
+#include <vector>
+
+namespace owge
+{
+static constexpr uint32_t GPU_HEAP_NO_POOL = ~0u;
+
+struct Gpu_Heap_Allocation
+{
+    uint32_t pool;
+    Block_Allocation block_allocation;
+
+    [[nodiscard]] bool is_placed() const
+    {
+        return pool != GPU_HEAP_NO_POOL;
+    }
+};
+
+struct Gpu_Resource
+{
+    ID3D12Resource2* resource;
+    Gpu_Heap_Allocation allocation;
+};
+
+struct Gpu_Heap_Stats
+{
+    uint64_t heap_size;
+    uint64_t used_size;
+    uint32_t heap_count;
+    uint32_t placed_resource_count;
+};
+
+// Places resources into large ID3D12Heap blocks instead of giving each its own implicit heap.
+// There is one pool per heap type, on resource heap tier 1 additionally split into buffers and textures.
+// Render target and depth stencil textures as well as resources too large for a block stay committed.
+class Gpu_Heap_Allocator
+{
+public:
+    Gpu_Heap_Allocator(ID3D12Device10* device);
+    ~Gpu_Heap_Allocator();
+
+    Gpu_Heap_Allocator(const Gpu_Heap_Allocator&) = delete;
+    Gpu_Heap_Allocator& operator=(const Gpu_Heap_Allocator&) = delete;
+
+    [[nodiscard]] Gpu_Resource create_resource(
+        D3D12_HEAP_TYPE heap_type,
+        const D3D12_RESOURCE_DESC1& desc,
+        D3D12_BARRIER_LAYOUT initial_layout,
+        const D3D12_CLEAR_VALUE* clear_value);
+    // Only returns the memory, the resource itself has to be released by the caller.
+    void free(const Gpu_Heap_Allocation& allocation);
+
+    [[nodiscard]] Gpu_Heap_Stats get_stats() const;
+
+private:
+    struct Pool
+    {
+        D3D12_HEAP_TYPE heap_type;
+        D3D12_HEAP_FLAGS heap_flags;
+        Block_Allocator allocator;
+        std::vector<ID3D12Heap*> heaps;
+    };
+
+    [[nodiscard]] uint32_t get_pool_index(D3D12_HEAP_TYPE heap_type, const D3D12_RESOURCE_DESC1& desc) const;
+    [[nodiscard]] Block_Allocation allocate(Pool& pool, uint64_t size, uint64_t alignment);
+
+    ID3D12Device10* m_device;
+    D3D12_RESOURCE_HEAP_TIER m_resource_heap_tier;
+    mutable std::mutex m_mutex;
+    std::vector<Pool> m_pools;
+};
+}
@@ -0,0 +1,118 @@
+#include "owge_render_engine/readback_allocator.hpp"
+
+#include "owge_d3d12_base/d3d12_util.hpp"
+
+#include <algorithm>
+
+namespace owge
+{
+static constexpr uint64_t READBACK_RING_SIZE = 16777216; // 16 MB
+static constexpr uint64_t MIN_ALIGNMENT = 4;
+
+Readback_Allocator::Readback_Allocator(ID3D12Device10* device)
+    : m_device(device)
+    , m_ring(READBACK_RING_SIZE)
+    , m_resource(nullptr)
+    , m_mapped_data(nullptr)
+    , m_dedicated_buffers()
+    , m_unsubmitted_dedicated_count(0)
+    , m_retired_frame_count(0)
+{
+    m_resource = create_readback_buffer(READBACK_RING_SIZE, L"Buffer:Readback:Ring", &m_mapped_data);
+}
+
+Readback_Allocator::~Readback_Allocator()
+{
+    for (const auto& dedicated_buffer : m_dedicated_buffers)
+    {
+        dedicated_buffer.resource->Release();
+    }
+    m_resource->Release();
+}
+
+Readback_Allocation Readback_Allocator::allocate(uint64_t size, uint64_t alignment)
+{
+    auto offset = m_ring.allocate(size, std::max(alignment, MIN_ALIGNMENT));
+    if (offset != FENCE_RING_NO_ALLOCATION)
+    {
+        return {
+            .resource = m_resource,
+            .offset = offset,
+            .data = m_mapped_data
+        };
+    }
+
+    // Unlike the staging ring, the readback ring can't be swapped out while results are still
+    // pending in it, so anything that doesn't fit is served by a dedicated buffer.
+    void* mapped_data = nullptr;
+    auto resource = create_readback_buffer(size, L"Buffer:Readback:Large_Readback_Buffer", &mapped_data);
+    m_dedicated_buffers.push_back({
+        .resource = resource,
+        .expiry_frame = ~0ull
+    });
+    m_unsubmitted_dedicated_count += 1;
+    return {
+        .resource = resource,
+        .offset = 0,
+        .data = mapped_data
+    };
+}
+
+void Readback_Allocator::submit(uint64_t expiry_frame)
+{
+    m_ring.submit(expiry_frame);
+    for (auto i = m_dedicated_buffers.size() - m_unsubmitted_dedicated_count; i < m_dedicated_buffers.size(); ++i)
+    {
+        m_dedicated_buffers[i].expiry_frame = expiry_frame;
+    }
+    m_unsubmitted_dedicated_count = 0;
+}
+
+void Readback_Allocator::reclaim(uint64_t retired_frame)
+{
+    m_ring.reclaim(retired_frame);
+    std::erase_if(m_dedicated_buffers, [retired_frame](const Dedicated_Buffer& dedicated_buffer) {
+        if (dedicated_buffer.expiry_frame > retired_frame)
+        {
+            return false;
+        }
+        dedicated_buffer.resource->Release();
+        return true;
+    });
+    m_retired_frame_count = retired_frame + 1;
+}
+
+ID3D12Resource* Readback_Allocator::create_readback_buffer(uint64_t size, const wchar_t* name, void** mapped_data)
+{
+    D3D12_HEAP_PROPERTIES heap_properties = {
+        .Type = D3D12_HEAP_TYPE_READBACK,
+        .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+        .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
+        .CreationNodeMask = 0,
+        .VisibleNodeMask = 0
+    };
+    D3D12_RESOURCE_DESC1 resource_desc = {
+        .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+        .Alignment = 0,
+        .Width = size,
+        .Height = 1,
+        .DepthOrArraySize = 1,
+        .MipLevels = 1,
+        .Format = DXGI_FORMAT_UNKNOWN,
+        .SampleDesc = { .Count = 1, .Quality = 0 },
+        .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
+        .Flags = D3D12_RESOURCE_FLAG_NONE,
+        .SamplerFeedbackMipRegion = {}
+    };
+    ID3D12Resource* resource = nullptr;
+    throw_if_failed(m_device->CreateCommittedResource3(
+        &heap_properties, D3D12_HEAP_FLAG_NONE,
+        &resource_desc, D3D12_BARRIER_LAYOUT_UNDEFINED,
+        nullptr, nullptr, 0, nullptr, IID_PPV_ARGS(&resource)),
+        "Failed to create readback buffer.");
+    resource->SetName(name);
+    // Readback heaps stay mapped for their whole lifetime, results are read in place.
+    resource->Map(0, nullptr, mapped_data);
+    return resource;
+}
+}
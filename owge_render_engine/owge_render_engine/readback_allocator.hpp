@@ -0,0 +1,59 @@
+#pragma once
+
+#include <owge_common/fence_ring_allocator.hpp>
+
+#include <include/d3d12.h>
+#include <vector>
+
+namespace owge
+{
+struct Readback_Allocation
+{
+    ID3D12Resource* resource;
+    uint64_t offset;
+    const void* data;
+};
+
+// Persistently mapped readback ring. Memory is tagged with the frame after which it may be
+// overwritten and reclaimed once that frame has been retired. Requests that don't fit get a
+// dedicated buffer with the same lifetime.
+class Readback_Allocator
+{
+public:
+    Readback_Allocator(ID3D12Device10* device);
+    ~Readback_Allocator();
+
+    // Delete special member functions. An instance of this can't be copied nor moved.
+    Readback_Allocator(const Readback_Allocator&) = delete;
+    Readback_Allocator(Readback_Allocator&&) = delete;
+    Readback_Allocator& operator=(const Readback_Allocator&) = delete;
+    Readback_Allocator& operator=(Readback_Allocator&&) = delete;
+
+    [[nodiscard]] Readback_Allocation allocate(uint64_t size, uint64_t alignment = 0);
+    // Allocations made since the last submit stay valid until `expiry_frame` has been retired.
+    void submit(uint64_t expiry_frame);
+    void reclaim(uint64_t retired_frame);
+    [[nodiscard]] bool is_frame_retired(uint64_t frame) const
+    {
+        return frame < m_retired_frame_count;
+    }
+
+private:
+    struct Dedicated_Buffer
+    {
+        ID3D12Resource* resource;
+        uint64_t expiry_frame;
+    };
+
+    [[nodiscard]] ID3D12Resource* create_readback_buffer(uint64_t size, const wchar_t* name, void** mapped_data);
+
+private:
+    ID3D12Device10* m_device;
+    Fence_Ring_Allocator m_ring;
+    ID3D12Resource* m_resource;
+    void* m_mapped_data;
+    std::vector<Dedicated_Buffer> m_dedicated_buffers;
+    uint32_t m_unsubmitted_dedicated_count;
+    uint64_t m_retired_frame_count;
+};
+}
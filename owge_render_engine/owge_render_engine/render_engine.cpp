@@ -1,12 +1,14 @@
 #include "owge_render_engine/render_engine.hpp"
 
 #include <algorithm>
+#include <cassert>
+#include <functional>
 #include <utility>
 #include <fstream>
-#include <ranges>
 
 #include "owge_render_engine/command_list.hpp"
 
+#include <owge_common/buffer_copy_merger.hpp>
 #include <owge_common/file_util.hpp>
 
 #if OWGE_USE_NVPERF
@@ -35,22 +37,42 @@ Render_Engine::Render_Engine(HWND hwnd,
     m_swapchain = std::make_unique<D3D12_Swapchain>(
         m_ctx.factory, m_ctx.device, m_ctx.direct_queue,
         hwnd, MAX_SWAPCHAIN_BUFFERS);
+    m_worker_pool = std::make_unique<Worker_Pool>(render_engine_settings.recording_worker_count);
+    for (uint32_t worker = 0; worker < m_worker_pool->get_worker_count(); ++worker)
+    {
+        m_worker_command_streams.push_back(std::make_unique<Command_Stream>());
+    }
 
     for (auto i = 0; i < MAX_CONCURRENT_GPU_FRAMES; ++i)
     {
         auto& frame_ctx = m_frame_contexts[i];
         frame_ctx.direct_queue_cmd_alloc = std::make_unique<Command_Allocator>(
             m_ctx.device, D3D12_COMMAND_LIST_TYPE_DIRECT);
+        frame_ctx.copy_queue_cmd_alloc = std::make_unique<Command_Allocator>(
+            m_ctx.device, D3D12_COMMAND_LIST_TYPE_COPY);
+        frame_ctx.compute_queue_cmd_alloc = std::make_unique<Command_Allocator>(
+            m_ctx.device, D3D12_COMMAND_LIST_TYPE_COMPUTE);
+        for (uint32_t worker = 0; worker < m_worker_pool->get_worker_count(); ++worker)
+        {
+            frame_ctx.worker_direct_queue_cmd_allocs.push_back(std::make_unique<Command_Allocator>(
+                m_ctx.device, D3D12_COMMAND_LIST_TYPE_DIRECT));
+        }
         m_ctx.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&frame_ctx.direct_queue_fence));
         frame_ctx.frame_number = 0;
-        frame_ctx.staging_buffer_allocator = std::make_unique<Staging_Buffer_Allocator>(
-            m_ctx.device, this);
     }
+    m_ctx.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_copy_queue_fence));
+    m_ctx.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_upload_fence));
+    m_ctx.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_async_compute_fence));
 
-    m_resource_manager = std::make_unique<Resource_Manager>(&m_ctx);
+    m_resource_manager = std::make_unique<Resource_Manager>(&m_ctx, MAX_CONCURRENT_GPU_FRAMES + 1);
+    m_resource_state_tracker = std::make_unique<Resource_State_Tracker>();
+    m_staging_buffer_allocator = std::make_unique<Staging_Buffer_Allocator>(m_ctx.device, this);
+    m_readback_allocator = std::make_unique<Readback_Allocator>(m_ctx.device);
+    m_bindset_deletion_ring = std::make_unique<Deletion_Ring>(MAX_CONCURRENT_GPU_FRAMES + 1);
 
     m_bindset_allocator = std::make_unique<Bindset_Allocator>(this);
-    m_bindset_stager = std::make_unique<Bindset_Stager>();
+    m_bindset_stager = std::make_unique<Bindset_Stager>(render_engine_settings.bindset_page_upload_density);
+    m_dynamic_bindset_allocator = std::make_unique<Dynamic_Bindset_Allocator>(this);
 
     if (render_engine_settings.nvperf_enabled)
     {
@@ -102,11 +124,9 @@ Render_Engine::~Render_Engine()
     d3d12_context_wait_idle(&m_ctx);
 
     m_bindset_allocator->release_resources();
-    for (auto& frame_ctx : m_frame_contexts)
-    {
-        frame_ctx.staging_buffer_allocator->reset();
-    }
-    empty_deletion_queues(~0ull);
+    m_staging_buffer_allocator->release_resources();
+    m_dynamic_bindset_allocator->release_resources();
+    empty_all_deletion_queues();
 
 #if OWGE_USE_NVPERF
     if (m_nvperf_active &&
@@ -117,9 +137,13 @@ Render_Engine::~Render_Engine()
 #endif
 
     m_bindset_allocator = nullptr;
+    m_staging_buffer_allocator = nullptr;
+    m_readback_allocator = nullptr;
     m_frame_contexts = {};
     m_bindset_stager = nullptr;
+    m_dynamic_bindset_allocator = nullptr;
     m_swapchain = nullptr;
+    m_resource_manager = nullptr;
 
     destroy_d3d12_context(&m_ctx);
 }
@@ -129,6 +153,11 @@ void Render_Engine::add_procedure(Render_Procedure* proc)
     m_procedures.push_back(proc);
 }
 
+void Render_Engine::add_async_compute_procedure(Render_Procedure* proc)
+{
+    m_async_compute_procedures.push_back(proc);
+}
+
 void Render_Engine::render(float delta_time)
 {
     auto& frame_ctx = m_frame_contexts[m_current_frame_index];
@@ -139,8 +168,22 @@ void Render_Engine::render(float delta_time)
     }
 
     frame_ctx.direct_queue_cmd_alloc->reset();
-    frame_ctx.staging_buffer_allocator->reset();
+    frame_ctx.copy_queue_cmd_alloc->reset();
+    frame_ctx.compute_queue_cmd_alloc->reset();
+    for (auto& cmd_alloc : frame_ctx.worker_direct_queue_cmd_allocs)
+    {
+        cmd_alloc->reset();
+    }
+    m_completed_copy_queue_fence_value = m_copy_queue_fence->GetCompletedValue();
+    m_upload_stream_queue.retire(m_completed_copy_queue_fence_value);
+    if (m_current_frame >= MAX_CONCURRENT_GPU_FRAMES)
+    {
+        m_staging_buffer_allocator->reclaim(m_current_frame - MAX_CONCURRENT_GPU_FRAMES);
+        m_dynamic_bindset_allocator->reclaim(m_current_frame - MAX_CONCURRENT_GPU_FRAMES);
+        m_readback_allocator->reclaim(m_current_frame - MAX_CONCURRENT_GPU_FRAMES);
+    }
     empty_deletion_queues(m_current_frame);
+    m_descriptor_heap_occupancy = m_resource_manager->get_descriptor_heap_occupancy();
     auto procedure_cmd = frame_ctx.direct_queue_cmd_alloc->get_or_allocate().cmd;
     frame_ctx.upload_cmd = frame_ctx.direct_queue_cmd_alloc->get_or_allocate().cmd;
 
@@ -150,44 +193,70 @@ void Render_Engine::render(float delta_time)
     }
     m_swapchain->acquire_next_image();
 
-    auto procedure_cmd_list = Command_List(this, procedure_cmd);
-    auto procedure_cmd_global_barrier_builder = procedure_cmd_list.acquire_barrier_builder();
-
-    Render_Procedure_Payload proc_payload = {
-        .render_engine = this,
-        .cmd = &procedure_cmd_list,
-        .barrier_builder = &procedure_cmd_global_barrier_builder,
-        .swapchain = m_swapchain.get(),
-        .delta_time = delta_time
-    };
-    procedure_cmd->SetComputeRootSignature(m_ctx.global_rootsig);
-    procedure_cmd->SetGraphicsRootSignature(m_ctx.global_rootsig);
     auto descriptor_heaps = std::to_array({
         m_ctx.cbv_srv_uav_descriptor_heap, m_ctx.sampler_descriptor_heap
         });
-    procedure_cmd->SetDescriptorHeaps(uint32_t(descriptor_heaps.size()), descriptor_heaps.data());
-    // procedure_cmd->SetComputeRootDescriptorTable(1, m_ctx.sampler_descriptor_heap->GetGPUDescriptorHandleForHeapStart());
-    // procedure_cmd->SetGraphicsRootDescriptorTable(1, m_ctx.sampler_descriptor_heap->GetGPUDescriptorHandleForHeapStart());
 
-    for (auto procedure : m_procedures)
+    compile_render_graph();
+
+    ID3D12GraphicsCommandList7* async_compute_cmd = nullptr;
+    if (!m_async_compute_passes.empty())
     {
-        procedure_cmd_list.begin_event(procedure->get_name());
-        procedure->process(proc_payload);
-        procedure_cmd_list.end_event();
+        async_compute_cmd = frame_ctx.compute_queue_cmd_alloc->get_or_allocate().cmd;
+        auto async_compute_cmd_list = Command_List(this, async_compute_cmd, m_worker_command_streams[0].get());
+        Render_Procedure_Payload async_compute_payload = {
+            .render_engine = this,
+            .cmd = &async_compute_cmd_list,
+            .barrier_builder = &async_compute_cmd_list.acquire_barrier_builder(),
+            .swapchain = m_swapchain.get(),
+            .delta_time = delta_time
+        };
+        async_compute_cmd->SetComputeRootSignature(m_ctx.global_rootsig);
+        async_compute_cmd->SetDescriptorHeaps(uint32_t(descriptor_heaps.size()), descriptor_heaps.data());
+        for (auto procedure : m_async_compute_passes)
+        {
+            async_compute_cmd_list.begin_event(procedure->get_name());
+            procedure->process(async_compute_payload);
+            async_compute_cmd_list.end_event();
+        }
+        async_compute_cmd_list.flush();
+        async_compute_cmd->Close();
     }
 
-    m_bindset_stager->process(procedure_cmd);
-
-    for (const auto& staged_upload : m_staged_uploads)
+    // Top-level procedures are recorded in parallel, each into its own command list and with its own
+    // state tracker. The lists are submitted in procedure order after `procedure_cmd`, which only holds
+    // the barriers the first procedure requires.
+    auto procedure_count = uint32_t(m_direct_passes.size());
+    while (m_procedure_state_trackers.size() < procedure_count)
     {
-        frame_ctx.upload_cmd->CopyBufferRegion(
-            staged_upload.dst,
-            staged_upload.dst_offset,
-            staged_upload.src,
-            staged_upload.src_offset,
-            staged_upload.size);
+        m_procedure_state_trackers.push_back(
+            std::make_unique<Resource_State_Tracker>(m_resource_state_tracker.get()));
     }
-    m_staged_uploads.clear();
+    m_procedure_cmds.resize(procedure_count);
+    m_worker_pool->run(procedure_count, [&](uint32_t i, uint32_t worker) {
+        auto cmd = frame_ctx.worker_direct_queue_cmd_allocs[worker]->get_or_allocate().cmd;
+        auto cmd_list = Command_List(this, cmd, m_worker_command_streams[worker].get(),
+            m_procedure_state_trackers[i].get());
+        Render_Procedure_Payload payload = {
+            .render_engine = this,
+            .cmd = &cmd_list,
+            .barrier_builder = &cmd_list.acquire_barrier_builder(),
+            .swapchain = m_swapchain.get(),
+            .delta_time = delta_time
+        };
+        cmd->SetComputeRootSignature(m_ctx.global_rootsig);
+        cmd->SetGraphicsRootSignature(m_ctx.global_rootsig);
+        cmd->SetDescriptorHeaps(uint32_t(descriptor_heaps.size()), descriptor_heaps.data());
+        cmd_list.begin_event(m_direct_passes[i]->get_name());
+        m_direct_passes[i]->process(payload);
+        cmd_list.end_event();
+        cmd_list.flush();
+        m_procedure_cmds[i] = cmd;
+    });
+
+    // The upload list runs first, its barriers are tracked before the procedures' requirements are resolved.
+    m_bindset_stager->process(frame_ctx.upload_cmd, m_staging_buffer_allocator.get());
+    record_staged_uploads(frame_ctx.upload_cmd);
 
     D3D12_GLOBAL_BARRIER global_upload_barrier = {
         .SyncBefore = D3D12_BARRIER_SYNC_COPY,
@@ -197,16 +266,70 @@ void Render_Engine::render(float delta_time)
     };
     D3D12_BARRIER_GROUP global_upload_barrier_group = {
         .Type = D3D12_BARRIER_TYPE_GLOBAL,
+        .NumBarriers = 1,
         .pGlobalBarriers = &global_upload_barrier
     };
     frame_ctx.upload_cmd->Barrier(1, &global_upload_barrier_group);
 
+    // Each list is left open until the barriers the next one requires are appended to it.
+    auto last_procedure_cmd = procedure_cmd;
+    for (uint32_t i = 0; i < procedure_count; ++i)
+    {
+        auto cmd_list = Command_List(this, last_procedure_cmd, m_worker_command_streams[0].get());
+        cmd_list.acquire_barrier_builder().resolve(*m_procedure_state_trackers[i]);
+        cmd_list.flush();
+        last_procedure_cmd = m_procedure_cmds[i];
+    }
+
+    if (m_upload_stream_queue.has_pending_streams())
+    {
+        auto copy_cmd = frame_ctx.copy_queue_cmd_alloc->get_or_allocate().cmd;
+        m_upload_stream_queue.process(this, m_staging_buffer_allocator.get(), copy_cmd,
+            m_settings.streaming_upload_budget, m_copy_queue_fence_value + 1);
+        copy_cmd->Close();
+        auto copy_cmds = std::to_array({ static_cast<ID3D12CommandList*>(copy_cmd) });
+        m_ctx.copy_queue->ExecuteCommandLists(uint32_t(copy_cmds.size()), copy_cmds.data());
+        m_copy_queue_fence_value += 1;
+        m_ctx.copy_queue->Signal(m_copy_queue_fence.Get(), m_copy_queue_fence_value);
+    }
+
+    record_staged_readbacks(last_procedure_cmd);
+    // Every barrier builder of the frame has flushed by now.
+    m_barrier_stats = {
+        .requested_barrier_count = m_frame_requested_barrier_count.exchange(0),
+        .emitted_barrier_count = m_frame_emitted_barrier_count.exchange(0)
+    };
+
     frame_ctx.upload_cmd->Close();
     procedure_cmd->Close();
-    auto cmds = std::to_array({
-        static_cast<ID3D12CommandList*>(frame_ctx.upload_cmd),
-        static_cast<ID3D12CommandList*>(procedure_cmd) });
-    m_ctx.direct_queue->ExecuteCommandLists(uint32_t(cmds.size()), cmds.data());
+    m_submitted_procedure_cmds.clear();
+    m_submitted_procedure_cmds.push_back(procedure_cmd);
+    for (auto cmd : m_procedure_cmds)
+    {
+        cmd->Close();
+        m_submitted_procedure_cmds.push_back(cmd);
+    }
+    auto upload_cmds = std::to_array({ static_cast<ID3D12CommandList*>(frame_ctx.upload_cmd) });
+    // Streams reported as complete this frame may be used, make their copies visible to this queue.
+    m_ctx.direct_queue->Wait(m_copy_queue_fence.Get(), m_completed_copy_queue_fence_value);
+    m_ctx.direct_queue->ExecuteCommandLists(uint32_t(upload_cmds.size()), upload_cmds.data());
+
+    // Graphics consume the async compute results of the previous frame. This frame's async compute work
+    // only has to wait for the uploads, which also orders it after the graphics work of the previous frame
+    // that still reads the other half of double-buffered outputs.
+    auto consumed_async_compute_fence_value = m_async_compute_fence_value;
+    if (async_compute_cmd != nullptr)
+    {
+        auto async_compute_cmds = std::to_array({ static_cast<ID3D12CommandList*>(async_compute_cmd) });
+        m_ctx.direct_queue->Signal(m_upload_fence.Get(), m_current_frame + 1);
+        m_ctx.async_compute_queue->Wait(m_upload_fence.Get(), m_current_frame + 1);
+        m_ctx.async_compute_queue->ExecuteCommandLists(uint32_t(async_compute_cmds.size()), async_compute_cmds.data());
+        m_async_compute_fence_value = m_current_frame + 1;
+        m_ctx.async_compute_queue->Signal(m_async_compute_fence.Get(), m_async_compute_fence_value);
+    }
+    m_ctx.direct_queue->Wait(m_async_compute_fence.Get(), consumed_async_compute_fence_value);
+    m_ctx.direct_queue->ExecuteCommandLists(
+        uint32_t(m_submitted_procedure_cmds.size()), m_submitted_procedure_cmds.data());
 
     auto swapchain = m_swapchain->get_swapchain();
     DXGI_SWAP_CHAIN_DESC1 swapchain_desc = {};
@@ -216,57 +339,229 @@ void Render_Engine::render(float delta_time)
         : 0u;
     swapchain->Present(0, allow_tearing);
 
+    m_staging_buffer_allocator->submit(m_current_frame);
+    m_dynamic_bindset_allocator->submit(m_current_frame);
+    m_readback_allocator->submit(m_current_frame + MAX_CONCURRENT_GPU_FRAMES);
     m_current_frame += 1;
     m_current_frame_index = m_current_frame % MAX_CONCURRENT_GPU_FRAMES;
     frame_ctx.frame_number += 1;
 
+    // The frame fence also covers this frame's copy and async compute queue work, which keeps the staging
+    // memory and command allocators of a frame alive until all queues are done with them.
+    m_ctx.direct_queue->Wait(m_copy_queue_fence.Get(), m_copy_queue_fence_value);
+    m_ctx.direct_queue->Wait(m_async_compute_fence.Get(), m_async_compute_fence_value);
     m_ctx.direct_queue->Signal(frame_ctx.direct_queue_fence.Get(), frame_ctx.frame_number);
 }
 
 void* Render_Engine::upload_data(uint64_t size, uint64_t align, Buffer_Handle dst, uint64_t dst_offset)
 {
-    auto& frame_ctx = m_frame_contexts[m_current_frame_index];
-    auto allocation = frame_ctx.staging_buffer_allocator->allocate(size, align);
+    std::lock_guard lock(m_record_mutex);
+    auto allocation = m_staging_buffer_allocator->allocate(size, align);
     auto& buffer = get_buffer(dst);
     m_staged_uploads.push_back({
         .src = allocation.resource,
         .src_offset = allocation.offset,
         .dst = buffer.resource,
-        .dst_offset = dst_offset,
+        .dst_offset = buffer.offset + dst_offset,
         .size = size
         });
     return &static_cast<uint8_t*>(allocation.data)[allocation.offset];
 }
 
-void Render_Engine::copy_and_upload_data(uint64_t size, uint64_t align, Buffer_Handle dst, uint64_t dst_offset, void* data)
+void Render_Engine::copy_and_upload_data(uint64_t size, uint64_t align, Buffer_Handle dst, uint64_t dst_offset, const void* data)
 {
-    auto& frame_ctx = m_frame_contexts[m_current_frame_index];
-    auto allocation = frame_ctx.staging_buffer_allocator->allocate(size, align);
+    std::lock_guard lock(m_record_mutex);
+    auto allocation = m_staging_buffer_allocator->allocate(size, align);
     memcpy(&static_cast<char*>(allocation.data)[allocation.offset], data, size);
     auto& buffer = get_buffer(dst);
     m_staged_uploads.push_back({
         .src = allocation.resource,
         .src_offset = allocation.offset,
         .dst = buffer.resource,
-        .dst_offset = dst_offset,
+        .dst_offset = buffer.offset + dst_offset,
         .size = size
         });
 }
 
-void Render_Engine::update_bindings(const Bindset& bindset)
+Upload_Stream_Ticket Render_Engine::stream_data(Buffer_Handle dst, uint64_t dst_offset,
+    std::shared_ptr<const void> data, uint64_t size)
 {
-    auto& frame_ctx = m_frame_contexts[m_current_frame_index];
-    m_bindset_stager->stage_bindset(this, bindset, frame_ctx.staging_buffer_allocator.get());
+    std::lock_guard lock(m_record_mutex);
+    return m_upload_stream_queue.push(dst, dst_offset, std::move(data), size);
+}
+
+bool Render_Engine::is_upload_stream_complete(Upload_Stream_Ticket ticket) const
+{
+    std::lock_guard lock(m_record_mutex);
+    return m_upload_stream_queue.is_complete(ticket);
+}
+
+void* Render_Engine::upload_texture_data(Texture_Handle dst, uint32_t first_subresource,
+    std::span<Subresource_Footprint> footprints)
+{
+    auto resource = get_texture(dst).resource;
+    auto resource_desc = resource->GetDesc1();
+    auto is_volume = resource_desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+    Texture_Footprint_Desc footprint_desc = {
+        .width = uint32_t(resource_desc.Width),
+        .height = resource_desc.Height,
+        .depth = is_volume ? uint32_t(resource_desc.DepthOrArraySize) : 1u,
+        .array_layers = is_volume ? 1u : uint32_t(resource_desc.DepthOrArraySize),
+        .mip_levels = resource_desc.MipLevels,
+        .block = get_dxgi_format_block_info(resource_desc.Format)
+    };
+    assert(footprint_desc.block.size != 0);
+    assert(first_subresource + footprints.size() <= footprint_desc.array_layers * footprint_desc.mip_levels);
+
+    auto size = compute_subresource_footprints(footprint_desc, first_subresource, footprints);
+    std::lock_guard lock(m_record_mutex);
+    auto allocation = m_staging_buffer_allocator->allocate(size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    for (uint32_t i = 0; i < uint32_t(footprints.size()); ++i)
+    {
+        const auto& footprint = footprints[i];
+        m_staged_texture_uploads.push_back({
+            .texture = dst,
+            .src = allocation.resource,
+            .src_footprint = {
+                .Offset = allocation.offset + footprint.offset,
+                .Footprint = {
+                    .Format = resource_desc.Format,
+                    .Width = footprint.width,
+                    .Height = footprint.height,
+                    .Depth = footprint.depth,
+                    .RowPitch = footprint.row_pitch
+                }
+            },
+            .dst = resource,
+            .dst_subresource = first_subresource + i
+            });
+    }
+    return &static_cast<uint8_t*>(allocation.data)[allocation.offset];
+}
+
+void Render_Engine::copy_and_upload_texture_data(Texture_Handle dst, uint32_t first_subresource,
+    uint32_t subresource_count, const void* data)
+{
+    std::vector<Subresource_Footprint> footprints(subresource_count);
+    auto upload = static_cast<uint8_t*>(upload_texture_data(dst, first_subresource, footprints));
+    auto src = static_cast<const uint8_t*>(data);
+    for (const auto& footprint : footprints)
+    {
+        for (uint32_t row = 0; row < footprint.row_count * footprint.depth; ++row)
+        {
+            memcpy(&upload[footprint.offset + uint64_t(row) * footprint.row_pitch], src, footprint.row_size);
+            src += footprint.row_size;
+        }
+    }
+}
+
+Readback_Ticket Render_Engine::request_readback(Buffer_Handle src, uint64_t offset, uint64_t size)
+{
+    std::lock_guard lock(m_record_mutex);
+    auto allocation = m_readback_allocator->allocate(size);
+    auto& buffer = get_buffer(src);
+    m_staged_readbacks.push_back({
+        .buffer = src,
+        .src = buffer.resource,
+        .src_offset = buffer.offset + offset,
+        .dst = allocation.resource,
+        .dst_offset = allocation.offset,
+        .size = size
+        });
+    return {
+        .frame = m_current_frame,
+        .data = &static_cast<const std::byte*>(allocation.data)[allocation.offset],
+        .size = size,
+        .row_pitch = 0
+    };
+}
+
+Readback_Ticket Render_Engine::request_readback(Texture_Handle src, uint32_t subresource)
+{
+    auto resource = get_texture(src).resource;
+    auto resource_desc = resource->GetDesc1();
+    auto is_volume = resource_desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+    Texture_Footprint_Desc footprint_desc = {
+        .width = uint32_t(resource_desc.Width),
+        .height = resource_desc.Height,
+        .depth = is_volume ? uint32_t(resource_desc.DepthOrArraySize) : 1u,
+        .array_layers = is_volume ? 1u : uint32_t(resource_desc.DepthOrArraySize),
+        .mip_levels = resource_desc.MipLevels,
+        .block = get_dxgi_format_block_info(resource_desc.Format)
+    };
+    assert(footprint_desc.block.size != 0);
+
+    Subresource_Footprint footprint = {};
+    auto size = compute_subresource_footprints(footprint_desc, subresource, { &footprint, 1 });
+    std::lock_guard lock(m_record_mutex);
+    auto allocation = m_readback_allocator->allocate(size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    m_staged_texture_readbacks.push_back({
+        .texture = src,
+        .src = resource,
+        .src_subresource = subresource,
+        .dst = allocation.resource,
+        .dst_footprint = {
+            .Offset = allocation.offset + footprint.offset,
+            .Footprint = {
+                .Format = resource_desc.Format,
+                .Width = footprint.width,
+                .Height = footprint.height,
+                .Depth = footprint.depth,
+                .RowPitch = footprint.row_pitch
+            }
+        }
+        });
+    return {
+        .frame = m_current_frame,
+        .data = &static_cast<const std::byte*>(allocation.data)[allocation.offset + footprint.offset],
+        .size = size - footprint.offset,
+        .row_pitch = footprint.row_pitch
+    };
+}
+
+std::span<const std::byte> Render_Engine::get_readback_data(const Readback_Ticket& ticket) const
+{
+    if (!m_readback_allocator->is_frame_retired(ticket.frame))
+    {
+        return {};
+    }
+    return { ticket.data, ticket.size };
+}
+
+void Render_Engine::update_bindings(Bindset& bindset)
+{
+    std::lock_guard lock(m_record_mutex);
+    if (bindset.allocation.dynamic)
+    {
+        m_dynamic_bindset_allocator->write_bindset(bindset);
+        return;
+    }
+    m_bindset_stager->stage_bindset(this, bindset);
 }
 
 Buffer_Handle Render_Engine::create_buffer(const Buffer_Desc& desc, const wchar_t* name)
 {
-    return m_resource_manager->create_buffer(desc, name);
+    auto handle = m_resource_manager->create_buffer(desc, name);
+    m_resource_state_tracker->track_buffer(handle);
+    return handle;
 }
 
 Texture_Handle Render_Engine::create_texture(const Texture_Desc& desc, const wchar_t* name)
 {
-    return m_resource_manager->create_texture(desc, name);
+    auto handle = m_resource_manager->create_texture(desc, name);
+    m_resource_state_tracker->track_texture(handle, get_texture(handle).resource, desc.initial_layout);
+    return handle;
+}
+
+void Render_Engine::create_transient_textures(
+    std::span<const Transient_Texture_Desc> descs, std::span<Texture_Handle> textures)
+{
+    m_resource_manager->create_transient_textures(descs, textures);
+    for (uint32_t i = 0; i < uint32_t(descs.size()); ++i)
+    {
+        m_resource_state_tracker->track_texture(textures[i], get_texture(textures[i]).resource,
+            descs[i].texture.initial_layout);
+    }
 }
 
 Shader_Handle Render_Engine::create_shader(const Shader_Desc& desc)
@@ -289,13 +584,21 @@ Sampler_Handle Render_Engine::create_sampler(const Sampler_Desc& desc)
     return m_resource_manager->create_sampler(desc);
 }
 
-Bindset Render_Engine::create_bindset()
+Bindset Render_Engine::create_bindset(uint32_t value_count)
 {
-    return m_bindset_allocator->allocate_bindset();
+    std::lock_guard lock(m_record_mutex);
+    return m_bindset_allocator->allocate_bindset(value_count);
+}
+
+Bindset Render_Engine::create_dynamic_bindset(uint32_t value_count)
+{
+    std::lock_guard lock(m_record_mutex);
+    return m_bindset_allocator->allocate_dynamic_bindset(value_count);
 }
 
 void Render_Engine::destroy_buffer(Buffer_Handle handle)
 {
+    m_bindset_stager->remove_buffer(handle);
     m_resource_manager->destroy_buffer(handle, m_current_frame + MAX_CONCURRENT_GPU_FRAMES);
 }
 
@@ -321,7 +624,13 @@ void Render_Engine::destroy_sampler(Sampler_Handle handle)
 
 void Render_Engine::destroy_bindset(const Bindset& bindset)
 {
-    m_bindset_deletion_queue.push_back({ bindset, m_current_frame + MAX_CONCURRENT_GPU_FRAMES });
+    if (bindset.allocation.dynamic)
+    {
+        return;
+    }
+    std::lock_guard lock(m_record_mutex);
+    m_bindset_deletion_ring->push<&Render_Engine::retire_bindset>(
+        m_current_frame + MAX_CONCURRENT_GPU_FRAMES, this, bindset.allocation);
 }
 
 void Render_Engine::destroy_d3d12_resource_deferred(ID3D12Resource* resource)
@@ -359,6 +668,16 @@ Pipeline& Render_Engine::get_pipeline(Pipeline_Handle handle)
     return m_resource_manager->get_pipeline(handle);
 }
 
+const Pipeline_Desc& Render_Engine::get_pipeline_desc(Pipeline_Handle handle) const
+{
+    return m_resource_manager->get_pipeline_desc(handle);
+}
+
+const std::wstring& Render_Engine::get_buffer_name(Buffer_Handle handle) const
+{
+    return m_resource_manager->get_buffer_name(handle);
+}
+
 const Shader& Render_Engine::get_shader(Shader_Handle handle) const
 {
     return m_resource_manager->get_shader(handle);
@@ -388,18 +707,176 @@ D3D12_CPU_DESCRIPTOR_HANDLE Render_Engine::get_cpu_descriptor_from_texture(Textu
     return result;
 }
 
-void Render_Engine::empty_deletion_queues(uint64_t frame)
+void Render_Engine::compile_render_graph()
 {
-    m_resource_manager->empty_deletion_queues(frame);
-
-    auto bindset_range = std::ranges::remove_if(m_bindset_deletion_queue, [this, frame](auto& element) {
-        if (frame >= element.frame)
+    m_render_pass_builder.clear();
+    for (auto procedure : m_async_compute_procedures)
+    {
+        m_render_pass_builder.begin_pass(true);
+        procedure->declare(this, m_render_pass_builder);
+    }
+    for (auto procedure : m_procedures)
+    {
+        m_render_pass_builder.begin_pass(false);
+        procedure->declare(this, m_render_pass_builder);
+    }
+    m_render_graph.clear();
+    m_render_pass_builder.build(m_render_graph);
+    auto compiled = m_render_graph.compile();
+
+    // The queues only synchronize once per frame, so if any pass depends on work of the other queue
+    // within the frame, everything runs on the direct queue in the compiled order.
+    auto synchronized_in_frame = std::ranges::any_of(compiled.passes, [](const Render_Graph_Compiled_Pass& pass) {
+        return pass.wait_pass != RENDER_GRAPH_NO_PASS;
+    });
+    auto async_compute_count = uint32_t(m_async_compute_procedures.size());
+    m_direct_passes.clear();
+    m_async_compute_passes.clear();
+    for (const auto& compiled_pass : compiled.passes)
+    {
+        auto procedure = compiled_pass.pass < async_compute_count
+            ? m_async_compute_procedures[compiled_pass.pass]
+            : m_procedures[compiled_pass.pass - async_compute_count];
+        if (compiled_pass.queue == Render_Graph_Queue::Async_Compute && !synchronized_in_frame)
         {
-            m_bindset_allocator->delete_bindset(element.resource);
-            return true;
+            m_async_compute_passes.push_back(procedure);
         }
-        return false;
+        else
+        {
+            m_direct_passes.push_back(procedure);
+        }
+    }
+}
+
+void Render_Engine::record_staged_uploads(ID3D12GraphicsCommandList7* cmd)
+{
+    m_upload_stats = {
+        .requested_copy_count = uint32_t(m_staged_uploads.size()),
+        .issued_copy_count = 0,
+        .uploaded_size = 0,
+        .pending_stream_size = m_upload_stream_queue.get_pending_size()
+    };
+
+    m_upload_stats.issued_copy_count = merge_buffer_copies(m_staged_uploads, m_sorted_staged_uploads,
+        [&](const Staged_Upload& upload) {
+            cmd->CopyBufferRegion(upload.dst, upload.dst_offset, upload.src, upload.src_offset, upload.size);
+            m_upload_stats.uploaded_size += upload.size;
         });
-    m_bindset_deletion_queue.erase(bindset_range.begin(), bindset_range.end());
+
+    // The upload list runs before the procedures, which move the textures out of COPY_DEST again.
+    auto cmd_list = Command_List(this, cmd, m_worker_command_streams[0].get());
+    auto& barrier_builder = cmd_list.acquire_barrier_builder();
+    for (const auto& texture_upload : m_staged_texture_uploads)
+    {
+        barrier_builder.use(Texture_Usage{
+            .texture = texture_upload.texture,
+            .sync = D3D12_BARRIER_SYNC_COPY,
+            .access = D3D12_BARRIER_ACCESS_COPY_DEST,
+            .layout = D3D12_BARRIER_LAYOUT_COPY_DEST,
+            .subresources = {
+                .IndexOrFirstMipLevel = texture_upload.dst_subresource,
+                .NumMipLevels = 0
+            }
+            });
+    }
+    cmd_list.flush();
+
+    for (const auto& texture_upload : m_staged_texture_uploads)
+    {
+        D3D12_TEXTURE_COPY_LOCATION dst = {
+            .pResource = texture_upload.dst,
+            .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+            .SubresourceIndex = texture_upload.dst_subresource
+        };
+        D3D12_TEXTURE_COPY_LOCATION src = {
+            .pResource = texture_upload.src,
+            .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+            .PlacedFootprint = texture_upload.src_footprint
+        };
+        cmd->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+        const auto& footprint = texture_upload.src_footprint.Footprint;
+        m_upload_stats.requested_copy_count += 1;
+        m_upload_stats.issued_copy_count += 1;
+        m_upload_stats.uploaded_size += uint64_t(footprint.RowPitch) * footprint.Height * footprint.Depth;
+    }
+
+    m_staged_uploads.clear();
+    m_sorted_staged_uploads.clear();
+    m_staged_texture_uploads.clear();
+}
+
+void Render_Engine::record_staged_readbacks(ID3D12GraphicsCommandList7* cmd)
+{
+    if (m_staged_readbacks.empty() && m_staged_texture_readbacks.empty())
+    {
+        return;
+    }
+
+    // The tracker knows the state the sources are left in by the procedures, which move them out of
+    // COPY_SOURCE again when they are used next.
+    auto cmd_list = Command_List(this, cmd, m_worker_command_streams[0].get());
+    auto& barrier_builder = cmd_list.acquire_barrier_builder();
+    for (const auto& readback : m_staged_readbacks)
+    {
+        barrier_builder.use(Buffer_Usage{
+            .buffer = readback.buffer,
+            .sync = D3D12_BARRIER_SYNC_COPY,
+            .access = D3D12_BARRIER_ACCESS_COPY_SOURCE
+            });
+    }
+    for (const auto& readback : m_staged_texture_readbacks)
+    {
+        barrier_builder.use(Texture_Usage{
+            .texture = readback.texture,
+            .sync = D3D12_BARRIER_SYNC_COPY,
+            .access = D3D12_BARRIER_ACCESS_COPY_SOURCE,
+            .layout = D3D12_BARRIER_LAYOUT_COPY_SOURCE,
+            .subresources = {
+                .IndexOrFirstMipLevel = readback.src_subresource,
+                .NumMipLevels = 0
+            }
+            });
+    }
+    cmd_list.flush();
+
+    for (const auto& readback : m_staged_readbacks)
+    {
+        cmd->CopyBufferRegion(readback.dst, readback.dst_offset, readback.src, readback.src_offset, readback.size);
+    }
+    for (const auto& readback : m_staged_texture_readbacks)
+    {
+        D3D12_TEXTURE_COPY_LOCATION dst = {
+            .pResource = readback.dst,
+            .Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+            .PlacedFootprint = readback.dst_footprint
+        };
+        D3D12_TEXTURE_COPY_LOCATION src = {
+            .pResource = readback.src,
+            .Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+            .SubresourceIndex = readback.src_subresource
+        };
+        cmd->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+    }
+
+    m_staged_readbacks.clear();
+    m_staged_texture_readbacks.clear();
+}
+
+void Render_Engine::empty_deletion_queues(uint64_t frame)
+{
+    m_resource_manager->empty_deletion_queues(frame);
+    m_bindset_deletion_ring->retire(frame);
+}
+
+void Render_Engine::empty_all_deletion_queues()
+{
+    m_bindset_deletion_ring->retire_all();
+    m_resource_manager->empty_all_deletion_queues();
+}
+
+void Render_Engine::retire_bindset(Bindset_Allocation allocation)
+{
+    std::lock_guard lock(m_record_mutex);
+    m_bindset_allocator->delete_bindset(Bindset{ .allocation = allocation, .data = {}, .dirty_mask = 0 });
 }
 }
@@ -1,17 +1,31 @@
 #pragma once
 
+#include "owge_render_engine/render_procedure/render_pass_builder.hpp"
 #include "owge_render_engine/render_procedure/render_procedure.hpp"
 #include "owge_render_engine/resource_allocator.hpp"
 #include "owge_render_engine/resource_manager.hpp"
 #include "owge_render_engine/command_allocator.hpp"
 #include "owge_render_engine/bindless.hpp"
+#include "owge_render_engine/deletion_ring.hpp"
+#include "owge_render_engine/readback_allocator.hpp"
+#include "owge_render_engine/resource_state_tracker.hpp"
 #include "owge_render_engine/staging_buffer_allocator.hpp"
+#include "owge_render_engine/upload_stream_queue.hpp"
 
 #include <owge_d3d12_base/d3d12_ctx.hpp>
 #include <owge_d3d12_base/d3d12_util.hpp>
 #include <owge_d3d12_base/d3d12_swapchain.hpp>
 
+#include <owge_common/command_stream.hpp>
+#include <owge_common/render_graph.hpp>
+#include <owge_common/worker_pool.hpp>
+
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <mutex>
+#include <span>
+#include <string>
 #include <vector>
 
 namespace owge
@@ -23,15 +37,24 @@ struct Render_Engine_Settings
 {
     bool nvperf_enabled;
     bool nvperf_lock_clocks_to_rated_tdp;
+    // Fraction of a bindset page that has to be dirty before the whole page is uploaded at once.
+    float bindset_page_upload_density;
+    // Bytes of streamed uploads staged per frame, 0 stages all pending streams at once.
+    uint64_t streaming_upload_budget;
+    // Threads recording top-level procedures, 0 uses one per hardware thread.
+    uint32_t recording_worker_count;
 };
 
 struct Render_Engine_Frame_Context
 {
     std::unique_ptr<Command_Allocator> direct_queue_cmd_alloc;
+    std::unique_ptr<Command_Allocator> copy_queue_cmd_alloc;
+    std::unique_ptr<Command_Allocator> compute_queue_cmd_alloc;
+    // One per recording worker, command allocators can't be used from multiple threads.
+    std::vector<std::unique_ptr<Command_Allocator>> worker_direct_queue_cmd_allocs;
     Com_Ptr<ID3D12Fence1> direct_queue_fence;
     uint64_t frame_number;
     ID3D12GraphicsCommandList7* upload_cmd;
-    std::unique_ptr<Staging_Buffer_Allocator> staging_buffer_allocator;
 };
 
 struct Staged_Upload
@@ -43,6 +66,60 @@ struct Staged_Upload
     uint64_t size;
 };
 
+struct Staged_Texture_Upload
+{
+    Texture_Handle texture;
+    ID3D12Resource* src;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT src_footprint;
+    ID3D12Resource* dst;
+    uint32_t dst_subresource;
+};
+
+struct Staged_Readback
+{
+    Buffer_Handle buffer;
+    ID3D12Resource* src;
+    uint64_t src_offset;
+    ID3D12Resource* dst;
+    uint64_t dst_offset;
+    uint64_t size;
+};
+
+struct Staged_Texture_Readback
+{
+    Texture_Handle texture;
+    ID3D12Resource* src;
+    uint32_t src_subresource;
+    ID3D12Resource* dst;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT dst_footprint;
+};
+
+// Resolves once the GPU finished the frame the readback was requested in. The data then stays
+// mapped for MAX_CONCURRENT_GPU_FRAMES frames, it has to be copied out to be kept longer.
+struct Readback_Ticket
+{
+    uint64_t frame;
+    const std::byte* data;
+    uint64_t size;
+    // Texture readbacks store one row every `row_pitch` bytes.
+    uint32_t row_pitch;
+};
+
+struct Upload_Stats
+{
+    uint32_t requested_copy_count;
+    uint32_t issued_copy_count;
+    uint64_t uploaded_size;
+    uint64_t pending_stream_size;
+};
+
+struct Barrier_Stats
+{
+    // Barriers pushed or used by procedures, and the ones left after eliminating and merging them.
+    uint32_t requested_barrier_count;
+    uint32_t emitted_barrier_count;
+};
+
 class Render_Engine
 {
 public:
@@ -56,20 +133,51 @@ public:
     Render_Engine& operator=(const Render_Engine&) = delete;
     Render_Engine& operator=(Render_Engine&&) = delete;
 
+    // Procedures are recorded in parallel, each into its own command list, and submitted in the order the
+    // render graph puts them in, which is the order they were added in unless their declared usages
+    // require otherwise. Besides uploads, readbacks and binding updates they must not share mutable state.
     void add_procedure(Render_Procedure* proc);
+    // Async compute procedures are recorded on the async compute queue and may only dispatch compute work.
+    // They run concurrently with the graphics work of the same frame, which sees their results one frame
+    // later. Outputs consumed by graphics have to be double-buffered on `get_current_frame()`.
+    // They run on the direct queue instead if the render graph can't place them on the async compute queue.
+    void add_async_compute_procedure(Render_Procedure* proc);
     void render(float delta_time);
 
     [[nodiscard]] void* upload_data(uint64_t size, uint64_t align, Buffer_Handle dst, uint64_t dst_offset);
-    void copy_and_upload_data(uint64_t size, uint64_t align, Buffer_Handle dst, uint64_t dst_offset, void* data);
-    void update_bindings(const Bindset& bindset);
+    void copy_and_upload_data(uint64_t size, uint64_t align, Buffer_Handle dst, uint64_t dst_offset, const void* data);
+    // Uploads `size` bytes on the copy queue, over as many frames as the streaming budget requires.
+    [[nodiscard]] Upload_Stream_Ticket stream_data(Buffer_Handle dst, uint64_t dst_offset,
+        std::shared_ptr<const void> data, uint64_t size);
+    [[nodiscard]] bool is_upload_stream_complete(Upload_Stream_Ticket ticket) const;
+    // Stages `footprints.size()` subresources of `dst` starting at `first_subresource` in one allocation and
+    // returns it. Each subresource has to be written at its footprint offset, one row every `row_pitch` bytes.
+    // `dst` has to be in a layout that allows copies when the frame starts.
+    [[nodiscard]] void* upload_texture_data(Texture_Handle dst, uint32_t first_subresource,
+        std::span<Subresource_Footprint> footprints);
+    // Same as above, but copies from tightly packed rows, slices and subresources in `data`.
+    void copy_and_upload_texture_data(Texture_Handle dst, uint32_t first_subresource, uint32_t subresource_count,
+        const void* data);
+    void update_bindings(Bindset& bindset);
+
+    // Copies the data at the end of the current frame, after all render procedures ran.
+    [[nodiscard]] Readback_Ticket request_readback(Buffer_Handle src, uint64_t offset, uint64_t size);
+    [[nodiscard]] Readback_Ticket request_readback(Texture_Handle src, uint32_t subresource);
+    // Returns an empty span while the readback is still in flight.
+    [[nodiscard]] std::span<const std::byte> get_readback_data(const Readback_Ticket& ticket) const;
 
     [[nodiscard]] Buffer_Handle create_buffer(const Buffer_Desc& desc, const wchar_t* name = nullptr);
     [[nodiscard]] Texture_Handle create_texture(const Texture_Desc& desc, const wchar_t* name = nullptr);
+    void create_transient_textures(std::span<const Transient_Texture_Desc> descs, std::span<Texture_Handle> textures);
     [[nodiscard]] Shader_Handle create_shader(const Shader_Desc& desc);
     [[nodiscard]] Pipeline_Handle create_pipeline(const Graphics_Pipeline_Desc& desc, const wchar_t* name = nullptr);
     [[nodiscard]] Pipeline_Handle create_pipeline(const Compute_Pipeline_Desc& desc, const wchar_t* name = nullptr);
     [[nodiscard]] Sampler_Handle create_sampler(const Sampler_Desc& desc);
-    [[nodiscard]] Bindset create_bindset();
+    // Bindsets are rounded up to the next size class, see MIN_BINDSET_VALUES.
+    [[nodiscard]] Bindset create_bindset(uint32_t value_count = DEFAULT_BINDSET_VALUES);
+    // Dynamic bindsets are read by shaders straight from upload memory. Their data only lives for
+    // one frame, so they have to go through `update_bindings` in every frame they are bound.
+    [[nodiscard]] Bindset create_dynamic_bindset(uint32_t value_count = DEFAULT_BINDSET_VALUES);
 
     void destroy_buffer(Buffer_Handle handle);
     void destroy_texture(Texture_Handle handle);
@@ -85,17 +193,53 @@ public:
     [[nodiscard]] Texture& get_texture(Texture_Handle handle);
     [[nodiscard]] const Pipeline& get_pipeline(Pipeline_Handle handle) const;
     [[nodiscard]] Pipeline& get_pipeline(Pipeline_Handle handle);
+    [[nodiscard]] const Pipeline_Desc& get_pipeline_desc(Pipeline_Handle handle) const;
+    // Suballocated buffers share one resource per arena, PIX and the debug layer only show the arena's name.
+    [[nodiscard]] const std::wstring& get_buffer_name(Buffer_Handle handle) const;
     [[nodiscard]] const Shader& get_shader(Shader_Handle handle) const;
     [[nodiscard]] Shader& get_shader(Shader_Handle handle);
 
     [[nodiscard]] D3D12_CPU_DESCRIPTOR_HANDLE get_cpu_descriptor_from_texture(Texture_Handle handle) const;
+    // Snapshot taken at the start of the current frame, after deferred deletions were retired.
+    [[nodiscard]] const Descriptor_Heap_Occupancy& get_descriptor_heap_occupancy() const
+    {
+        return m_descriptor_heap_occupancy;
+    }
+    // Uploads recorded during the previous frame.
+    [[nodiscard]] const Upload_Stats& get_upload_stats() const
+    {
+        return m_upload_stats;
+    }
+    // Barriers recorded during the previous frame.
+    [[nodiscard]] const Barrier_Stats& get_barrier_stats() const
+    {
+        return m_barrier_stats;
+    }
+    void add_barrier_stats(uint32_t requested_barrier_count, uint32_t emitted_barrier_count)
+    {
+        m_frame_requested_barrier_count.fetch_add(requested_barrier_count, std::memory_order_relaxed);
+        m_frame_emitted_barrier_count.fetch_add(emitted_barrier_count, std::memory_order_relaxed);
+    }
+    [[nodiscard]] Resource_State_Tracker* get_resource_state_tracker()
+    {
+        return m_resource_state_tracker.get();
+    }
+    [[nodiscard]] uint64_t get_current_frame() const
+    {
+        return m_current_frame;
+    }
     [[nodiscard]] const D3D12_Context* get_context() const
     {
         return &m_ctx;
     }
 
 private:
+    void compile_render_graph();
+    void record_staged_uploads(ID3D12GraphicsCommandList7* cmd);
+    void record_staged_readbacks(ID3D12GraphicsCommandList7* cmd);
     void empty_deletion_queues(uint64_t frame);
+    void empty_all_deletion_queues();
+    void retire_bindset(Bindset_Allocation allocation);
 
 private:
     D3D12_Context m_ctx;
@@ -103,25 +247,58 @@ private:
     bool m_nvperf_active;
 
     std::unique_ptr<Resource_Manager> m_resource_manager;
+    std::unique_ptr<Resource_State_Tracker> m_resource_state_tracker;
+    std::atomic<uint32_t> m_frame_requested_barrier_count = 0;
+    std::atomic<uint32_t> m_frame_emitted_barrier_count = 0;
+    Barrier_Stats m_barrier_stats = {};
 
     std::unique_ptr<D3D12_Swapchain> m_swapchain;
     std::vector<Render_Procedure*> m_procedures;
+    std::unique_ptr<Worker_Pool> m_worker_pool;
+    // Command lists recorded on a worker record into its stream, which is translated before the task ends.
+    std::vector<std::unique_ptr<Command_Stream>> m_worker_command_streams;
+    std::vector<std::unique_ptr<Resource_State_Tracker>> m_procedure_state_trackers;
+    std::vector<ID3D12GraphicsCommandList7*> m_procedure_cmds;
+    std::vector<ID3D12CommandList*> m_submitted_procedure_cmds;
+    std::vector<Render_Procedure*> m_async_compute_procedures;
+    // Rebuilt every frame from the usages the procedures declare, see `compile_render_graph`.
+    Render_Pass_Builder m_render_pass_builder;
+    Render_Graph m_render_graph;
+    std::vector<Render_Procedure*> m_direct_passes;
+    std::vector<Render_Procedure*> m_async_compute_passes;
 
-    uint64_t m_current_frame = 0;
+    std::atomic<uint64_t> m_current_frame = 0;
     uint32_t m_current_frame_index = 0;
     std::array<Render_Engine_Frame_Context, MAX_CONCURRENT_GPU_FRAMES> m_frame_contexts;
 
     std::unique_ptr<Bindset_Allocator> m_bindset_allocator;
     std::unique_ptr<Bindset_Stager> m_bindset_stager;
+    std::unique_ptr<Dynamic_Bindset_Allocator> m_dynamic_bindset_allocator;
 
+    std::unique_ptr<Staging_Buffer_Allocator> m_staging_buffer_allocator;
     std::vector<Staged_Upload> m_staged_uploads;
+    std::vector<Staged_Upload> m_sorted_staged_uploads;
+    std::vector<Staged_Texture_Upload> m_staged_texture_uploads;
+    Upload_Stream_Queue m_upload_stream_queue;
+    Com_Ptr<ID3D12Fence1> m_copy_queue_fence;
+    uint64_t m_copy_queue_fence_value = 0;
+    uint64_t m_completed_copy_queue_fence_value = 0;
+    Upload_Stats m_upload_stats = {};
+    // Guards uploads, readback requests, binding updates and bindset allocations, procedures call them while
+    // recorded in parallel.
+    mutable std::mutex m_record_mutex;
 
-    template<typename T>
-    struct Deletion_Queue_Resource
-    {
-        T resource;
-        uint64_t frame;
-    };
-    std::vector<Deletion_Queue_Resource<Bindset>> m_bindset_deletion_queue;
+    // Signaled on the direct queue once a frame's uploads are done, the async compute work of that frame waits on it.
+    Com_Ptr<ID3D12Fence1> m_upload_fence;
+    Com_Ptr<ID3D12Fence1> m_async_compute_fence;
+    uint64_t m_async_compute_fence_value = 0;
+
+    std::unique_ptr<Readback_Allocator> m_readback_allocator;
+    std::vector<Staged_Readback> m_staged_readbacks;
+    std::vector<Staged_Texture_Readback> m_staged_texture_readbacks;
+
+    Descriptor_Heap_Occupancy m_descriptor_heap_occupancy = {};
+
+    std::unique_ptr<Deletion_Ring> m_bindset_deletion_ring;
 };
 }
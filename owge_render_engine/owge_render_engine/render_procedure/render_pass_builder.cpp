@@ -0,0 +1,106 @@
+#include "owge_render_engine/render_procedure/render_pass_builder.hpp"
+
+#include <cassert>
+
+namespace owge
+{
+// Texture keys never have all bits set, the generation only has 20 bits.
+static constexpr uint64_t SWAPCHAIN_KEY = ~0ull;
+
+[[nodiscard]] static uint64_t get_texture_key(Texture_Handle texture)
+{
+    return (uint64_t(texture.gen) << 32) | texture.resource_idx;
+}
+
+void Render_Pass_Builder::use(Texture_Handle texture, Render_Graph_Access access)
+{
+    assert(!m_passes.empty());
+    m_usages.push_back({
+        .resource = get_resource(get_texture_key(texture)),
+        .access = access
+    });
+    m_passes.back().usage_count += 1;
+}
+
+void Render_Pass_Builder::use_swapchain(Render_Graph_Access access)
+{
+    assert(!m_passes.empty());
+    auto resource = get_resource(SWAPCHAIN_KEY);
+    m_resources[resource].exported = true;
+    m_resources[resource].final_access = Render_Graph_Access::Present;
+    m_usages.push_back({
+        .resource = resource,
+        .access = access
+    });
+    m_passes.back().usage_count += 1;
+}
+
+void Render_Pass_Builder::export_texture(Texture_Handle texture)
+{
+    m_resources[get_resource(get_texture_key(texture))].exported = true;
+}
+
+void Render_Pass_Builder::set_side_effects()
+{
+    assert(!m_passes.empty());
+    m_passes.back().desc.side_effects = true;
+}
+
+void Render_Pass_Builder::begin_pass(bool async_compute)
+{
+    m_passes.push_back({
+        .desc = {
+            .async_compute = async_compute,
+            .side_effects = false
+        },
+        .first_usage = uint32_t(m_usages.size()),
+        .usage_count = 0
+    });
+}
+
+void Render_Pass_Builder::build(Render_Graph& graph) const
+{
+    for (const auto& resource : m_resources)
+    {
+        [[maybe_unused]] auto index = graph.add_resource(resource);
+    }
+    for (const auto& pass : m_passes)
+    {
+        // Nothing can tell whether the results of a pass that declares nothing are used, so it is kept.
+        auto desc = pass.desc;
+        desc.side_effects = desc.side_effects || pass.usage_count == 0;
+        auto index = graph.add_pass(desc);
+        for (auto i = pass.first_usage; i < pass.first_usage + pass.usage_count; ++i)
+        {
+            graph.use(index, m_usages[i].resource, m_usages[i].access);
+        }
+    }
+}
+
+void Render_Pass_Builder::clear()
+{
+    m_passes.clear();
+    m_usages.clear();
+    m_resources.clear();
+    m_resource_indices.clear();
+}
+
+uint32_t Render_Pass_Builder::get_resource(uint64_t key)
+{
+    auto [it, inserted] = m_resource_indices.try_emplace(key, uint32_t(m_resources.size()));
+    if (inserted)
+    {
+        // The contents of imported textures are unknown to the graph, see the class comment.
+        m_resources.push_back({
+            .texture = true,
+            .imported = true,
+            .exported = false,
+            .initial_access = Render_Graph_Access::None,
+            .final_access = Render_Graph_Access::None,
+            .size = 0,
+            .alignment = 0
+        });
+    }
+    return it->second;
+}
+}
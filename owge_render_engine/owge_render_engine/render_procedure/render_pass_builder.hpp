@@ -0,0 +1,54 @@
+#pragma once
+
+#include "owge_render_engine/resource.hpp"
+
+#include <owge_common/render_graph.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace owge
+{
+// Collects the usages render procedures declare for a frame and turns each procedure into a render graph pass.
+// Textures are imported into the graph, their barriers are still recorded through the Barrier_Builder,
+// which knows the state they are actually in, so the graph only orders, culls and assigns queues.
+class Render_Pass_Builder
+{
+public:
+    void use(Texture_Handle texture, Render_Graph_Access access);
+    // The image acquired for the frame, it is presented after the graph ran.
+    void use_swapchain(Render_Graph_Access access);
+    // The contents are used after the frame, e.g. by the next one, so the passes producing them are kept.
+    void export_texture(Texture_Handle texture);
+    // The pass has effects outside of the declared usages and is never culled.
+    void set_side_effects();
+
+    // Usages declared after this belong to a new pass, passes are numbered in the order they begin in.
+    void begin_pass(bool async_compute);
+    void build(Render_Graph& graph) const;
+    void clear();
+
+private:
+    struct Pass
+    {
+        Render_Graph_Pass_Desc desc;
+        uint32_t first_usage;
+        uint32_t usage_count;
+    };
+
+    struct Usage
+    {
+        uint32_t resource;
+        Render_Graph_Access access;
+    };
+
+    [[nodiscard]] uint32_t get_resource(uint64_t key);
+
+private:
+    std::vector<Pass> m_passes;
+    std::vector<Usage> m_usages;
+    std::vector<Render_Graph_Resource_Desc> m_resources;
+    std::unordered_map<uint64_t, uint32_t> m_resource_indices;
+};
+}
@@ -7,6 +7,7 @@ namespace owge
 {
 class Command_List;
 class Render_Engine;
+class Render_Pass_Builder;
 class Barrier_Builder;
 class D3D12_Swapchain;
 
@@ -24,6 +25,9 @@ class Render_Procedure
 public:
     virtual ~Render_Procedure() = default;
 
+    // Declares the resources `process` uses this frame, the render engine orders and culls the procedures by them.
+    // Procedures that declare nothing are never culled.
+    virtual void declare([[maybe_unused]] Render_Engine* render_engine, [[maybe_unused]] Render_Pass_Builder& builder) {}
     virtual void process(const Render_Procedure_Payload& payload) = 0;
     [[nodiscard]] const char* get_name() const { return m_name.c_str(); }
 
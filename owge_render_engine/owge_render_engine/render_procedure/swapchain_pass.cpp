@@ -1,5 +1,6 @@
 #include "owge_render_engine/render_procedure/swapchain_pass.hpp"
 #include "owge_render_engine/command_list.hpp"
+#include "owge_render_engine/render_procedure/render_pass_builder.hpp"
 
 #include <owge_d3d12_base/d3d12_swapchain.hpp>
 
@@ -15,9 +16,23 @@ void Swapchain_Pass_Render_Procedure::add_subprocedure(Render_Procedure* sub_pro
     m_sub_procedures.push_back(sub_procedure);
 }
 
+void Swapchain_Pass_Render_Procedure::declare(Render_Engine* render_engine, Render_Pass_Builder& builder)
+{
+    builder.use_swapchain(Render_Graph_Access::Render_Target);
+    if (!m_settings.depth_stencil_texture.is_null_handle())
+    {
+        builder.use(m_settings.depth_stencil_texture, Render_Graph_Access::Depth_Stencil_Write);
+    }
+    // Subprocedures are recorded as part of this pass.
+    for (auto subproc : m_sub_procedures)
+    {
+        subproc->declare(render_engine, builder);
+    }
+}
+
 void Swapchain_Pass_Render_Procedure::process(const Render_Procedure_Payload& payload)
 {
-    auto barrier_builder = payload.cmd->acquire_barrier_builder();
+    auto& barrier_builder = payload.cmd->acquire_barrier_builder();
     barrier_builder.push({
         .swapchain = payload.swapchain,
         .sync_before = D3D12_BARRIER_SYNC_NONE,
@@ -38,26 +53,14 @@ void Swapchain_Pass_Render_Procedure::process(const Render_Procedure_Payload& pa
         });
     if (!m_settings.depth_stencil_texture.is_null_handle())
     {
-        barrier_builder.push(Texture_Barrier {
+        barrier_builder.use(Texture_Usage{
             .texture = m_settings.depth_stencil_texture,
-            .sync_before = D3D12_BARRIER_SYNC_NONE,
-            .sync_after = D3D12_BARRIER_SYNC_DEPTH_STENCIL,
-            .access_before = D3D12_BARRIER_ACCESS_NO_ACCESS,
-            .access_after = D3D12_BARRIER_ACCESS_DEPTH_STENCIL_WRITE,
-            .layout_before = D3D12_BARRIER_LAYOUT_UNDEFINED,
-            .layout_after = D3D12_BARRIER_LAYOUT_DEPTH_STENCIL_WRITE,
-            .subresources = {
-                .IndexOrFirstMipLevel = 0xFFFFFFFF,
-                .NumMipLevels = 0,
-                .FirstArraySlice = 0,
-                .NumArraySlices = 0,
-                .FirstPlane = 0,
-                .NumPlanes = 0
-            },
-            .flags = D3D12_TEXTURE_BARRIER_FLAG_NONE // Maybe DISCARD?
+            .sync = D3D12_BARRIER_SYNC_DEPTH_STENCIL,
+            .access = D3D12_BARRIER_ACCESS_DEPTH_STENCIL_WRITE,
+            .layout = D3D12_BARRIER_LAYOUT_DEPTH_STENCIL_WRITE,
+            .discard = true
             });
     }
-    barrier_builder.flush();
 
     payload.cmd->clear_render_target(payload.swapchain, m_settings.clear_color);
     if (m_settings.depth_stencil_texture.is_null_handle())
@@ -114,6 +117,5 @@ void Swapchain_Pass_Render_Procedure::process(const Render_Procedure_Payload& pa
         },
         .flags = D3D12_TEXTURE_BARRIER_FLAG_NONE // Maybe DISCARD?
         });
-    barrier_builder.flush();
 }
 }
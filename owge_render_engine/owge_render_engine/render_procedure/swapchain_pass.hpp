@@ -18,6 +18,7 @@ public:
     Swapchain_Pass_Render_Procedure(const Swapchain_Pass_Settings& settings);
 
     void add_subprocedure(Render_Procedure* sub_procedure);
+    virtual void declare(Render_Engine* render_engine, Render_Pass_Builder& builder) override;
     virtual void process(const Render_Procedure_Payload& payload) override;
 
 private:
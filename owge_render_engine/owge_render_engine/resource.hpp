@@ -1,5 +1,7 @@
 #pragma once
 
+#include "owge_render_engine/resource_handle.hpp"
+
 #include <cstddef>
 #include <cstdint>
 #include <include/d3d12.h>
@@ -8,38 +10,6 @@
 
 namespace owge
 {
-template<typename T>
-struct Base_Resource_Handle
-{
-    uint64_t alive : 1;
-    uint64_t flags : 3;
-    uint64_t bindless_idx : 20;
-    uint64_t gen : 20;
-    uint64_t resource_idx : 20;
-
-    [[nodiscard]] bool operator==(Base_Resource_Handle other) const
-    {
-        return (alive == other.alive)
-            && (flags == other.flags)
-            && (bindless_idx == other.bindless_idx)
-            && (gen == other.gen)
-            && (resource_idx == other.resource_idx);
-    }
-    [[nodiscard]] bool operator!=(Base_Resource_Handle other) const
-    {
-        return !(*this == other);
-    }
-
-    [[nodiscard]] bool is_null_handle() const
-    {
-        return alive == 0
-            && flags == 0
-            && bindless_idx == 0
-            && gen == 0
-            && resource_idx == 0;
-    }
-};
-
 enum class Resource_Usage
 {
     Read_Only,
@@ -51,11 +21,17 @@ struct Buffer_Desc
     uint64_t size;
     D3D12_HEAP_TYPE heap_type;
     Resource_Usage usage;
+    // Small default heap buffers are placed inside a shared buffer and share its descriptors.
+    // Shaders have to add `offset` to every access, which the bindless buffer helpers do.
+    bool suballocate;
 };
 
 struct Buffer
 {
     ID3D12Resource2* resource;
+    uint64_t size;
+    uint32_t offset;
+    uint32_t descriptor_allocation;
 };
 using Buffer_Handle = Base_Resource_Handle<Buffer>;
 
@@ -80,9 +56,22 @@ struct Texture
     ID3D12Resource2* resource;
     uint32_t rtv;
     uint32_t dsv;
+    uint32_t descriptor_allocation;
 };
 using Texture_Handle = Base_Resource_Handle<Texture>;
 
+// Set on transient textures that share memory with another transient texture.
+static constexpr uint8_t TEXTURE_FLAG_ALIASED = 0x1;
+
+// `first_use` and `last_use` are inclusive pass indices in a caller defined order within a frame.
+struct Transient_Texture_Desc
+{
+    Texture_Desc texture;
+    uint32_t first_use;
+    uint32_t last_use;
+    const wchar_t* name;
+};
+
 struct Shader_Desc
 {
     std::string path;
@@ -132,6 +121,11 @@ struct Pipeline
     uint32_t workgroups_x;
     uint32_t workgroups_y;
     uint32_t workgroups_z;
+};
+
+struct Pipeline_Desc
+{
+    Pipeline_Type type;
     union
     {
         Graphics_Pipeline_Desc graphics;
@@ -1,40 +1,73 @@
 #pragma once
 
-#include "owge_render_engine/resource.hpp"
+#include "owge_render_engine/resource_handle.hpp"
 
-#include <vector>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
 
 namespace owge
 {
-template<typename T>
+struct No_Cold_Data {};
+
+// Elements are split into a hot array holding T, which is touched on every lookup,
+// and an optional parallel cold array holding T_Cold, which is only read through cold().
+// insert, emplace and remove are lock-free and may be called from multiple threads.
+// insert and emplace throw std::length_error once all `capacity` slots are in use.
+template<typename T, typename T_Cold = No_Cold_Data>
 class Resource_Allocator
 {
     using Handle_Type = Base_Resource_Handle<T>;
     static constexpr uint32_t NO_HEAD = ~0u;
+    static constexpr uint32_t PAGE_SIZE_LOG2 = 10;
+    static constexpr uint32_t PAGE_SIZE = 1u << PAGE_SIZE_LOG2;
+    static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1;
+    static constexpr bool HAS_COLD_DATA = !std::is_same_v<T_Cold, No_Cold_Data>;
 
 public:
-    Resource_Allocator(std::size_t size) noexcept
-        : m_head(NO_HEAD), m_storage()
+    // Storage is committed in pages of PAGE_SIZE elements as the allocator grows.
+    // Pages are never moved or released, so references stay valid until the slot is removed.
+    Resource_Allocator(std::size_t capacity) noexcept
+        : m_head(pack_head(NO_HEAD, 0))
+        , m_size(0)
+        , m_committed_pages(0)
+        , m_capacity(uint32_t(capacity))
+        , m_page_count(uint32_t((capacity + PAGE_SIZE - 1) / PAGE_SIZE))
+        , m_pages(std::make_unique<std::atomic<Storage*>[]>(m_page_count))
+        , m_cold_pages()
     {
-        m_storage.reserve(size);
+        if constexpr (HAS_COLD_DATA)
+        {
+            m_cold_pages = std::make_unique<std::atomic<T_Cold*>[]>(m_page_count);
+        }
     }
 
-    [[nodiscard]] Handle_Type insert(
-        uint8_t flags, uint32_t bindless_idx, const T& value) noexcept
+    ~Resource_Allocator() noexcept
     {
-        uint32_t resource_idx = 0;
-        if (m_head != NO_HEAD)
+        for (uint32_t i = 0; i < m_page_count; ++i)
         {
-            resource_idx = m_head;
-            m_head = m_storage[resource_idx].next;
+            delete[] m_pages[i].load(std::memory_order_relaxed);
+            if constexpr (HAS_COLD_DATA)
+            {
+                delete[] m_cold_pages[i].load(std::memory_order_relaxed);
+            }
         }
-        else
+    }
+
+    Resource_Allocator(const Resource_Allocator&) = delete;
+    Resource_Allocator& operator=(const Resource_Allocator&) = delete;
+
+    [[nodiscard]] Handle_Type insert(
+        uint8_t flags, uint32_t bindless_idx, const T& value)
+    {
+        uint32_t resource_idx = pop_free_slot();
+        if (resource_idx == NO_HEAD)
         {
-            m_storage.push_back({});
-            resource_idx = uint32_t(m_storage.size() - 1ull);
+            resource_idx = claim_new_slot();
         }
 
-        auto& data = m_storage[resource_idx];
+        auto& data = storage(resource_idx);
         data.alive = true;
         data.flags = flags;
         data.element = value;
@@ -47,13 +80,22 @@ public:
         };
     }
 
+    [[nodiscard]] Handle_Type insert(
+        uint8_t flags, uint32_t bindless_idx, const T& value, const T_Cold& cold_value)
+        requires HAS_COLD_DATA
+    {
+        Handle_Type handle = insert(flags, bindless_idx, value);
+        cold(handle) = cold_value;
+        return handle;
+    }
+
     struct Emplaced_Handle
     {
         Handle_Type handle;
         T& value;
     };
     [[nodiscard]] Emplaced_Handle emplace(
-        uint8_t flags, uint32_t bindless_idx) noexcept
+        uint8_t flags, uint32_t bindless_idx)
     {
         Handle_Type handle = insert(flags, bindless_idx, {});
         return {
@@ -64,35 +106,175 @@ public:
 
     void remove(Handle_Type handle) noexcept
     {
-        auto& data = m_storage[handle.resource_idx];
+        auto& data = storage(handle.resource_idx);
         data.alive = false;
         data.flags = 0;
         data.gen += 1;
         data.element = {};
-        data.next = m_head;
-        m_head = handle.resource_idx;
+        if constexpr (HAS_COLD_DATA)
+        {
+            cold(handle) = {};
+        }
+        push_free_slot(uint32_t(handle.resource_idx));
     }
 
     [[nodiscard]] T& operator[](Handle_Type handle) noexcept
     {
-        return m_storage[handle.resource_idx].element;
+        return storage(handle.resource_idx).element;
     }
 
-    [[nodiscard]] const T& at(Handle_Type handle) const noexcept
+    [[nodiscard]] const T& at(Handle_Type handle) const
     {
-        return m_storage.at(handle.resource_idx).element;
+        if (handle.resource_idx >= size())
+        {
+            throw std::out_of_range("Resource_Allocator::at");
+        }
+        return storage(handle.resource_idx).element;
+    }
+
+    [[nodiscard]] T_Cold& cold(Handle_Type handle) noexcept
+        requires HAS_COLD_DATA
+    {
+        return cold_storage(handle.resource_idx);
+    }
+
+    [[nodiscard]] const T_Cold& cold_at(Handle_Type handle) const
+        requires HAS_COLD_DATA
+    {
+        if (handle.resource_idx >= size())
+        {
+            throw std::out_of_range("Resource_Allocator::cold_at");
+        }
+        return cold_storage(handle.resource_idx);
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    [[nodiscard]] std::size_t committed_pages() const noexcept
+    {
+        return m_committed_pages.load(std::memory_order_relaxed);
     }
 
 private:
-    uint32_t m_head;
     struct Storage
     {
         uint32_t alive : 1;
         uint32_t flags : 8;
         uint32_t gen : 23;
-        uint32_t next;
+        std::atomic<uint32_t> next;
         T element;
     };
-    std::vector<Storage> m_storage;
+
+    // The free list head packs the slot index with a tag that is bumped on every pop
+    // so a slot that is popped and pushed back between a load and a CAS is detected.
+    [[nodiscard]] static constexpr uint64_t pack_head(uint32_t index, uint32_t tag) noexcept
+    {
+        return (uint64_t(tag) << 32) | index;
+    }
+
+    [[nodiscard]] uint32_t pop_free_slot() noexcept
+    {
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        while (uint32_t(head) != NO_HEAD)
+        {
+            auto next = storage(uint32_t(head)).next.load(std::memory_order_relaxed);
+            auto new_head = pack_head(next, uint32_t(head >> 32) + 1);
+            if (m_head.compare_exchange_weak(head, new_head,
+                std::memory_order_acquire, std::memory_order_acquire))
+            {
+                return uint32_t(head);
+            }
+        }
+        return NO_HEAD;
+    }
+
+    // Slots above the size are only claimed while it is below the capacity,
+    // so a full allocator doesn't grow past the pages it can commit.
+    [[nodiscard]] uint32_t claim_new_slot()
+    {
+        uint32_t size = m_size.load(std::memory_order_relaxed);
+        do
+        {
+            if (size >= m_capacity)
+            {
+                throw std::length_error("Resource_Allocator is out of slots.");
+            }
+        } while (!m_size.compare_exchange_weak(size, size + 1, std::memory_order_relaxed));
+        commit_page(size >> PAGE_SIZE_LOG2);
+        return size;
+    }
+
+    void push_free_slot(uint32_t index) noexcept
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        do
+        {
+            storage(index).next.store(uint32_t(head), std::memory_order_relaxed);
+        } while (!m_head.compare_exchange_weak(head, pack_head(index, uint32_t(head >> 32)),
+            std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Cold pages are published before their hot page, so any thread that sees the hot page
+    // committed can also access the cold one.
+    void commit_page(uint32_t page) noexcept
+    {
+        if (m_pages[page].load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        if constexpr (HAS_COLD_DATA)
+        {
+            commit_page_slot(m_cold_pages[page]);
+        }
+        if (commit_page_slot(m_pages[page]))
+        {
+            m_committed_pages.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    template<typename U>
+    static bool commit_page_slot(std::atomic<U*>& slot) noexcept
+    {
+        if (slot.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        auto* new_page = new U[PAGE_SIZE]();
+        U* expected = nullptr;
+        if (!slot.compare_exchange_strong(expected, new_page,
+            std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            delete[] new_page;
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] Storage& storage(uint32_t index) const noexcept
+    {
+        return m_pages[index >> PAGE_SIZE_LOG2].load(std::memory_order_acquire)[index & PAGE_MASK];
+    }
+
+    [[nodiscard]] T_Cold& cold_storage(uint32_t index) const noexcept
+    {
+        return m_cold_pages[index >> PAGE_SIZE_LOG2].load(std::memory_order_acquire)[index & PAGE_MASK];
+    }
+
+    std::atomic<uint64_t> m_head;
+    std::atomic<uint32_t> m_size;
+    std::atomic<uint32_t> m_committed_pages;
+    uint32_t m_capacity;
+    uint32_t m_page_count;
+    std::unique_ptr<std::atomic<Storage*>[]> m_pages;
+    std::unique_ptr<std::atomic<T_Cold*>[]> m_cold_pages;
 };
 }
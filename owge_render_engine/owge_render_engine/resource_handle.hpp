@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+namespace owge
+{
+// Bindless index of resources without shader visible views. It is the largest value the handle
+// can store and lies past the end of the largest shader visible descriptor heap.
+static constexpr uint32_t NO_BINDLESS_IDX = 0xFFFFF;
+
+template<typename T>
+struct Base_Resource_Handle
+{
+    uint64_t alive : 1;
+    uint64_t flags : 3;
+    uint64_t bindless_idx : 20;
+    uint64_t gen : 20;
+    uint64_t resource_idx : 20;
+
+    [[nodiscard]] uint32_t get_bindless_idx() const
+    {
+        assert(bindless_idx != NO_BINDLESS_IDX);
+        return uint32_t(bindless_idx);
+    }
+
+    [[nodiscard]] bool operator==(Base_Resource_Handle other) const
+    {
+        return (alive == other.alive)
+            && (flags == other.flags)
+            && (bindless_idx == other.bindless_idx)
+            && (gen == other.gen)
+            && (resource_idx == other.resource_idx);
+    }
+    [[nodiscard]] bool operator!=(Base_Resource_Handle other) const
+    {
+        return !(*this == other);
+    }
+
+    [[nodiscard]] bool is_null_handle() const
+    {
+        return alive == 0
+            && flags == 0
+            && bindless_idx == 0
+            && gen == 0
+            && resource_idx == 0;
+    }
+};
+}
@@ -1,11 +1,12 @@
 #include "owge_render_engine/resource_manager.hpp"
 
 #include "owge_common/file_util.hpp"
+#include "owge_common/transient_planner.hpp"
 #include "owge_d3d12_base/d3d12_ctx.hpp"
 
 #include <algorithm>
+#include <cassert>
 #include <d3d12shader.h>
-#include <ranges>
 
 namespace owge
 {
@@ -18,25 +19,120 @@ static constexpr uint32_t NO_SRV = 0x1FFFFF;
 static constexpr uint32_t NO_UAV = 0x1FFFFF;
 static constexpr uint32_t NO_RTV_DSV = 0x1FFFFF;
 
-Resource_Manager::Resource_Manager(D3D12_Context* ctx)
+static constexpr uint64_t SMALL_BUFFER_ARENA_SIZE = 4194304; // 4 MB
+static constexpr uint64_t MAX_SMALL_BUFFER_SIZE = 65536;
+static constexpr uint64_t SMALL_BUFFER_ALIGNMENT = 16;
+
+// Buffer and texture views are allocated as one contiguous range starting at bindless_idx:
+// [SRV][UAV mip 0][UAV mip 1]...
+// The SRV slot is kept even if the resource has no SRV so that write_index() stays at bindless_idx + 1.
+// Resources without any shader visible view don't allocate a range at all and get NO_BINDLESS_IDX.
+[[nodiscard]] static uint32_t get_buffer_descriptor_count(const Buffer_Desc& desc)
+{
+    return desc.usage == Resource_Usage::Read_Write ? 2 : 1;
+}
+
+[[nodiscard]] static uint32_t get_texture_uav_count(const Texture_Desc& desc)
+{
+    if (desc.uav_dimension == D3D12_UAV_DIMENSION_UNKNOWN)
+    {
+        return 0;
+    }
+    // Multisampled UAVs have no mip slice.
+    if (desc.uav_dimension == D3D12_UAV_DIMENSION_TEXTURE2DMS ||
+        desc.uav_dimension == D3D12_UAV_DIMENSION_TEXTURE2DMSARRAY)
+    {
+        return 1;
+    }
+    return std::max(desc.mip_levels, 1u);
+}
+
+[[nodiscard]] static uint32_t get_texture_descriptor_count(const Texture_Desc& desc)
+{
+    auto uav_count = get_texture_uav_count(desc);
+    if (uav_count > 0)
+    {
+        return 1 + uav_count;
+    }
+    return desc.srv_dimension != D3D12_SRV_DIMENSION_UNKNOWN ? 1 : 0;
+}
+
+[[nodiscard]] static D3D12_RESOURCE_DESC1 get_texture_resource_desc(const Texture_Desc& desc)
+{
+    D3D12_RESOURCE_DESC1 resource_desc = {
+        .Dimension = desc.dimension,
+        .Alignment = 0,
+        .Width = desc.width,
+        .Height = desc.height,
+        .DepthOrArraySize = uint16_t(desc.depth_or_array_layers),
+        .MipLevels = uint16_t(desc.mip_levels),
+        .Format = desc.format,
+        .SampleDesc = { .Count = 1, .Quality = 0 },
+        .Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN,
+        .Flags = D3D12_RESOURCE_FLAG_NONE,
+        .SamplerFeedbackMipRegion = {}
+    };
+
+    resource_desc.Flags |= desc.uav_dimension != D3D12_UAV_DIMENSION_UNKNOWN
+        ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
+        : D3D12_RESOURCE_FLAG_NONE;
+    resource_desc.Flags |= desc.rtv_dimension != D3D12_RTV_DIMENSION_UNKNOWN
+        ? D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET
+        : D3D12_RESOURCE_FLAG_NONE;
+    resource_desc.Flags |= desc.dsv_dimension != D3D12_DSV_DIMENSION_UNKNOWN
+        ? D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL
+        : D3D12_RESOURCE_FLAG_NONE;
+    return resource_desc;
+}
+
+Resource_Manager::Resource_Manager(D3D12_Context* ctx, uint32_t deletion_ring_size)
     : m_ctx(ctx)
     , m_buffers(MAX_BUFFERS)
     , m_textures(MAX_TEXTURES)
     , m_pipelines(MAX_PIPELINES)
     , m_shaders(MAX_SHADERS)
     , m_samplers(D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE)
-    , m_cbv_srv_uav_descriptor_allocator(m_ctx->cbv_srv_uav_descriptor_heap, m_ctx->device)
-    , m_sampler_descriptor_allocator(m_ctx->sampler_descriptor_heap, m_ctx->device)
-    , m_rtv_descriptor_allocator(m_ctx->rtv_descriptor_heap, m_ctx->device)
-    , m_dsv_descriptor_allocator(m_ctx->dsv_descriptor_heap, m_ctx->device)
+    , m_cbv_srv_uav_descriptor_allocator(m_ctx->cbv_srv_uav_descriptor_heap, m_ctx->device, 0)
+    , m_sampler_descriptor_allocator(m_ctx->sampler_descriptor_heap, m_ctx->device,
+        D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE)
+    , m_rtv_descriptor_allocator(m_ctx->rtv_descriptor_heap, m_ctx->device, MAX_RTV_DSV_DESCRIPTORS)
+    , m_dsv_descriptor_allocator(m_ctx->dsv_descriptor_heap, m_ctx->device, MAX_RTV_DSV_DESCRIPTORS)
+    , m_gpu_heap_allocator(m_ctx->device)
+    , m_small_buffer_mutex()
+    , m_small_buffer_allocator(SMALL_BUFFER_ARENA_SIZE)
+    , m_small_buffer_arenas()
+    , m_deletion_ring(deletion_ring_size)
 {
     throw_if_failed(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&m_dxc_utils)),
         "Failed to create DxcUtils.");
 }
 
+Resource_Manager::~Resource_Manager()
+{
+    for (uint32_t arena = 0; arena < uint32_t(m_small_buffer_arenas.size()); ++arena)
+    {
+        if (m_small_buffer_arenas[arena].resource)
+        {
+            release_small_buffer_arena(arena);
+        }
+    }
+}
+
 Buffer_Handle Resource_Manager::create_buffer(const Buffer_Desc & desc, const wchar_t* name)
 {
-    Buffer buffer = {};
+    if (desc.suballocate &&
+        desc.heap_type == D3D12_HEAP_TYPE_DEFAULT &&
+        desc.size <= MAX_SMALL_BUFFER_SIZE)
+    {
+        return create_small_buffer(desc, name);
+    }
+
+    Buffer buffer = {
+        .resource = nullptr,
+        .size = desc.size,
+        .offset = 0,
+        .descriptor_allocation = INDEX_RANGE_NO_ALLOCATION
+    };
 
     D3D12_RESOURCE_DESC1 resource_desc = {
         .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
@@ -51,94 +147,33 @@ Buffer_Handle Resource_Manager::create_buffer(const Buffer_Desc & desc, const wc
         .Flags = D3D12_RESOURCE_FLAG_NONE,
         .SamplerFeedbackMipRegion = {}
     };
-    D3D12_HEAP_PROPERTIES heap_properties = {
-        .Type = desc.heap_type,
-        .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-        .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-        .CreationNodeMask = 0,
-        .VisibleNodeMask = 0
-    };
     if (desc.usage == Resource_Usage::Read_Write)
     {
         resource_desc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
     }
-    m_ctx->device->CreateCommittedResource3(
-        &heap_properties, D3D12_HEAP_FLAG_NONE,
-        &resource_desc, D3D12_BARRIER_LAYOUT_UNDEFINED, nullptr,
-        nullptr, 0, nullptr, IID_PPV_ARGS(&buffer.resource));
+    auto gpu_resource = m_gpu_heap_allocator.create_resource(
+        desc.heap_type, resource_desc, D3D12_BARRIER_LAYOUT_UNDEFINED, nullptr);
+    buffer.resource = gpu_resource.resource;
     if (name)
     {
         buffer.resource->SetName(name);
     }
 
-    auto srv = m_cbv_srv_uav_descriptor_allocator.allocate();
-    D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc = {
-        .Format = DXGI_FORMAT_R32_TYPELESS,
-        .ViewDimension = D3D12_SRV_DIMENSION_BUFFER,
-        .Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
-        .Buffer = {
-            .FirstElement = 0,
-            .NumElements = uint32_t(desc.size) >> 2,
-            .StructureByteStride = 0,
-            .Flags = D3D12_BUFFER_SRV_FLAG_RAW
-        }
-    };
-    m_ctx->device->CreateShaderResourceView(buffer.resource, &srv_desc, srv.cpu_handle);
-
-    auto uav = m_cbv_srv_uav_descriptor_allocator.allocate();
-    if (desc.usage == Resource_Usage::Read_Write)
-    {
-        D3D12_UNORDERED_ACCESS_VIEW_DESC uav_desc = {
-            .Format = DXGI_FORMAT_R32_TYPELESS,
-            .ViewDimension = D3D12_UAV_DIMENSION_BUFFER,
-            .Buffer = {
-                .FirstElement = 0,
-                .NumElements = uint32_t(desc.size) >> 2,
-                .StructureByteStride = 0,
-                .CounterOffsetInBytes = 0,
-                .Flags = D3D12_BUFFER_UAV_FLAG_RAW
-            }
-        };
-        m_ctx->device->CreateUnorderedAccessView(buffer.resource, nullptr, &uav_desc, uav.cpu_handle);
-    }
+    auto descriptors = m_cbv_srv_uav_descriptor_allocator.allocate_range(get_buffer_descriptor_count(desc));
+    buffer.descriptor_allocation = descriptors.allocation;
+    create_buffer_views(buffer.resource, descriptors.index, desc.size, desc.usage);
 
-    return m_buffers.insert(0, srv.index, buffer);
+    Buffer_Memory memory = {
+        .heap_allocation = gpu_resource.allocation,
+        .suballocation = { .block = BLOCK_NO_ALLOCATION, .node = TLSF_NO_ALLOCATION, .offset = 0, .size = 0 },
+        .name = name ? name : L""
+    };
+    return m_buffers.insert(0, descriptors.index, buffer, memory);
 }
 
 Texture_Handle Resource_Manager::create_texture(const Texture_Desc& desc, const wchar_t* name)
 {
-    Texture texture = {};
-
-    D3D12_RESOURCE_DESC1 resource_desc = {
-        .Dimension = desc.dimension,
-        .Alignment = 0,
-        .Width = desc.width,
-        .Height = desc.height,
-        .DepthOrArraySize = uint16_t(desc.depth_or_array_layers),
-        .MipLevels = uint16_t(desc.mip_levels),
-        .Format = desc.format,
-        .SampleDesc = { .Count = 1, .Quality = 0 },
-        .Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN,
-        .Flags = D3D12_RESOURCE_FLAG_NONE,
-        .SamplerFeedbackMipRegion = {}
-    };
-    D3D12_HEAP_PROPERTIES heap_properties = {
-        .Type = D3D12_HEAP_TYPE_DEFAULT,
-        .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-        .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-        .CreationNodeMask = 0,
-        .VisibleNodeMask = 0
-    };
-
-    resource_desc.Flags |= desc.uav_dimension != D3D12_UAV_DIMENSION_UNKNOWN
-        ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
-        : D3D12_RESOURCE_FLAG_NONE;
-    resource_desc.Flags |= desc.rtv_dimension != D3D12_RTV_DIMENSION_UNKNOWN
-        ? D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET
-        : D3D12_RESOURCE_FLAG_NONE;
-    resource_desc.Flags |= desc.dsv_dimension != D3D12_DSV_DIMENSION_UNKNOWN
-        ? D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL
-        : D3D12_RESOURCE_FLAG_NONE;
+    auto resource_desc = get_texture_resource_desc(desc);
 
     bool clear_value_allowed = false;
     if ((resource_desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) ||
@@ -156,18 +191,95 @@ Texture_Handle Resource_Manager::create_texture(const Texture_Desc& desc, const
         clear_value_allowed = false;
     }
 
-    m_ctx->device->CreateCommittedResource3(
-        &heap_properties, D3D12_HEAP_FLAG_NONE,
-        &resource_desc, desc.initial_layout, clear_value_allowed ? &clear_value : nullptr,
-        nullptr, 0, nullptr, IID_PPV_ARGS(&texture.resource));
+    auto gpu_resource = m_gpu_heap_allocator.create_resource(
+        D3D12_HEAP_TYPE_DEFAULT, resource_desc, desc.initial_layout, clear_value_allowed ? &clear_value : nullptr);
     if (name)
     {
-        texture.resource->SetName(name);
+        gpu_resource.resource->SetName(name);
     }
+    return insert_texture(desc, gpu_resource, 0);
+}
+
+void Resource_Manager::create_transient_textures(
+    std::span<const Transient_Texture_Desc> descs, std::span<Texture_Handle> textures)
+{
+    std::vector<D3D12_RESOURCE_DESC1> resource_descs;
+    std::vector<Transient_Resource_Desc> transient_descs;
+    resource_descs.reserve(descs.size());
+    transient_descs.reserve(descs.size());
+    for (const auto& desc : descs)
+    {
+        auto& resource_desc = resource_descs.emplace_back(get_texture_resource_desc(desc.texture));
+        // Placed render targets and depth stencils would need a clear or discard on every aliasing acquire.
+        assert(!(resource_desc.Flags &
+            (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)));
+        auto allocation_info = m_ctx->device->GetResourceAllocationInfo2(0, 1, &resource_desc, nullptr);
+        transient_descs.push_back({
+            .size = allocation_info.SizeInBytes,
+            .alignment = allocation_info.Alignment,
+            .first_use = desc.first_use,
+            .last_use = desc.last_use
+        });
+    }
+    auto plan = plan_transient_resources(transient_descs);
+
+    D3D12_HEAP_DESC heap_desc = {
+        .SizeInBytes = (plan.heap_size + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1)
+            & ~uint64_t(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1),
+        .Properties = {
+            .Type = D3D12_HEAP_TYPE_DEFAULT,
+            .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+            .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
+            .CreationNodeMask = 0,
+            .VisibleNodeMask = 0
+        },
+        .Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
+        .Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES
+    };
+    Com_Ptr<ID3D12Heap> heap;
+    throw_if_failed(m_ctx->device->CreateHeap(&heap_desc, IID_PPV_ARGS(&heap)),
+        "Failed to create transient texture heap.");
+
+    // Placed resources keep their heap alive, so the heap is released together with the last texture.
+    for (uint32_t i = 0; i < uint32_t(descs.size()); ++i)
+    {
+        Gpu_Resource gpu_resource = {
+            .resource = nullptr,
+            .allocation = { .pool = GPU_HEAP_NO_POOL, .block_allocation = {} }
+        };
+        throw_if_failed(m_ctx->device->CreatePlacedResource2(
+            heap.Get(), plan.placements[i].offset, &resource_descs[i], descs[i].texture.initial_layout,
+            nullptr, 0, nullptr, IID_PPV_ARGS(&gpu_resource.resource)),
+            "Failed to create transient texture.");
+        if (descs[i].name)
+        {
+            gpu_resource.resource->SetName(descs[i].name);
+        }
+        textures[i] = insert_texture(descs[i].texture, gpu_resource,
+            plan.placements[i].is_aliased() ? TEXTURE_FLAG_ALIASED : 0);
+    }
+}
+
+Texture_Handle Resource_Manager::insert_texture(const Texture_Desc& desc, const Gpu_Resource& gpu_resource, uint8_t flags)
+{
+    Texture texture = {};
+    texture.resource = gpu_resource.resource;
+
+    Descriptor_Range descriptors = {
+        .index = NO_BINDLESS_IDX,
+        .count = 0,
+        .allocation = INDEX_RANGE_NO_ALLOCATION
+    };
+    auto descriptor_count = get_texture_descriptor_count(desc);
+    if (descriptor_count > 0)
+    {
+        descriptors = m_cbv_srv_uav_descriptor_allocator.allocate_range(descriptor_count);
+    }
+    texture.descriptor_allocation = descriptors.allocation;
 
-    auto srv = m_cbv_srv_uav_descriptor_allocator.allocate();
     if (desc.srv_dimension != D3D12_SRV_DIMENSION_UNKNOWN)
     {
+        auto srv = m_cbv_srv_uav_descriptor_allocator.get_descriptor(descriptors.index);
         D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc = {
             .Format = desc.format,
             .ViewDimension = desc.srv_dimension,
@@ -257,9 +369,9 @@ Texture_Handle Resource_Manager::create_texture(const Texture_Desc& desc, const
         m_ctx->device->CreateShaderResourceView(texture.resource, &srv_desc, srv.cpu_handle);
     }
 
-    auto uav = m_cbv_srv_uav_descriptor_allocator.allocate();
-    if (desc.uav_dimension != D3D12_UAV_DIMENSION_UNKNOWN)
+    for (uint32_t mip = 0; mip < get_texture_uav_count(desc); ++mip)
     {
+        auto uav = m_cbv_srv_uav_descriptor_allocator.get_descriptor(descriptors.index + 1 + mip);
         D3D12_UNORDERED_ACCESS_VIEW_DESC uav_desc = {
             .Format = desc.format,
             .ViewDimension = desc.uav_dimension,
@@ -268,24 +380,24 @@ Texture_Handle Resource_Manager::create_texture(const Texture_Desc& desc, const
         {
         case D3D12_UAV_DIMENSION_TEXTURE1D:
             uav_desc.Texture1D = {
-                .MipSlice = 0
+                .MipSlice = mip
             };
             break;
         case D3D12_UAV_DIMENSION_TEXTURE1DARRAY:
             uav_desc.Texture1DArray = {
-                .MipSlice = 0,
+                .MipSlice = mip,
                 .FirstArraySlice = 0,
                 .ArraySize = desc.depth_or_array_layers
             };
             break;
         case D3D12_UAV_DIMENSION_TEXTURE2D:
             uav_desc.Texture2D = {
-                .MipSlice = 0
+                .MipSlice = mip
             };
             break;
         case D3D12_UAV_DIMENSION_TEXTURE2DARRAY:
             uav_desc.Texture2DArray = {
-                .MipSlice = 0,
+                .MipSlice = mip,
                 .FirstArraySlice = 0,
                 .ArraySize = desc.depth_or_array_layers,
                 .PlaneSlice = 0
@@ -304,7 +416,7 @@ Texture_Handle Resource_Manager::create_texture(const Texture_Desc& desc, const
             break;
         case D3D12_UAV_DIMENSION_TEXTURE3D:
             uav_desc.Texture3D = {
-                .MipSlice = 0,
+                .MipSlice = mip,
                 .FirstWSlice = 0,
                 .WSize = ~0u
             };
@@ -426,7 +538,7 @@ Texture_Handle Resource_Manager::create_texture(const Texture_Desc& desc, const
         texture.dsv = dsv.index;
     }
 
-    return m_textures.insert(0, srv.index, texture);
+    return m_textures.insert(flags, descriptors.index, texture, gpu_resource.allocation);
 }
 
 Shader_Handle Resource_Manager::create_shader(const Shader_Desc& desc)
@@ -508,7 +620,7 @@ Pipeline_Handle Resource_Manager::create_pipeline(const Graphics_Pipeline_Desc&
         pipeline.pso->SetName(name);
     }
 
-    return m_pipelines.insert(0, 0, pipeline);
+    return m_pipelines.insert(0, 0, pipeline, Pipeline_Desc { .type = Pipeline_Type::Graphics, .graphics = desc });
 }
 
 Pipeline_Handle Resource_Manager::create_pipeline(const Compute_Pipeline_Desc& desc, const wchar_t* name)
@@ -537,7 +649,10 @@ Pipeline_Handle Resource_Manager::create_pipeline(const Compute_Pipeline_Desc& d
             .Size = shader.bytecode.size(),
             .Encoding = DXC_CP_ACP,
         };
-        m_dxc_utils->CreateReflection(&reflection_buffer, IID_PPV_ARGS(&shader_reflection));
+        {
+            std::scoped_lock lock(m_dxc_utils_mutex);
+            m_dxc_utils->CreateReflection(&reflection_buffer, IID_PPV_ARGS(&shader_reflection));
+        }
         shader_reflection->GetThreadGroupSize(
             &pipeline.workgroups_x, &pipeline.workgroups_y, &pipeline.workgroups_z);
     }
@@ -547,7 +662,7 @@ Pipeline_Handle Resource_Manager::create_pipeline(const Compute_Pipeline_Desc& d
         pipeline.pso->SetName(name);
     }
 
-    return m_pipelines.insert(0, 0, pipeline);
+    return m_pipelines.insert(0, 0, pipeline, Pipeline_Desc { .type = Pipeline_Type::Compute, .compute = desc });
 }
 
 Sampler_Handle Resource_Manager::create_sampler(const Sampler_Desc& desc)
@@ -561,12 +676,12 @@ Sampler_Handle Resource_Manager::create_sampler(const Sampler_Desc& desc)
 
 void Resource_Manager::destroy_buffer(Buffer_Handle handle, uint64_t frame)
 {
-    m_buffer_deletion_queue.push_back({ handle, frame });
+    m_deletion_ring.push<&Resource_Manager::retire_buffer>(frame, this, handle);
 }
 
 void Resource_Manager::destroy_texture(Texture_Handle handle, uint64_t frame)
 {
-    m_texture_deletion_queue.push_back({ handle, frame });
+    m_deletion_ring.push<&Resource_Manager::retire_texture>(frame, this, handle);
 }
 
 void Resource_Manager::destroy_shader(Shader_Handle handle)
@@ -576,17 +691,17 @@ void Resource_Manager::destroy_shader(Shader_Handle handle)
 
 void Resource_Manager::destroy_pipeline(Pipeline_Handle handle, uint64_t frame)
 {
-    m_pipeline_deletion_queue.push_back({ handle, frame });
+    m_deletion_ring.push<&Resource_Manager::retire_pipeline>(frame, this, handle);
 }
 
 void Resource_Manager::destroy_sampler(Sampler_Handle handle, uint64_t frame)
 {
-    m_sampler_deletion_queue.push_back({ handle, frame });
+    m_deletion_ring.push<&Resource_Manager::retire_sampler>(frame, this, handle);
 }
 
 void Resource_Manager::destroy_d3d12_resource_deferred(ID3D12Resource* resource, uint64_t frame)
 {
-    m_deferred_resource_deletion_queue.push_back({ resource, frame });
+    m_deletion_ring.push<&Resource_Manager::retire_d3d12_resource>(frame, this, resource);
 }
 
 const Buffer& Resource_Manager::get_buffer(Buffer_Handle handle) const
@@ -619,6 +734,16 @@ Pipeline& Resource_Manager::get_pipeline(Pipeline_Handle handle)
     return m_pipelines[handle];
 }
 
+const Pipeline_Desc& Resource_Manager::get_pipeline_desc(Pipeline_Handle handle) const
+{
+    return m_pipelines.cold_at(handle);
+}
+
+const std::wstring& Resource_Manager::get_buffer_name(Buffer_Handle handle) const
+{
+    return m_buffers.cold_at(handle).name;
+}
+
 const Shader& Resource_Manager::get_shader(Shader_Handle handle) const
 {
     return m_shaders.at(handle);
@@ -629,66 +754,190 @@ Shader& Resource_Manager::get_shader(Shader_Handle handle)
     return m_shaders[handle];
 }
 
+Descriptor_Heap_Occupancy Resource_Manager::get_descriptor_heap_occupancy() const
+{
+    return {
+        .cbv_srv_uav = m_cbv_srv_uav_descriptor_allocator.get_stats(),
+        .sampler = m_sampler_descriptor_allocator.get_stats(),
+        .rtv = m_rtv_descriptor_allocator.get_stats(),
+        .dsv = m_dsv_descriptor_allocator.get_stats()
+    };
+}
+
+Gpu_Heap_Stats Resource_Manager::get_gpu_heap_stats() const
+{
+    return m_gpu_heap_allocator.get_stats();
+}
+
 void Resource_Manager::empty_deletion_queues(uint64_t frame)
 {
-    auto buffer_range = std::ranges::remove_if(m_buffer_deletion_queue, [this, frame](auto& element) {
-        if (frame >= element.frame)
-        {
-            auto& buffer = m_buffers[element.resource];
-            buffer.resource->Release();
-            m_cbv_srv_uav_descriptor_allocator.free(uint32_t(element.resource.bindless_idx + 1));
-            m_cbv_srv_uav_descriptor_allocator.free(element.resource.bindless_idx);
-            m_buffers.remove(element.resource);
-            return true;
-        }
-        return false;
-        });
-    m_buffer_deletion_queue.erase(buffer_range.begin(), buffer_range.end());
+    m_deletion_ring.retire(frame);
+}
 
-    auto texture_range = std::ranges::remove_if(m_texture_deletion_queue, [this, frame](auto& element) {
-        if (frame >= element.frame)
-        {
-            auto& texture = m_textures[element.resource];
-            texture.resource->Release();
-            m_cbv_srv_uav_descriptor_allocator.free(uint32_t(element.resource.bindless_idx + 1));
-            m_cbv_srv_uav_descriptor_allocator.free(element.resource.bindless_idx);
-            m_textures.remove(element.resource);
-            return true;
-        }
-        return false;
-        });
-    m_texture_deletion_queue.erase(texture_range.begin(), texture_range.end());
+void Resource_Manager::empty_all_deletion_queues()
+{
+    m_deletion_ring.retire_all();
+}
 
-    auto pipeline_range = std::ranges::remove_if(m_pipeline_deletion_queue, [this, frame](auto& element) {
-        if (frame >= element.frame)
-        {
-            auto& pso = m_pipelines[element.resource];
-            pso.pso->Release();
-            m_pipelines.remove(element.resource);
-            return true;
+void Resource_Manager::create_buffer_views(
+    ID3D12Resource2* resource, uint32_t descriptor_index, uint64_t size, Resource_Usage usage)
+{
+    auto srv = m_cbv_srv_uav_descriptor_allocator.get_descriptor(descriptor_index);
+    D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc = {
+        .Format = DXGI_FORMAT_R32_TYPELESS,
+        .ViewDimension = D3D12_SRV_DIMENSION_BUFFER,
+        .Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
+        .Buffer = {
+            .FirstElement = 0,
+            .NumElements = uint32_t(size) >> 2,
+            .StructureByteStride = 0,
+            .Flags = D3D12_BUFFER_SRV_FLAG_RAW
         }
-        return false;
-        });
-    m_pipeline_deletion_queue.erase(pipeline_range.begin(), pipeline_range.end());
+    };
+    m_ctx->device->CreateShaderResourceView(resource, &srv_desc, srv.cpu_handle);
 
-    auto sampler_range = std::ranges::remove_if(m_sampler_deletion_queue, [this, frame](auto& element) {
-        if (frame >= element.frame)
-        {
-            m_sampler_descriptor_allocator.free(element.resource.bindless_idx);
-            return true;
-        }
-        return false;
-        });
-    m_sampler_deletion_queue.erase(sampler_range.begin(), sampler_range.end());
+    if (usage == Resource_Usage::Read_Write)
+    {
+        auto uav = m_cbv_srv_uav_descriptor_allocator.get_descriptor(descriptor_index + 1);
+        D3D12_UNORDERED_ACCESS_VIEW_DESC uav_desc = {
+            .Format = DXGI_FORMAT_R32_TYPELESS,
+            .ViewDimension = D3D12_UAV_DIMENSION_BUFFER,
+            .Buffer = {
+                .FirstElement = 0,
+                .NumElements = uint32_t(size) >> 2,
+                .StructureByteStride = 0,
+                .CounterOffsetInBytes = 0,
+                .Flags = D3D12_BUFFER_UAV_FLAG_RAW
+            }
+        };
+        m_ctx->device->CreateUnorderedAccessView(resource, nullptr, &uav_desc, uav.cpu_handle);
+    }
+}
+
+// Small buffers live inside shared arenas which are read-write so they can back both usages.
+// Barriers on a suballocated buffer apply to its whole arena.
+Buffer_Handle Resource_Manager::create_small_buffer(const Buffer_Desc& desc, const wchar_t* name)
+{
+    std::scoped_lock lock(m_small_buffer_mutex);
+    auto suballocation = m_small_buffer_allocator.allocate(desc.size, SMALL_BUFFER_ALIGNMENT);
+    if (!suballocation.is_valid())
+    {
+        create_small_buffer_arena(m_small_buffer_allocator.add_block());
+        suballocation = m_small_buffer_allocator.allocate(desc.size, SMALL_BUFFER_ALIGNMENT);
+    }
+
+    const auto& arena = m_small_buffer_arenas[suballocation.block];
+    Buffer buffer = {
+        .resource = arena.resource,
+        .size = desc.size,
+        .offset = uint32_t(suballocation.offset),
+        .descriptor_allocation = INDEX_RANGE_NO_ALLOCATION
+    };
+    Buffer_Memory memory = {
+        .heap_allocation = { .pool = GPU_HEAP_NO_POOL, .block_allocation = {} },
+        .suballocation = suballocation,
+        .name = name ? name : L""
+    };
+    return m_buffers.insert(0, arena.descriptors.index, buffer, memory);
+}
+
+void Resource_Manager::create_small_buffer_arena(uint32_t arena)
+{
+    if (arena >= m_small_buffer_arenas.size())
+    {
+        m_small_buffer_arenas.resize(arena + 1);
+    }
+
+    D3D12_RESOURCE_DESC1 resource_desc = {
+        .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+        .Alignment = 0,
+        .Width = SMALL_BUFFER_ARENA_SIZE,
+        .Height = 1,
+        .DepthOrArraySize = 1,
+        .MipLevels = 1,
+        .Format = DXGI_FORMAT_UNKNOWN,
+        .SampleDesc = {.Count = 1, .Quality = 0 },
+        .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
+        .Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
+        .SamplerFeedbackMipRegion = {}
+    };
+    auto gpu_resource = m_gpu_heap_allocator.create_resource(
+        D3D12_HEAP_TYPE_DEFAULT, resource_desc, D3D12_BARRIER_LAYOUT_UNDEFINED, nullptr);
+    gpu_resource.resource->SetName(L"Buffer:Small_Buffer_Arena");
+
+    auto descriptors = m_cbv_srv_uav_descriptor_allocator.allocate_range(2);
+    create_buffer_views(gpu_resource.resource, descriptors.index, SMALL_BUFFER_ARENA_SIZE, Resource_Usage::Read_Write);
 
-    auto resource_range = std::ranges::remove_if(m_deferred_resource_deletion_queue, [this, frame](auto& element) {
-        if (frame >= element.frame)
+    m_small_buffer_arenas[arena] = {
+        .resource = gpu_resource.resource,
+        .heap_allocation = gpu_resource.allocation,
+        .descriptors = descriptors
+    };
+}
+
+void Resource_Manager::release_small_buffer_arena(uint32_t arena)
+{
+    auto& small_buffer_arena = m_small_buffer_arenas[arena];
+    small_buffer_arena.resource->Release();
+    m_gpu_heap_allocator.free(small_buffer_arena.heap_allocation);
+    m_cbv_srv_uav_descriptor_allocator.free_range(small_buffer_arena.descriptors.allocation);
+    small_buffer_arena = {};
+}
+
+void Resource_Manager::retire_buffer(Buffer_Handle handle)
+{
+    auto& buffer = m_buffers[handle];
+    auto& memory = m_buffers.cold(handle);
+    if (memory.suballocation.is_valid())
+    {
+        std::scoped_lock lock(m_small_buffer_mutex);
+        if (m_small_buffer_allocator.free(memory.suballocation))
         {
-            element.resource->Release();
-            return true;
+            release_small_buffer_arena(memory.suballocation.block);
+            m_small_buffer_allocator.remove_block(memory.suballocation.block);
         }
-        return false;
-        });
-    m_deferred_resource_deletion_queue.erase(resource_range.begin(), resource_range.end());
+    }
+    else
+    {
+        buffer.resource->Release();
+        m_gpu_heap_allocator.free(memory.heap_allocation);
+        m_cbv_srv_uav_descriptor_allocator.free_range(buffer.descriptor_allocation);
+    }
+    m_buffers.remove(handle);
+}
+
+void Resource_Manager::retire_texture(Texture_Handle handle)
+{
+    auto& texture = m_textures[handle];
+    texture.resource->Release();
+    m_gpu_heap_allocator.free(m_textures.cold(handle));
+    m_cbv_srv_uav_descriptor_allocator.free_range(texture.descriptor_allocation);
+    if (texture.rtv != NO_RTV_DSV)
+    {
+        m_rtv_descriptor_allocator.free(texture.rtv);
+    }
+    if (texture.dsv != NO_RTV_DSV)
+    {
+        m_dsv_descriptor_allocator.free(texture.dsv);
+    }
+    m_textures.remove(handle);
+}
+
+void Resource_Manager::retire_pipeline(Pipeline_Handle handle)
+{
+    auto& pso = m_pipelines[handle];
+    pso.pso->Release();
+    m_pipelines.remove(handle);
+}
+
+void Resource_Manager::retire_sampler(Sampler_Handle handle)
+{
+    m_sampler_descriptor_allocator.free(handle.get_bindless_idx());
+    m_samplers.remove(handle);
+}
+
+void Resource_Manager::retire_d3d12_resource(Resource_Manager*, ID3D12Resource* resource)
+{
+    resource->Release();
 }
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "owge_render_engine/deletion_ring.hpp"
+#include "owge_render_engine/gpu_heap_allocator.hpp"
 #include "owge_render_engine/resource.hpp"
 #include "owge_render_engine/resource_allocator.hpp"
 
@@ -7,18 +9,45 @@
 #include "owge_d3d12_base/d3d12_util.hpp"
 
 #include <dxcapi.h>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
 
 namespace owge
 {
 struct D3D12_Context;
 
+struct Descriptor_Heap_Occupancy
+{
+    Descriptor_Allocator_Stats cbv_srv_uav;
+    Descriptor_Allocator_Stats sampler;
+    Descriptor_Allocator_Stats rtv;
+    Descriptor_Allocator_Stats dsv;
+};
+
+struct Buffer_Memory
+{
+    Gpu_Heap_Allocation heap_allocation;
+    Block_Allocation suballocation;
+    // Suballocated buffers share their arena's resource, so their name is only kept here.
+    std::wstring name;
+};
+
+// Resource creation and destruction may be called from multiple threads.
 class Resource_Manager
 {
 public:
-    Resource_Manager(D3D12_Context* ctx);
+    Resource_Manager(D3D12_Context* ctx, uint32_t deletion_ring_size);
+    ~Resource_Manager();
+
+    Resource_Manager(const Resource_Manager&) = delete;
+    Resource_Manager& operator=(const Resource_Manager&) = delete;
 
     [[nodiscard]] Buffer_Handle create_buffer(const Buffer_Desc& desc, const wchar_t* name = nullptr);
     [[nodiscard]] Texture_Handle create_texture(const Texture_Desc& desc, const wchar_t* name = nullptr);
+    // Places all textures in one heap, reusing memory between textures whose lifetimes don't overlap.
+    void create_transient_textures(std::span<const Transient_Texture_Desc> descs, std::span<Texture_Handle> textures);
     [[nodiscard]] Shader_Handle create_shader(const Shader_Desc& desc);
     [[nodiscard]] Pipeline_Handle create_pipeline(const Graphics_Pipeline_Desc& desc, const wchar_t* name = nullptr);
     [[nodiscard]] Pipeline_Handle create_pipeline(const Compute_Pipeline_Desc& desc, const wchar_t* name = nullptr);
@@ -37,17 +66,44 @@ public:
     [[nodiscard]] Texture& get_texture(Texture_Handle handle);
     [[nodiscard]] const Pipeline& get_pipeline(Pipeline_Handle handle) const;
     [[nodiscard]] Pipeline& get_pipeline(Pipeline_Handle handle);
+    [[nodiscard]] const Pipeline_Desc& get_pipeline_desc(Pipeline_Handle handle) const;
+    // Empty if the buffer was created without a name.
+    [[nodiscard]] const std::wstring& get_buffer_name(Buffer_Handle handle) const;
     [[nodiscard]] const Shader& get_shader(Shader_Handle handle) const;
     [[nodiscard]] Shader& get_shader(Shader_Handle handle);
 
+    [[nodiscard]] Descriptor_Heap_Occupancy get_descriptor_heap_occupancy() const;
+    [[nodiscard]] Gpu_Heap_Stats get_gpu_heap_stats() const;
+
     void empty_deletion_queues(uint64_t frame);
+    void empty_all_deletion_queues();
+
+private:
+    struct Small_Buffer_Arena
+    {
+        ID3D12Resource2* resource;
+        Gpu_Heap_Allocation heap_allocation;
+        Descriptor_Range descriptors;
+    };
+
+    [[nodiscard]] Texture_Handle insert_texture(const Texture_Desc& desc, const Gpu_Resource& gpu_resource, uint8_t flags);
+    void create_buffer_views(ID3D12Resource2* resource, uint32_t descriptor_index, uint64_t size, Resource_Usage usage);
+    [[nodiscard]] Buffer_Handle create_small_buffer(const Buffer_Desc& desc, const wchar_t* name);
+    void create_small_buffer_arena(uint32_t arena);
+    void release_small_buffer_arena(uint32_t arena);
+
+    void retire_buffer(Buffer_Handle handle);
+    void retire_texture(Texture_Handle handle);
+    void retire_pipeline(Pipeline_Handle handle);
+    void retire_sampler(Sampler_Handle handle);
+    static void retire_d3d12_resource(Resource_Manager*, ID3D12Resource* resource);
 
 private:
     D3D12_Context* m_ctx;
 
-    Resource_Allocator<Buffer> m_buffers;
-    Resource_Allocator<Texture> m_textures;
-    Resource_Allocator<Pipeline> m_pipelines;
+    Resource_Allocator<Buffer, Buffer_Memory> m_buffers;
+    Resource_Allocator<Texture, Gpu_Heap_Allocation> m_textures;
+    Resource_Allocator<Pipeline, Pipeline_Desc> m_pipelines;
     Resource_Allocator<Shader> m_shaders;
     Resource_Allocator<Sampler> m_samplers;
 
@@ -56,18 +112,15 @@ private:
     Descriptor_Allocator m_rtv_descriptor_allocator;
     Descriptor_Allocator m_dsv_descriptor_allocator;
 
-    template<typename T>
-    struct Deletion_Queue_Resource
-    {
-        T resource;
-        uint64_t frame;
-    };
-    std::vector<Deletion_Queue_Resource<Buffer_Handle>> m_buffer_deletion_queue;
-    std::vector<Deletion_Queue_Resource<Texture_Handle>> m_texture_deletion_queue;
-    std::vector<Deletion_Queue_Resource<Pipeline_Handle>> m_pipeline_deletion_queue;
-    std::vector<Deletion_Queue_Resource<Sampler_Handle>> m_sampler_deletion_queue;
-    std::vector<Deletion_Queue_Resource<ID3D12Resource*>> m_deferred_resource_deletion_queue;
+    Gpu_Heap_Allocator m_gpu_heap_allocator;
+
+    std::mutex m_small_buffer_mutex;
+    Block_Allocator m_small_buffer_allocator;
+    std::vector<Small_Buffer_Arena> m_small_buffer_arenas;
+
+    Deletion_Ring m_deletion_ring;
 
+    std::mutex m_dxc_utils_mutex;
     Com_Ptr<IDxcUtils> m_dxc_utils;
 };
 }
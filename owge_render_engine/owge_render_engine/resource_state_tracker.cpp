@@ -0,0 +1,169 @@
+#include "owge_render_engine/resource_state_tracker.hpp"
+
+#include <cassert>
+
+namespace owge
+{
+[[nodiscard]] static uint32_t get_format_plane_count(DXGI_FORMAT format)
+{
+    switch (format)
+    {
+    case DXGI_FORMAT_R24G8_TYPELESS:
+    case DXGI_FORMAT_D24_UNORM_S8_UINT:
+    case DXGI_FORMAT_R32G8X24_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+static constexpr Texture_State UNKNOWN_TEXTURE_STATE = {
+    .sync = D3D12_BARRIER_SYNC_NONE,
+    .access = D3D12_BARRIER_ACCESS_NO_ACCESS,
+    .layout = D3D12_BARRIER_LAYOUT_UNDEFINED,
+    .queue = D3D12_COMMAND_LIST_TYPE_NONE
+};
+
+static constexpr Buffer_State UNKNOWN_BUFFER_STATE = {
+    .sync = D3D12_BARRIER_SYNC_NONE,
+    .access = D3D12_BARRIER_ACCESS_NO_ACCESS,
+    .queue = D3D12_COMMAND_LIST_TYPE_NONE
+};
+
+Resource_State_Tracker::Resource_State_Tracker(Resource_State_Tracker* parent)
+    : m_parent(parent)
+{}
+
+void Resource_State_Tracker::track_texture(Texture_Handle handle, ID3D12Resource2* resource,
+    D3D12_BARRIER_LAYOUT initial_layout)
+{
+    assert(!is_local());
+    auto desc = resource->GetDesc1();
+    std::lock_guard lock(m_mutex);
+    if (handle.resource_idx >= m_textures.size())
+    {
+        m_textures.resize(handle.resource_idx + 1);
+    }
+    auto& entry = m_textures[handle.resource_idx];
+    entry.layout = {
+        .mip_levels = desc.MipLevels,
+        .array_layers = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1u : uint32_t(desc.DepthOrArraySize),
+        .planes = get_format_plane_count(desc.Format)
+    };
+    entry.states.assign(entry.layout.subresource_count(), {
+        .sync = D3D12_BARRIER_SYNC_NONE,
+        .access = D3D12_BARRIER_ACCESS_NO_ACCESS,
+        .layout = initial_layout,
+        .queue = D3D12_COMMAND_LIST_TYPE_DIRECT
+    });
+}
+
+void Resource_State_Tracker::track_buffer(Buffer_Handle handle)
+{
+    assert(!is_local());
+    std::lock_guard lock(m_mutex);
+    if (handle.resource_idx >= m_buffers.size())
+    {
+        m_buffers.resize(handle.resource_idx + 1);
+    }
+    // COMMON with no sync marks a buffer that wasn't used through a barrier yet.
+    m_buffers[handle.resource_idx].state = {
+        .sync = D3D12_BARRIER_SYNC_NONE,
+        .access = D3D12_BARRIER_ACCESS_COMMON,
+        .queue = D3D12_COMMAND_LIST_TYPE_DIRECT
+    };
+}
+
+std::span<Texture_State> Resource_State_Tracker::get_texture_states(Texture_Handle handle)
+{
+    return get_texture_entry(handle).states;
+}
+
+const Texture_Subresource_Layout& Resource_State_Tracker::get_texture_subresource_layout(Texture_Handle handle)
+{
+    return get_texture_entry(handle).layout;
+}
+
+Buffer_State& Resource_State_Tracker::get_buffer_state(Buffer_Handle handle)
+{
+    return get_buffer_entry(handle).state;
+}
+
+std::span<Texture_Requirement> Resource_State_Tracker::get_texture_requirements(Texture_Handle handle)
+{
+    assert(is_local());
+    return get_texture_entry(handle).requirements;
+}
+
+Buffer_Requirement& Resource_State_Tracker::get_buffer_requirement(Buffer_Handle handle)
+{
+    assert(is_local());
+    return get_buffer_entry(handle).requirement;
+}
+
+void Resource_State_Tracker::clear()
+{
+    assert(is_local());
+    for (auto texture : m_used_textures)
+    {
+        auto& entry = m_textures[texture.resource_idx];
+        entry.states.clear();
+        entry.requirements.clear();
+    }
+    for (auto buffer : m_used_buffers)
+    {
+        m_buffers[buffer.resource_idx].used = false;
+    }
+    m_used_textures.clear();
+    m_used_buffers.clear();
+}
+
+Resource_State_Tracker::Texture_Entry& Resource_State_Tracker::get_texture_entry(Texture_Handle handle)
+{
+    if (!is_local())
+    {
+        std::lock_guard lock(m_mutex);
+        assert(handle.resource_idx < m_textures.size());
+        return m_textures[handle.resource_idx];
+    }
+    if (handle.resource_idx >= m_textures.size())
+    {
+        m_textures.resize(handle.resource_idx + 1);
+    }
+    auto& entry = m_textures[handle.resource_idx];
+    if (entry.states.empty())
+    {
+        entry.layout = m_parent->get_texture_subresource_layout(handle);
+        entry.states.assign(entry.layout.subresource_count(), UNKNOWN_TEXTURE_STATE);
+        entry.requirements.assign(entry.layout.subresource_count(), {});
+        m_used_textures.push_back(handle);
+    }
+    return entry;
+}
+
+Resource_State_Tracker::Buffer_Entry& Resource_State_Tracker::get_buffer_entry(Buffer_Handle handle)
+{
+    if (!is_local())
+    {
+        std::lock_guard lock(m_mutex);
+        assert(handle.resource_idx < m_buffers.size());
+        return m_buffers[handle.resource_idx];
+    }
+    if (handle.resource_idx >= m_buffers.size())
+    {
+        m_buffers.resize(handle.resource_idx + 1);
+    }
+    auto& entry = m_buffers[handle.resource_idx];
+    if (!entry.used)
+    {
+        entry = {
+            .used = true,
+            .state = UNKNOWN_BUFFER_STATE,
+            .requirement = {}
+        };
+        m_used_buffers.push_back(handle);
+    }
+    return entry;
+}
+}
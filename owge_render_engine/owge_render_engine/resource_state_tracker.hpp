@@ -0,0 +1,129 @@
+#pragma once
+
+#include "owge_render_engine/resource.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <include/d3d12.h>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace owge
+{
+// Last known state of a texture subresource or buffer, `queue` is the command list type it was last accessed on.
+// Local trackers start out with the NONE queue, which marks a state that isn't known yet.
+struct Texture_State
+{
+    D3D12_BARRIER_SYNC sync;
+    D3D12_BARRIER_ACCESS access;
+    D3D12_BARRIER_LAYOUT layout;
+    D3D12_COMMAND_LIST_TYPE queue;
+};
+
+struct Buffer_State
+{
+    D3D12_BARRIER_SYNC sync;
+    D3D12_BARRIER_ACCESS access;
+    D3D12_COMMAND_LIST_TYPE queue;
+};
+
+// State the first use of a resource in a local tracker expects the previous command lists to leave it in.
+struct Texture_Requirement
+{
+    bool required;
+    bool discard;
+    D3D12_BARRIER_SYNC sync;
+    D3D12_BARRIER_ACCESS access;
+    D3D12_BARRIER_LAYOUT layout;
+};
+
+struct Buffer_Requirement
+{
+    bool required;
+    D3D12_BARRIER_SYNC sync;
+    D3D12_BARRIER_ACCESS access;
+};
+
+struct Texture_Subresource_Layout
+{
+    uint32_t mip_levels;
+    uint32_t array_layers;
+    uint32_t planes;
+
+    [[nodiscard]] uint32_t subresource_count() const
+    {
+        return mip_levels * array_layers * planes;
+    }
+    [[nodiscard]] uint32_t get_subresource(uint32_t mip, uint32_t array_layer, uint32_t plane) const
+    {
+        return mip + array_layer * mip_levels + plane * mip_levels * array_layers;
+    }
+};
+
+// Tracks the state every texture subresource and buffer was left in by the barriers recorded so far,
+// in submission order. Slots are indexed by the handle's resource index and reset when a resource is created.
+// Resources may be tracked from multiple threads, their states may only be used by one thread at a time.
+//
+// A local tracker belongs to a command list recorded in parallel with others. It knows nothing about the
+// states the preceding command lists leave resources in, so the first use of a resource records a requirement
+// instead of a barrier. See `Barrier_Builder::resolve`.
+class Resource_State_Tracker
+{
+public:
+    Resource_State_Tracker() = default;
+    explicit Resource_State_Tracker(Resource_State_Tracker* parent);
+
+    // The subresource layout is read from the created resource, a Texture_Desc may leave the mip count at 0
+    // for a full chain.
+    void track_texture(Texture_Handle handle, ID3D12Resource2* resource, D3D12_BARRIER_LAYOUT initial_layout);
+    void track_buffer(Buffer_Handle handle);
+
+    [[nodiscard]] std::span<Texture_State> get_texture_states(Texture_Handle handle);
+    [[nodiscard]] const Texture_Subresource_Layout& get_texture_subresource_layout(Texture_Handle handle);
+    [[nodiscard]] Buffer_State& get_buffer_state(Buffer_Handle handle);
+
+    [[nodiscard]] bool is_local() const
+    {
+        return m_parent != nullptr;
+    }
+    // Local trackers only.
+    [[nodiscard]] std::span<Texture_Requirement> get_texture_requirements(Texture_Handle handle);
+    [[nodiscard]] Buffer_Requirement& get_buffer_requirement(Buffer_Handle handle);
+    [[nodiscard]] std::span<const Texture_Handle> get_used_textures() const
+    {
+        return m_used_textures;
+    }
+    [[nodiscard]] std::span<const Buffer_Handle> get_used_buffers() const
+    {
+        return m_used_buffers;
+    }
+    void clear();
+
+private:
+    struct Texture_Entry
+    {
+        Texture_Subresource_Layout layout;
+        std::vector<Texture_State> states;
+        std::vector<Texture_Requirement> requirements;
+    };
+    struct Buffer_Entry
+    {
+        bool used;
+        Buffer_State state;
+        Buffer_Requirement requirement;
+    };
+
+    [[nodiscard]] Texture_Entry& get_texture_entry(Texture_Handle handle);
+    [[nodiscard]] Buffer_Entry& get_buffer_entry(Buffer_Handle handle);
+
+private:
+    Resource_State_Tracker* m_parent = nullptr;
+    // Deques keep references to existing entries valid while other threads track new resources.
+    std::deque<Texture_Entry> m_textures;
+    std::deque<Buffer_Entry> m_buffers;
+    std::vector<Texture_Handle> m_used_textures;
+    std::vector<Buffer_Handle> m_used_buffers;
+    std::mutex m_mutex;
+};
+}
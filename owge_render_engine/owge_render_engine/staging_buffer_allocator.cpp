@@ -1,15 +1,77 @@
 #include "owge_render_engine/staging_buffer_allocator.hpp"
 #include "owge_render_engine/render_engine.hpp"
 
+#include <algorithm>
+
 namespace owge
 {
-static constexpr uint64_t DEFAULT_BUFFER_SIZE = 16777216; // 16 MB // TODO: make value customizable?
+static constexpr uint64_t DEFAULT_RING_SIZE = 16777216; // 16 MB
+static constexpr uint64_t MAX_RING_SIZE = 268435456; // 256 MB
+// Keeps dword sized data contiguous, so consecutive uploads can be merged into one copy.
+static constexpr uint64_t MIN_ALIGNMENT = 4;
 
 Staging_Buffer_Allocator::Staging_Buffer_Allocator(ID3D12Device10* device, Render_Engine* render_engine)
-    : m_render_engine(render_engine), m_device(device)
-{}
+    : m_render_engine(render_engine), m_device(device), m_ring(DEFAULT_RING_SIZE)
+{
+    m_resource = create_upload_buffer(DEFAULT_RING_SIZE, L"Buffer:Staging:Upload_Ring", &m_mapped_data);
+}
 
 Staging_Buffer_Allocation Staging_Buffer_Allocator::allocate(uint64_t size, uint64_t alignment)
+{
+    alignment = std::max(alignment, MIN_ALIGNMENT);
+    auto offset = m_ring.allocate(size, alignment);
+    if (offset == FENCE_RING_NO_ALLOCATION && size <= m_ring.capacity() / 2 && m_ring.capacity() < MAX_RING_SIZE)
+    {
+        // The ring is full of in-flight data, grow it. The old buffer stays alive until its frames retired.
+        replace_ring(m_ring.capacity() * 2);
+        offset = m_ring.allocate(size, alignment);
+    }
+    if (offset != FENCE_RING_NO_ALLOCATION)
+    {
+        return {
+            .resource = m_resource,
+            .offset = offset,
+            .data = m_mapped_data
+        };
+    }
+
+    // Oversized requests get a dedicated buffer that is destroyed once the current frame retired.
+    void* mapped_data = nullptr;
+    auto resource = create_upload_buffer(size, L"Buffer:Staging:Large_Upload_Buffer", &mapped_data);
+    m_render_engine->destroy_d3d12_resource_deferred(resource);
+    return {
+        .resource = resource,
+        .offset = 0,
+        .data = mapped_data
+    };
+}
+
+void Staging_Buffer_Allocator::submit(uint64_t frame)
+{
+    m_ring.submit(frame);
+    auto capacity = m_ring.get_shrink_capacity(DEFAULT_RING_SIZE);
+    if (capacity < m_ring.capacity())
+    {
+        replace_ring(capacity);
+    }
+}
+
+void Staging_Buffer_Allocator::reclaim(uint64_t retired_frame)
+{
+    m_ring.reclaim(retired_frame);
+}
+
+void Staging_Buffer_Allocator::release_resources()
+{
+    if (m_resource)
+    {
+        m_render_engine->destroy_d3d12_resource_deferred(m_resource);
+        m_resource = nullptr;
+        m_mapped_data = nullptr;
+    }
+}
+
+ID3D12Resource* Staging_Buffer_Allocator::create_upload_buffer(uint64_t size, const wchar_t* name, void** mapped_data)
 {
     D3D12_HEAP_PROPERTIES heap_properties = {
         .Type = D3D12_HEAP_TYPE_UPLOAD,
@@ -21,7 +83,7 @@ Staging_Buffer_Allocation Staging_Buffer_Allocator::allocate(uint64_t size, uint
     D3D12_RESOURCE_DESC1 resource_desc = {
         .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
         .Alignment = 0,
-        .Width = DEFAULT_BUFFER_SIZE,
+        .Width = size,
         .Height = 1,
         .DepthOrArraySize = 1,
         .MipLevels = 1,
@@ -31,53 +93,21 @@ Staging_Buffer_Allocation Staging_Buffer_Allocator::allocate(uint64_t size, uint
         .Flags = D3D12_RESOURCE_FLAG_NONE,
         .SamplerFeedbackMipRegion = {}
     };
-
-    if (size > DEFAULT_BUFFER_SIZE) // Handle overallocation
-    {
-        resource_desc.Width = size;
-        void* mapped_data = nullptr;
-        auto& new_resource = m_resources.emplace_back();
-        m_device->CreateCommittedResource3(
-            &heap_properties, D3D12_HEAP_FLAG_NONE,
-            &resource_desc, D3D12_BARRIER_LAYOUT_UNDEFINED,
-            nullptr, nullptr, 0, nullptr, IID_PPV_ARGS(&new_resource));
-        new_resource->SetName(L"Buffer:Staging:Large_Upload_Buffer");
-        new_resource->Map(0, nullptr, &mapped_data);
-        return {
-            .resource = new_resource,
-            .offset = 0,
-            .data = mapped_data
-        };
-    }
-    if (m_current_resource == nullptr || m_current_offset + size > DEFAULT_BUFFER_SIZE)
-    {
-        auto& new_resource = m_resources.emplace_back();
-        m_device->CreateCommittedResource3(
-            &heap_properties, D3D12_HEAP_FLAG_NONE,
-            &resource_desc, D3D12_BARRIER_LAYOUT_UNDEFINED,
-            nullptr, nullptr, 0, nullptr, IID_PPV_ARGS(&new_resource));
-        new_resource->SetName(L"Buffer:Staging:Small_Upload_Buffer");
-        new_resource->Map(0, nullptr, &m_mapped_data);
-        m_current_offset = 0;
-        m_current_resource = new_resource;
-    }
-    Staging_Buffer_Allocation allocation = {
-        .resource = m_current_resource,
-        .offset = m_current_offset,
-        .data = m_mapped_data
-    };
-    m_current_offset += size; // TODO: align.
-    alignment;
-    return allocation;
+    ID3D12Resource* resource = nullptr;
+    m_device->CreateCommittedResource3(
+        &heap_properties, D3D12_HEAP_FLAG_NONE,
+        &resource_desc, D3D12_BARRIER_LAYOUT_UNDEFINED,
+        nullptr, nullptr, 0, nullptr, IID_PPV_ARGS(&resource));
+    resource->SetName(name);
+    // Upload heaps stay mapped for their whole lifetime.
+    resource->Map(0, nullptr, mapped_data);
+    return resource;
 }
 
-void Staging_Buffer_Allocator::reset()
+void Staging_Buffer_Allocator::replace_ring(uint64_t capacity)
 {
-    for (auto resource : m_resources)
-    {
-        m_render_engine->destroy_d3d12_resource_deferred(resource);
-    }
-    m_resources.clear();
-    m_current_resource = nullptr;
+    release_resources();
+    m_resource = create_upload_buffer(capacity, L"Buffer:Staging:Upload_Ring", &m_mapped_data);
+    m_ring.reset(capacity);
 }
 }
@@ -1,7 +1,8 @@
 #pragma once
 
+#include <owge_common/fence_ring_allocator.hpp>
+
 #include <include/d3d12.h>
-#include <vector>
 
 namespace owge
 {
@@ -14,20 +15,28 @@ struct Staging_Buffer_Allocation
 
 class Render_Engine;
 
+// Persistently mapped upload ring. Space is handed back once the frame that used it has retired,
+// the ring grows when it runs full and shrinks again after a period of low usage.
 class Staging_Buffer_Allocator
 {
 public:
     Staging_Buffer_Allocator(ID3D12Device10* device, Render_Engine* render_engine);
 
     [[nodiscard]] Staging_Buffer_Allocation allocate(uint64_t size, uint64_t alignment = 0);
-    void reset();
+    // Allocations made since the last submit are reclaimed once `frame` has been retired.
+    void submit(uint64_t frame);
+    void reclaim(uint64_t retired_frame);
+    void release_resources();
+
+private:
+    [[nodiscard]] ID3D12Resource* create_upload_buffer(uint64_t size, const wchar_t* name, void** mapped_data);
+    void replace_ring(uint64_t capacity);
 
 private:
     Render_Engine* m_render_engine;
     ID3D12Device10* m_device;
-    uint64_t m_current_offset = 0;
-    ID3D12Resource* m_current_resource = nullptr;
+    Fence_Ring_Allocator m_ring;
+    ID3D12Resource* m_resource = nullptr;
     void* m_mapped_data = nullptr;
-    std::vector<ID3D12Resource*> m_resources = {};
 };
 }
@@ -0,0 +1,67 @@
+#include "owge_render_engine/upload_stream_queue.hpp"
+#include "owge_render_engine/render_engine.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace owge
+{
+Upload_Stream_Ticket Upload_Stream_Queue::push(Buffer_Handle dst, uint64_t dst_offset,
+    std::shared_ptr<const void> data, uint64_t size)
+{
+    m_streams.push_back({
+        .dst = dst,
+        .dst_offset = dst_offset,
+        .data = std::move(data),
+        .size = size,
+        .staged_size = 0
+    });
+    return { .id = m_pushed_count++ };
+}
+
+void Upload_Stream_Queue::process(Render_Engine* render_engine, Staging_Buffer_Allocator* staging_buffer_allocator,
+    ID3D12GraphicsCommandList7* cmd, uint64_t budget, uint64_t fence_value)
+{
+    uint64_t remaining_budget = budget == 0 ? ~0ull : budget;
+    while (!m_streams.empty() && remaining_budget > 0)
+    {
+        auto& stream = m_streams.front();
+        auto chunk_size = std::min(stream.size - stream.staged_size, remaining_budget);
+        auto allocation = staging_buffer_allocator->allocate(chunk_size);
+        memcpy(&static_cast<uint8_t*>(allocation.data)[allocation.offset],
+            &static_cast<const uint8_t*>(stream.data.get())[stream.staged_size],
+            chunk_size);
+        const auto& buffer = render_engine->get_buffer(stream.dst);
+        cmd->CopyBufferRegion(
+            buffer.resource, buffer.offset + stream.dst_offset + stream.staged_size,
+            allocation.resource, allocation.offset,
+            chunk_size);
+        stream.staged_size += chunk_size;
+        remaining_budget -= chunk_size;
+        if (stream.staged_size == stream.size)
+        {
+            m_streams.pop_front();
+            m_in_flight_fence_values.push_back(fence_value);
+        }
+    }
+}
+
+void Upload_Stream_Queue::retire(uint64_t completed_fence_value)
+{
+    while (!m_in_flight_fence_values.empty() && m_in_flight_fence_values.front() <= completed_fence_value)
+    {
+        m_in_flight_fence_values.pop_front();
+        m_completed_count += 1;
+    }
+}
+
+uint64_t Upload_Stream_Queue::get_pending_size() const
+{
+    uint64_t size = 0;
+    for (const auto& stream : m_streams)
+    {
+        size += stream.size - stream.staged_size;
+    }
+    return size;
+}
+}
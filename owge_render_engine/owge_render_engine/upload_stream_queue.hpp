@@ -0,0 +1,61 @@
+#pragma once
+
+#include "owge_render_engine/resource.hpp"
+
+#include <cstdint>
+#include <include/d3d12.h>
+#include <deque>
+#include <memory>
+
+namespace owge
+{
+struct Upload_Stream_Ticket
+{
+    uint64_t id;
+};
+
+class Render_Engine;
+class Staging_Buffer_Allocator;
+
+// Splits large buffer uploads into chunks that are staged over several frames, so the staging
+// memory and copy time spent per frame stay within a fixed budget. The copies are meant to be
+// recorded on the copy queue, streams complete in order once its fence passed their last chunk.
+class Upload_Stream_Queue
+{
+public:
+    // `data` is kept alive until the last chunk was staged.
+    [[nodiscard]] Upload_Stream_Ticket push(Buffer_Handle dst, uint64_t dst_offset,
+        std::shared_ptr<const void> data, uint64_t size);
+    // Stages up to `budget` bytes of the pending streams and records their copies into `cmd`,
+    // which is signaled with `fence_value`. A budget of 0 stages everything.
+    void process(Render_Engine* render_engine, Staging_Buffer_Allocator* staging_buffer_allocator,
+        ID3D12GraphicsCommandList7* cmd, uint64_t budget, uint64_t fence_value);
+    void retire(uint64_t completed_fence_value);
+
+    [[nodiscard]] bool is_complete(Upload_Stream_Ticket ticket) const
+    {
+        return ticket.id < m_completed_count;
+    }
+    [[nodiscard]] bool has_pending_streams() const
+    {
+        return !m_streams.empty();
+    }
+    [[nodiscard]] uint64_t get_pending_size() const;
+
+private:
+    struct Upload_Stream
+    {
+        Buffer_Handle dst;
+        uint64_t dst_offset;
+        std::shared_ptr<const void> data;
+        uint64_t size;
+        uint64_t staged_size;
+    };
+
+    // Fence values that complete the fully staged streams, in stream order.
+    std::deque<uint64_t> m_in_flight_fence_values;
+    std::deque<Upload_Stream> m_streams;
+    uint64_t m_pushed_count = 0;
+    uint64_t m_completed_count = 0;
+};
+}
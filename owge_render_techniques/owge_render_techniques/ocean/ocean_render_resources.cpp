@@ -5,6 +5,9 @@
 
 #include <owge_asset/generator/plane_generator.hpp>
 
+#include <array>
+#include <memory>
+
 namespace owge
 {
 void Ocean_Simulation_Render_Resources::create(
@@ -73,11 +76,6 @@ void Ocean_Simulation_Render_Resources::resize_textures(Render_Engine* render_en
         angular_frequency_texture_desc,
         L"Texture:Ocean:Angular_Frequency");
 
-    if (!displacement_x_y_z_texture.is_null_handle())
-    {
-        render_engine->destroy_texture(displacement_x_y_z_texture);
-        displacement_x_y_z_texture = {};
-    }
     Texture_Desc displacement_x_y_z_texture_desc = {
         .width = settings->size,
         .height = settings->size,
@@ -91,15 +89,6 @@ void Ocean_Simulation_Render_Resources::resize_textures(Render_Engine* render_en
         .initial_layout = D3D12_BARRIER_LAYOUT_UNDEFINED,
         .format = DXGI_FORMAT_R32G32B32A32_FLOAT
     };
-    displacement_x_y_z_texture = render_engine->create_texture(
-        displacement_x_y_z_texture_desc,
-        L"Texture:Ocean:Displacement_X_Y_Z");
-
-    if (!derivatives_texture.is_null_handle())
-    {
-        render_engine->destroy_texture(derivatives_texture);
-        derivatives_texture = {};
-    }
     Texture_Desc derivatives_texture_desc = {
         .width = settings->size,
         .height = settings->size,
@@ -113,15 +102,6 @@ void Ocean_Simulation_Render_Resources::resize_textures(Render_Engine* render_en
         .initial_layout = D3D12_BARRIER_LAYOUT_UNDEFINED,
         .format = DXGI_FORMAT_R32G32B32A32_FLOAT
     };
-    derivatives_texture = render_engine->create_texture(
-        displacement_x_y_z_texture_desc,
-        L"Texture:Ocean:Derivatives");
-
-    if (!jacobian_texture.is_null_handle())
-    {
-        render_engine->destroy_texture(jacobian_texture);
-        jacobian_texture = {};
-    }
     Texture_Desc jacobian_texture_desc = {
         .width = settings->size,
         .height = settings->size,
@@ -135,9 +115,45 @@ void Ocean_Simulation_Render_Resources::resize_textures(Render_Engine* render_en
         .initial_layout = D3D12_BARRIER_LAYOUT_UNDEFINED,
         .format = DXGI_FORMAT_R32_FLOAT
     };
-    jacobian_texture = render_engine->create_texture(
-        displacement_x_y_z_texture_desc,
-        L"Texture:Ocean:Jacobian");
+    auto displacement_x_y_z_texture_names = std::to_array<const wchar_t*>({
+        L"Texture:Ocean:Displacement_X_Y_Z:0", L"Texture:Ocean:Displacement_X_Y_Z:1" });
+    auto derivatives_texture_names = std::to_array<const wchar_t*>({
+        L"Texture:Ocean:Derivatives:0", L"Texture:Ocean:Derivatives:1" });
+    auto jacobian_texture_names = std::to_array<const wchar_t*>({
+        L"Texture:Ocean:Jacobian:0", L"Texture:Ocean:Jacobian:1" });
+    static_assert(OUTPUT_COUNT == 2);
+    for (uint32_t i = 0; i < OUTPUT_COUNT; ++i)
+    {
+        auto& output = outputs[i];
+        if (!output.displacement_x_y_z_texture.is_null_handle())
+        {
+            render_engine->destroy_texture(output.displacement_x_y_z_texture);
+            output.displacement_x_y_z_texture = {};
+        }
+        output.displacement_x_y_z_texture = render_engine->create_texture(
+            displacement_x_y_z_texture_desc,
+            displacement_x_y_z_texture_names[i]);
+
+        if (!output.derivatives_texture.is_null_handle())
+        {
+            render_engine->destroy_texture(output.derivatives_texture);
+            output.derivatives_texture = {};
+        }
+        output.derivatives_texture = render_engine->create_texture(
+            displacement_x_y_z_texture_desc,
+            derivatives_texture_names[i]);
+
+        if (!output.jacobian_texture.is_null_handle())
+        {
+            render_engine->destroy_texture(output.jacobian_texture);
+            output.jacobian_texture = {};
+        }
+        output.jacobian_texture = render_engine->create_texture(
+            displacement_x_y_z_texture_desc,
+            jacobian_texture_names[i]);
+
+        output.written = false;
+    }
 
     if (!packed_x_y_texture.is_null_handle())
     {
@@ -172,18 +188,41 @@ void Ocean_Simulation_Render_Resources::resize_textures(Render_Engine* render_en
         .initial_layout = D3D12_BARRIER_LAYOUT_UNDEFINED,
         .format = DXGI_FORMAT_R32G32_FLOAT
     };
-    packed_x_y_texture = render_engine->create_texture(
-        packed_texture_desc,
-        L"Texture:Ocean:Packed_x_y");
-    packed_z_x_dx_texture = render_engine->create_texture(
-        packed_texture_desc,
-        L"Texture:Ocean:Packed_z_x_dx");
-    packed_y_dx_z_dx_texture = render_engine->create_texture(
-        packed_texture_desc,
-        L"Texture:Ocean:Packed_y_dx_z_dx");
-    packed_y_dy_z_dy_texture = render_engine->create_texture(
-        packed_texture_desc,
-        L"Texture:Ocean:Packed_y_dy_z_dy");
+    // The packed spectra only live from the developed spectrum pass until the reorder pass.
+    // All four are alive in the same passes, so none of them alias each other yet. They only share one heap
+    // and will alias with transient textures of other procedures once those declare lifetimes in the same order.
+    auto packed_texture_descs = std::to_array<Transient_Texture_Desc>({
+        {
+            .texture = packed_texture_desc,
+            .first_use = Ocean_Simulation_Render_Procedure::PASS_DEVELOPED_SPECTRUM,
+            .last_use = Ocean_Simulation_Render_Procedure::PASS_REORDER,
+            .name = L"Texture:Ocean:Packed_x_y"
+        },
+        {
+            .texture = packed_texture_desc,
+            .first_use = Ocean_Simulation_Render_Procedure::PASS_DEVELOPED_SPECTRUM,
+            .last_use = Ocean_Simulation_Render_Procedure::PASS_REORDER,
+            .name = L"Texture:Ocean:Packed_z_x_dx"
+        },
+        {
+            .texture = packed_texture_desc,
+            .first_use = Ocean_Simulation_Render_Procedure::PASS_DEVELOPED_SPECTRUM,
+            .last_use = Ocean_Simulation_Render_Procedure::PASS_REORDER,
+            .name = L"Texture:Ocean:Packed_y_dx_z_dx"
+        },
+        {
+            .texture = packed_texture_desc,
+            .first_use = Ocean_Simulation_Render_Procedure::PASS_DEVELOPED_SPECTRUM,
+            .last_use = Ocean_Simulation_Render_Procedure::PASS_REORDER,
+            .name = L"Texture:Ocean:Packed_y_dy_z_dy"
+        }
+    });
+    std::array<Texture_Handle, 4> packed_textures = {};
+    render_engine->create_transient_textures(packed_texture_descs, packed_textures);
+    packed_x_y_texture = packed_textures[0];
+    packed_z_x_dx_texture = packed_textures[1];
+    packed_y_dx_z_dx_texture = packed_textures[2];
+    packed_y_dy_z_dy_texture = packed_textures[3];
 
     update_persistent_bindsets(render_engine);
 }
@@ -278,20 +317,30 @@ void Ocean_Simulation_Render_Resources::create_simulation_resources(Render_Engin
     Buffer_Desc initial_spectrum_params_buffer = {
         .size = sizeof(Ocean_Simulation_Initial_Spectrum_Parameter_Buffer),
         .heap_type = D3D12_HEAP_TYPE_DEFAULT,
-        .usage = Resource_Usage::Read_Only
+        .usage = Resource_Usage::Read_Only,
+        .suballocate = true
     };
     initial_spectrum_ocean_params_buffer = render_engine->create_buffer(
         initial_spectrum_params_buffer,
         L"Buffer:Ocean:Initial_Spectrum_Params");
 
-    initial_spectrum_bindset = render_engine->create_bindset();
-    developed_spectrum_bindset = render_engine->create_bindset();
-    texture_reorder_bindset = render_engine->create_bindset();
+    initial_spectrum_bindset = render_engine->create_bindset(
+        get_bindset_value_count<Ocean_Initial_Spectrum_Shader_Bindset>());
+    developed_spectrum_bindset = render_engine->create_dynamic_bindset(
+        get_bindset_value_count<Ocean_Developed_Spectrum_Shader_Bindset>());
+    for (auto& output : outputs)
+    {
+        output.texture_reorder_bindset = render_engine->create_bindset(
+            get_bindset_value_count<Ocean_Texture_Reorder_Shader_Bindset>());
+    }
 }
 
 void Ocean_Simulation_Render_Resources::destroy_simulation_resources(Render_Engine* render_engine)
 {
-    render_engine->destroy_bindset(texture_reorder_bindset);
+    for (auto& output : outputs)
+    {
+        render_engine->destroy_bindset(output.texture_reorder_bindset);
+    }
     render_engine->destroy_bindset(developed_spectrum_bindset);
     render_engine->destroy_bindset(initial_spectrum_bindset);
     render_engine->destroy_buffer(initial_spectrum_ocean_params_buffer);
@@ -361,32 +410,36 @@ void Ocean_Simulation_Render_Resources::destroy_surface_shaders(Render_Engine* r
 
 void Ocean_Simulation_Render_Resources::create_surface_resources(Render_Engine* render_engine)
 {
-    auto ocean_plane = mesh_generate_simple_plane_2d(4096);
+    // The plane is hundreds of megabytes, so it is streamed in over several frames.
+    auto ocean_plane = std::make_shared<Generated_Simple_Mesh<XMFLOAT2>>(mesh_generate_simple_plane_2d(4096));
 
     Buffer_Desc ocean_surface_vertex_buffer_desc = {
-        .size = ocean_plane.vertex_positions.size() * sizeof(XMFLOAT2),
+        .size = ocean_plane->vertex_positions.size() * sizeof(XMFLOAT2),
         .heap_type = D3D12_HEAP_TYPE_DEFAULT,
         .usage = Resource_Usage::Read_Only
     };
     ocean_surface_vertex_buffer = render_engine->create_buffer(ocean_surface_vertex_buffer_desc);
-    render_engine->copy_and_upload_data(sizeof(XMFLOAT2) * ocean_plane.vertex_positions.size(),
-        0, ocean_surface_vertex_buffer, 0, ocean_plane.vertex_positions.data());
+    ocean_surface_vertex_upload = render_engine->stream_data(ocean_surface_vertex_buffer, 0,
+        std::shared_ptr<const void>(ocean_plane, ocean_plane->vertex_positions.data()),
+        ocean_surface_vertex_buffer_desc.size);
 
     Buffer_Desc ocean_surface_index_buffer_desc = {
-        .size = ocean_plane.indices.size() * sizeof(uint32_t),
+        .size = ocean_plane->indices.size() * sizeof(uint32_t),
         .heap_type = D3D12_HEAP_TYPE_DEFAULT,
         .usage = Resource_Usage::Read_Only
     };
     ocean_surface_index_buffer = render_engine->create_buffer(ocean_surface_index_buffer_desc);
-    render_engine->copy_and_upload_data(sizeof(uint32_t) * ocean_plane.indices.size(),
-        0, ocean_surface_index_buffer, 0, ocean_plane.indices.data());
+    ocean_surface_index_upload = render_engine->stream_data(ocean_surface_index_buffer, 0,
+        std::shared_ptr<const void>(ocean_plane, ocean_plane->indices.data()),
+        ocean_surface_index_buffer_desc.size);
 
-    ocean_surface_index_count = uint32_t(ocean_plane.indices.size());
+    ocean_surface_index_count = uint32_t(ocean_plane->indices.size());
 
     Buffer_Desc ocean_surface_vs_render_data_buffer_desc = {
         .size = sizeof(Ocean_Surface_VS_Render_Data),
         .heap_type = D3D12_HEAP_TYPE_DEFAULT,
-        .usage = Resource_Usage::Read_Only
+        .usage = Resource_Usage::Read_Only,
+        .suballocate = true
     };
     ocean_surface_vs_render_data_buffer = render_engine->create_buffer(ocean_surface_vs_render_data_buffer_desc);
 
@@ -404,48 +457,64 @@ void Ocean_Simulation_Render_Resources::create_surface_resources(Render_Engine*
     };
     ocean_surface_sampler = render_engine->create_sampler(ocean_surface_sampler_desc);
 
-    surface_render_vs_bindset = render_engine->create_bindset();
-    surface_render_ps_bindset = render_engine->create_bindset();
+    for (auto& output : outputs)
+    {
+        output.surface_render_vs_bindset = render_engine->create_bindset(
+            get_bindset_value_count<Ocean_Surface_Bindset>());
+    }
+    surface_render_ps_bindset = render_engine->create_bindset(
+        get_bindset_value_count<Ocean_Surface_Bindset>());
 }
 
 void Ocean_Simulation_Render_Resources::destroy_surface_resources(Render_Engine* render_engine)
 {
     render_engine->destroy_bindset(surface_render_ps_bindset);
-    render_engine->destroy_bindset(surface_render_vs_bindset);
+    for (auto& output : outputs)
+    {
+        render_engine->destroy_bindset(output.surface_render_vs_bindset);
+    }
     render_engine->destroy_sampler(ocean_surface_sampler);
     render_engine->destroy_buffer(ocean_surface_vs_render_data_buffer);
     render_engine->destroy_buffer(ocean_surface_index_buffer);
     render_engine->destroy_buffer(ocean_surface_vertex_buffer);
 
-    render_engine->destroy_texture(displacement_x_y_z_texture);
-    render_engine->destroy_texture(derivatives_texture);
-    render_engine->destroy_texture(jacobian_texture);
+    for (auto& output : outputs)
+    {
+        render_engine->destroy_texture(output.displacement_x_y_z_texture);
+        render_engine->destroy_texture(output.derivatives_texture);
+        render_engine->destroy_texture(output.jacobian_texture);
+    }
 }
 
 void Ocean_Simulation_Render_Resources::update_persistent_bindsets(Render_Engine* render_engine)
 {
-    Ocean_Texture_Reorder_Shader_Bindset texture_reorder_bindset_data = {
-        .packed_x_y       = uint32_t(packed_x_y_texture.bindless_idx),
-        .packed_z_x_dx    = uint32_t(packed_z_x_dx_texture.bindless_idx),
-        .packed_y_dx_z_dx = uint32_t(packed_y_dx_z_dx_texture.bindless_idx),
-        .packed_y_dy_z_dy = uint32_t(packed_y_dy_z_dy_texture.bindless_idx),
-        .displacement     = uint32_t(displacement_x_y_z_texture.bindless_idx),
-        .derivatives      = uint32_t(derivatives_texture.bindless_idx),
-        .folding_map      = uint32_t(jacobian_texture.bindless_idx)
-    };
-    texture_reorder_bindset.write_data(texture_reorder_bindset_data);
-    render_engine->update_bindings(texture_reorder_bindset);
-
-    Ocean_Surface_Bindset surface_vs_bindset = {
-        .vertex_buffer = uint32_t(ocean_surface_vertex_buffer.bindless_idx),
-        .render_data = uint32_t(ocean_surface_vs_render_data_buffer.bindless_idx),
-        .displacement_texture = uint32_t(displacement_x_y_z_texture.bindless_idx),
-        .derivatives_texture = uint32_t(derivatives_texture.bindless_idx),
-        .jacobian_texture = uint32_t(jacobian_texture.bindless_idx),
-        .surface_sampler = uint32_t(ocean_surface_sampler.bindless_idx)
-    };
-    surface_render_vs_bindset.write_data(surface_vs_bindset);
-    render_engine->update_bindings(surface_render_vs_bindset);
+    for (auto& output : outputs)
+    {
+        Ocean_Texture_Reorder_Shader_Bindset texture_reorder_bindset_data = {
+            .packed_x_y       = packed_x_y_texture.get_bindless_idx(),
+            .packed_z_x_dx    = packed_z_x_dx_texture.get_bindless_idx(),
+            .packed_y_dx_z_dx = packed_y_dx_z_dx_texture.get_bindless_idx(),
+            .packed_y_dy_z_dy = packed_y_dy_z_dy_texture.get_bindless_idx(),
+            .displacement     = output.displacement_x_y_z_texture.get_bindless_idx(),
+            .derivatives      = output.derivatives_texture.get_bindless_idx(),
+            .folding_map      = output.jacobian_texture.get_bindless_idx()
+        };
+        output.texture_reorder_bindset.write_data(texture_reorder_bindset_data);
+        render_engine->update_bindings(output.texture_reorder_bindset);
+
+        Ocean_Surface_Bindset surface_vs_bindset = {
+            .vertex_buffer = ocean_surface_vertex_buffer.get_bindless_idx(),
+            .vertex_buffer_offset = render_engine->get_buffer(ocean_surface_vertex_buffer).offset,
+            .render_data = ocean_surface_vs_render_data_buffer.get_bindless_idx(),
+            .render_data_offset = render_engine->get_buffer(ocean_surface_vs_render_data_buffer).offset,
+            .displacement_texture = output.displacement_x_y_z_texture.get_bindless_idx(),
+            .derivatives_texture = output.derivatives_texture.get_bindless_idx(),
+            .jacobian_texture = output.jacobian_texture.get_bindless_idx(),
+            .surface_sampler = ocean_surface_sampler.get_bindless_idx()
+        };
+        output.surface_render_vs_bindset.write_data(surface_vs_bindset);
+        render_engine->update_bindings(output.surface_render_vs_bindset);
+    }
 }
 
 }
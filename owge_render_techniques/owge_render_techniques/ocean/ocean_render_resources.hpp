@@ -4,7 +4,9 @@
 
 #include <owge_render_engine/resource.hpp>
 #include <owge_render_engine/bindless.hpp>
+#include <owge_render_engine/upload_stream_queue.hpp>
 
+#include <array>
 #include <DirectXMath.h>
 
 namespace owge
@@ -36,6 +38,7 @@ struct Ocean_Simulation_Initial_Spectrum_Parameter_Buffer
 struct Ocean_Initial_Spectrum_Shader_Bindset
 {
     uint32_t ocean_params_buf_idx;
+    uint32_t ocean_params_buf_offset;
     uint32_t initial_spectrum_tex_idx;
     uint32_t angular_frequency_tex_idx;
 };
@@ -75,7 +78,9 @@ struct Ocean_Texture_Reorder_Shader_Bindset
 struct Ocean_Surface_Bindset
 {
     uint32_t vertex_buffer;
+    uint32_t vertex_buffer_offset;
     uint32_t render_data;
+    uint32_t render_data_offset;
     uint32_t displacement_texture;
     uint32_t derivatives_texture;
     uint32_t jacobian_texture;
@@ -90,8 +95,32 @@ struct Ocean_Surface_VS_Render_Data
     XMFLOAT4 sun_position;
 };
 
+// The simulation runs on the async compute queue and writes one output while the surface reads the other.
+struct Ocean_Simulation_Output
+{
+    Texture_Handle displacement_x_y_z_texture;
+    Texture_Handle derivatives_texture;
+    Texture_Handle jacobian_texture;
+    Bindset texture_reorder_bindset;
+    Bindset surface_render_vs_bindset;
+    // Cleared when the textures are recreated, the surface is not drawn until the simulation wrote them.
+    bool written;
+};
+
 struct Ocean_Simulation_Render_Resources
 {
+    static constexpr uint32_t OUTPUT_COUNT = 2;
+
+    // The output written by the simulation in `frame`, the surface reads the one written in the previous frame.
+    [[nodiscard]] Ocean_Simulation_Output& get_simulation_output(uint64_t frame)
+    {
+        return outputs[frame % OUTPUT_COUNT];
+    }
+    [[nodiscard]] Ocean_Simulation_Output& get_surface_output(uint64_t frame)
+    {
+        return outputs[(frame + 1) % OUTPUT_COUNT];
+    }
+
     void create(
         Render_Engine* render_engine,
         Ocean_Settings* settings);
@@ -116,7 +145,6 @@ struct Ocean_Simulation_Render_Resources
     Texture_Handle initial_spectrum_texture;
     Texture_Handle angular_frequency_texture;
 
-    Bindset texture_reorder_bindset;
     Shader_Handle texture_reorder_shader;
     Pipeline_Handle texture_reorder_pso;
     Texture_Handle packed_x_y_texture;
@@ -127,13 +155,13 @@ struct Ocean_Simulation_Render_Resources
     Bindset initial_spectrum_bindset;
     Bindset developed_spectrum_bindset;
 
-    Texture_Handle displacement_x_y_z_texture;
-    Texture_Handle derivatives_texture;
-    Texture_Handle jacobian_texture;
+    std::array<Ocean_Simulation_Output, OUTPUT_COUNT> outputs;
 
     Buffer_Handle ocean_surface_vertex_buffer;
     Buffer_Handle ocean_surface_index_buffer;
     Buffer_Handle ocean_surface_vs_render_data_buffer;
+    Upload_Stream_Ticket ocean_surface_vertex_upload;
+    Upload_Stream_Ticket ocean_surface_index_upload;
     uint32_t ocean_surface_index_count;
     Sampler_Handle ocean_surface_sampler;
 
@@ -141,7 +169,6 @@ struct Ocean_Simulation_Render_Resources
     Shader_Handle surface_plane_ps;
     Pipeline_Handle surface_plane_pso;
 
-    Bindset surface_render_vs_bindset;
     Bindset surface_render_ps_bindset;
 
 private:
@@ -4,6 +4,7 @@
 
 #include <owge_render_engine/command_list.hpp>
 #include <owge_render_engine/render_engine.hpp>
+#include <owge_render_engine/render_procedure/render_pass_builder.hpp>
 
 namespace owge
 {
@@ -12,9 +13,33 @@ Ocean_Simulation_Render_Procedure::Ocean_Simulation_Render_Procedure(
     : Render_Procedure("Ocean_Simulation"), m_settings(settings), m_resources(resources)
 {}
 
+void Ocean_Simulation_Render_Procedure::declare(Render_Engine* render_engine, Render_Pass_Builder& builder)
+{
+    auto spectrum_access = m_settings->recompute_initial_spectrum
+        ? Render_Graph_Access::Unordered_Access
+        : Render_Graph_Access::Compute_Shader_Read;
+    builder.use(m_resources->initial_spectrum_texture, spectrum_access);
+    builder.use(m_resources->angular_frequency_texture, spectrum_access);
+    for (auto texture : {
+        m_resources->packed_x_y_texture,
+        m_resources->packed_z_x_dx_texture,
+        m_resources->packed_y_dx_z_dx_texture,
+        m_resources->packed_y_dy_z_dy_texture })
+    {
+        builder.use(texture, Render_Graph_Access::Unordered_Access);
+    }
+    // The surface reads the outputs in the next frame.
+    auto& output = m_resources->get_simulation_output(render_engine->get_current_frame());
+    for (auto texture : { output.displacement_x_y_z_texture, output.derivatives_texture, output.jacobian_texture })
+    {
+        builder.use(texture, Render_Graph_Access::Unordered_Access);
+        builder.export_texture(texture);
+    }
+}
+
 void Ocean_Simulation_Render_Procedure::process(const Render_Procedure_Payload& payload)
 {
-    auto barrier_builder = payload.cmd->acquire_barrier_builder();
+    auto& barrier_builder = payload.cmd->acquire_barrier_builder();
     m_time += payload.delta_time;
     process_initial_spectrum(payload, barrier_builder);
     process_developed_spectrum(payload, barrier_builder);
@@ -50,9 +75,10 @@ void Ocean_Simulation_Render_Procedure::process_initial_spectrum(
     payload.cmd->begin_event("Initial_Spectrum_Computation");
 
     Ocean_Initial_Spectrum_Shader_Bindset initial_spectrum_bindset_data = {
-        .ocean_params_buf_idx = uint32_t(m_resources->initial_spectrum_ocean_params_buffer.bindless_idx),
-        .initial_spectrum_tex_idx = uint32_t(m_resources->initial_spectrum_texture.bindless_idx),
-        .angular_frequency_tex_idx = uint32_t(m_resources->angular_frequency_texture.bindless_idx)
+        .ocean_params_buf_idx = m_resources->initial_spectrum_ocean_params_buffer.get_bindless_idx(),
+        .ocean_params_buf_offset = payload.render_engine->get_buffer(m_resources->initial_spectrum_ocean_params_buffer).offset,
+        .initial_spectrum_tex_idx = m_resources->initial_spectrum_texture.get_bindless_idx(),
+        .angular_frequency_tex_idx = m_resources->angular_frequency_texture.get_bindless_idx()
     };
     m_resources->initial_spectrum_bindset.write_data(initial_spectrum_bindset_data);
     payload.render_engine->update_bindings(m_resources->initial_spectrum_bindset);
@@ -108,43 +134,18 @@ void Ocean_Simulation_Render_Procedure::process_initial_spectrum(
         sizeof(Ocean_Simulation_Initial_Spectrum_Parameter_Buffer), 0, m_resources->initial_spectrum_ocean_params_buffer, 0);
     memcpy(upload, &initial_spectrum_parameters, sizeof(Ocean_Simulation_Initial_Spectrum_Parameter_Buffer));
 
-    barrier_builder.push({
-        .texture = m_resources->initial_spectrum_texture,
-        .sync_before = D3D12_BARRIER_SYNC_NONE,
-        .sync_after = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .access_before = D3D12_BARRIER_ACCESS_NO_ACCESS,
-        .access_after = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
-        .layout_before = D3D12_BARRIER_LAYOUT_UNDEFINED,
-        .layout_after = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
-        .subresources = {
-            .IndexOrFirstMipLevel = 0,
-            .NumMipLevels = 1,
-            .FirstArraySlice = 0,
-            .NumArraySlices = m_settings->cascade_count,
-            .FirstPlane = 0,
-            .NumPlanes = 1
-        },
-        .flags = D3D12_TEXTURE_BARRIER_FLAG_NONE
-        });
-    barrier_builder.push({
-        .texture = m_resources->angular_frequency_texture,
-        .sync_before = D3D12_BARRIER_SYNC_NONE,
-        .sync_after = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .access_before = D3D12_BARRIER_ACCESS_NO_ACCESS,
-        .access_after = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
-        .layout_before = D3D12_BARRIER_LAYOUT_UNDEFINED,
-        .layout_after = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
-        .subresources = {
-            .IndexOrFirstMipLevel = 0,
-            .NumMipLevels = 1,
-            .FirstArraySlice = 0,
-            .NumArraySlices = m_settings->cascade_count,
-            .FirstPlane = 0,
-            .NumPlanes = 1
-        },
-        .flags = D3D12_TEXTURE_BARRIER_FLAG_NONE
-        });
-    barrier_builder.flush();
+    auto cascade_subresources = get_cascade_subresources();
+    for (auto texture : { m_resources->initial_spectrum_texture, m_resources->angular_frequency_texture })
+    {
+        barrier_builder.use(Texture_Usage{
+            .texture = texture,
+            .sync = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
+            .access = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
+            .layout = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
+            .subresources = cascade_subresources,
+            .discard = true
+            });
+    }
 
     payload.cmd->set_bindset_compute(m_resources->initial_spectrum_bindset);
     payload.cmd->set_pipeline_state(m_resources->initial_spectrum_pso);
@@ -153,43 +154,6 @@ void Ocean_Simulation_Render_Procedure::process_initial_spectrum(
         size, size, m_settings->cascade_count,
         true, true, false);
 
-    barrier_builder.push({
-        .texture = m_resources->initial_spectrum_texture,
-        .sync_before = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .sync_after = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .access_before = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
-        .access_after = D3D12_BARRIER_ACCESS_SHADER_RESOURCE,
-        .layout_before = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
-        .layout_after = D3D12_BARRIER_LAYOUT_SHADER_RESOURCE,
-        .subresources = {
-            .IndexOrFirstMipLevel = 0,
-            .NumMipLevels = 1,
-            .FirstArraySlice = 0,
-            .NumArraySlices = m_settings->cascade_count,
-            .FirstPlane = 0,
-            .NumPlanes = 1
-        },
-        .flags = D3D12_TEXTURE_BARRIER_FLAG_NONE
-        });
-    barrier_builder.push({
-        .texture = m_resources->angular_frequency_texture,
-        .sync_before = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .sync_after = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .access_before = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
-        .access_after = D3D12_BARRIER_ACCESS_SHADER_RESOURCE,
-        .layout_before = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
-        .layout_after = D3D12_BARRIER_LAYOUT_SHADER_RESOURCE,
-        .subresources = {
-            .IndexOrFirstMipLevel = 0,
-            .NumMipLevels = 1,
-            .FirstArraySlice = 0,
-            .NumArraySlices = m_settings->cascade_count,
-            .FirstPlane = 0,
-            .NumPlanes = 1
-        },
-        .flags = D3D12_TEXTURE_BARRIER_FLAG_NONE
-        });
-
     payload.cmd->end_event();
 }
 
@@ -199,7 +163,19 @@ void Ocean_Simulation_Render_Procedure::process_developed_spectrum(
     payload.cmd->begin_event("Developed_Spectrum_Computation");
 
     auto size = m_settings->size;
+    auto cascade_subresources = get_cascade_subresources();
 
+    // Only transitions if the initial spectrum was recomputed this frame.
+    for (auto texture : { m_resources->initial_spectrum_texture, m_resources->angular_frequency_texture })
+    {
+        barrier_builder.use(Texture_Usage{
+            .texture = texture,
+            .sync = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
+            .access = D3D12_BARRIER_ACCESS_SHADER_RESOURCE,
+            .layout = D3D12_BARRIER_LAYOUT_SHADER_RESOURCE,
+            .subresources = cascade_subresources
+            });
+    }
     auto textures = std::to_array({
         m_resources->packed_x_y_texture,
         m_resources->packed_z_x_dx_texture,
@@ -208,36 +184,38 @@ void Ocean_Simulation_Render_Procedure::process_developed_spectrum(
         });
     for (auto texture : textures)
     {
-        barrier_builder.push({
-        .texture = texture,
-        .sync_before = D3D12_BARRIER_SYNC_NONE,
-        .sync_after = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .access_before = D3D12_BARRIER_ACCESS_NO_ACCESS,
-        .access_after = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
-        .layout_before = D3D12_BARRIER_LAYOUT_UNDEFINED,
-        .layout_after = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
-        .subresources = {
-            .IndexOrFirstMipLevel = 0,
-            .NumMipLevels = 1,
-            .FirstArraySlice = 0,
-            .NumArraySlices = m_settings->cascade_count,
-            .FirstPlane = 0,
-            .NumPlanes = 1
-        },
-        .flags = D3D12_TEXTURE_BARRIER_FLAG_NONE
+        barrier_builder.use(Texture_Usage{
+            .texture = texture,
+            .sync = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
+            .access = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
+            .layout = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
+            .subresources = cascade_subresources,
+            .discard = true
+            });
+    }
+    // The reorder pass writes the outputs last, so their transition overlaps with the FFTs.
+    auto& output = m_resources->get_simulation_output(payload.render_engine->get_current_frame());
+    for (auto texture : { output.displacement_x_y_z_texture, output.derivatives_texture, output.jacobian_texture })
+    {
+        barrier_builder.begin_use(Texture_Usage{
+            .texture = texture,
+            .sync = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
+            .access = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
+            .layout = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
+            .subresources = cascade_subresources,
+            .discard = true
             });
     }
-    barrier_builder.flush();
 
     Ocean_Developed_Spectrum_Shader_Bindset developed_spectrum_bindset = {
-        .initial_spectrum_tex_idx = uint32_t(m_resources->initial_spectrum_texture.bindless_idx),
-        .angular_frequency_tex_idx = uint32_t(m_resources->angular_frequency_texture.bindless_idx),
+        .initial_spectrum_tex_idx = m_resources->initial_spectrum_texture.get_bindless_idx(),
+        .angular_frequency_tex_idx = m_resources->angular_frequency_texture.get_bindless_idx(),
         .time = m_time,
         .size = size,
-        .packed_spectrum_x_y_tex_idx = uint32_t(m_resources->packed_x_y_texture.bindless_idx),
-        .packed_spectrum_z_x_dx_tex_idx = uint32_t(m_resources->packed_z_x_dx_texture.bindless_idx),
-        .packed_spectrum_y_dx_z_dx_tex_idx = uint32_t(m_resources->packed_y_dx_z_dx_texture.bindless_idx),
-        .packed_spectrum_y_dy_z_dy_tex_idx = uint32_t(m_resources->packed_y_dy_z_dy_texture.bindless_idx)
+        .packed_spectrum_x_y_tex_idx = m_resources->packed_x_y_texture.get_bindless_idx(),
+        .packed_spectrum_z_x_dx_tex_idx = m_resources->packed_z_x_dx_texture.get_bindless_idx(),
+        .packed_spectrum_y_dx_z_dx_tex_idx = m_resources->packed_y_dx_z_dx_texture.get_bindless_idx(),
+        .packed_spectrum_y_dy_z_dy_tex_idx = m_resources->packed_y_dy_z_dy_texture.get_bindless_idx()
     };
     m_resources->developed_spectrum_bindset.write_data(developed_spectrum_bindset);
     payload.render_engine->update_bindings(m_resources->developed_spectrum_bindset);
@@ -248,29 +226,6 @@ void Ocean_Simulation_Render_Procedure::process_developed_spectrum(
         size, size, m_settings->cascade_count,
         true, true, false);
 
-    for (auto texture : textures)
-    {
-        barrier_builder.push({
-        .texture = texture,
-        .sync_before = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .sync_after = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .access_before = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
-        .access_after = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
-        .layout_before = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
-        .layout_after = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
-        .subresources = {
-            .IndexOrFirstMipLevel = 0,
-            .NumMipLevels = 1,
-            .FirstArraySlice = 0,
-            .NumArraySlices = m_settings->cascade_count,
-            .FirstPlane = 0,
-            .NumPlanes = 1
-        },
-        .flags = D3D12_TEXTURE_BARRIER_FLAG_NONE
-            });
-    }
-    barrier_builder.flush();
-
     payload.cmd->end_event();
 }
 
@@ -303,24 +258,19 @@ void Ocean_Simulation_Render_Procedure::process_ffts(
         m_resources->packed_y_dy_z_dy_texture
         });
 
-    Texture_Barrier tex_barrier = {
+    // Each pass reads and writes the textures written by the previous one, these end up as a single global barrier.
+    auto tex_usage = Texture_Usage{
         .texture = {},
-        .sync_before = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .sync_after = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .access_before = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
-        .access_after = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
-        .layout_before = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
-        .layout_after = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
-        .subresources = {
-            .IndexOrFirstMipLevel = 0,
-            .NumMipLevels = 1,
-            .FirstArraySlice = 0,
-            .NumArraySlices = m_settings->cascade_count,
-            .FirstPlane = 0,
-            .NumPlanes = 1
-        },
-        .flags = D3D12_TEXTURE_BARRIER_FLAG_NONE
+        .sync = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
+        .access = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
+        .layout = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
+        .subresources = get_cascade_subresources()
     };
+    for (auto texture : textures)
+    {
+        tex_usage.texture = texture;
+        barrier_builder.use(tex_usage);
+    }
 
     Ocean_FFT_Constants constants = {
         .texture = 0,
@@ -329,23 +279,23 @@ void Ocean_Simulation_Render_Procedure::process_ffts(
     };
     for (auto texture : textures)
     {
-        tex_barrier.texture = texture;
-        constants.texture = uint32_t(texture.bindless_idx);
+        constants.texture = texture.get_bindless_idx();
         payload.cmd->set_constants_compute(sizeof(Ocean_FFT_Constants) / sizeof(uint32_t), &constants, 0);
         payload.cmd->dispatch(1, size, m_settings->cascade_count);
-        barrier_builder.push(tex_barrier);
     }
 
-    barrier_builder.flush();
+    for (auto texture : textures)
+    {
+        tex_usage.texture = texture;
+        barrier_builder.use(tex_usage);
+    }
 
     constants.vertical = true;
     for (auto texture : textures)
     {
-        tex_barrier.texture = texture;
-        constants.texture = uint32_t(texture.bindless_idx);
+        constants.texture = texture.get_bindless_idx();
         payload.cmd->set_constants_compute(sizeof(Ocean_FFT_Constants) / sizeof(uint32_t), &constants, 0);
         payload.cmd->dispatch(1, size, m_settings->cascade_count);
-        barrier_builder.push(tex_barrier);
     }
 
     payload.cmd->end_event();
@@ -356,56 +306,68 @@ void Ocean_Simulation_Render_Procedure::process_reorder(
 {
     payload.cmd->begin_event("Reorder Textures + Jacobian");
 
-    auto tex_barrier = Texture_Barrier{
-        .texture = m_resources->displacement_x_y_z_texture,
-        .sync_before = D3D12_BARRIER_SYNC_NONE,
-        .sync_after = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
-        .access_before = D3D12_BARRIER_ACCESS_NO_ACCESS,
-        .access_after = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
-        .layout_before = D3D12_BARRIER_LAYOUT_UNDEFINED,
-        .layout_after = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
-        .subresources = {
-            .IndexOrFirstMipLevel = 0,
-            .NumMipLevels = 1,
-            .FirstArraySlice = 0,
-            .NumArraySlices = m_settings->cascade_count,
-            .FirstPlane = 0,
-            .NumPlanes = 1
-        },
-        .flags = D3D12_TEXTURE_BARRIER_FLAG_NONE
+    auto& output = m_resources->get_simulation_output(payload.render_engine->get_current_frame());
+    auto output_textures = std::to_array({
+        output.displacement_x_y_z_texture,
+        output.derivatives_texture,
+        output.jacobian_texture
+        });
+    auto packed_textures = std::to_array({
+        m_resources->packed_x_y_texture,
+        m_resources->packed_z_x_dx_texture,
+        m_resources->packed_y_dx_z_dx_texture,
+        m_resources->packed_y_dy_z_dy_texture
+        });
+    auto tex_usage = Texture_Usage{
+        .texture = {},
+        .sync = D3D12_BARRIER_SYNC_COMPUTE_SHADING,
+        .access = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
+        .layout = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS,
+        .subresources = get_cascade_subresources()
     };
-    barrier_builder.push(tex_barrier);
-    tex_barrier.texture = m_resources->derivatives_texture;
-    barrier_builder.push(tex_barrier);
-    tex_barrier.texture = m_resources->jacobian_texture;
-    barrier_builder.push(tex_barrier);
-    barrier_builder.flush();
+    for (auto texture : packed_textures)
+    {
+        tex_usage.texture = texture;
+        barrier_builder.use(tex_usage);
+    }
+    // Ends the split barriers begun before the developed spectrum computation.
+    for (auto texture : output_textures)
+    {
+        tex_usage.texture = texture;
+        barrier_builder.use(tex_usage);
+    }
 
     auto size = m_settings->size;
-    payload.cmd->set_bindset_compute(m_resources->texture_reorder_bindset);
+    payload.cmd->set_bindset_compute(output.texture_reorder_bindset);
     payload.cmd->set_pipeline_state(m_resources->texture_reorder_pso);
     payload.cmd->dispatch_div_by_workgroups(m_resources->texture_reorder_pso,
         size, size, m_settings->cascade_count,
         true, true, false);
 
-    tex_barrier.sync_before = D3D12_BARRIER_SYNC_COMPUTE_SHADING;
-
-    tex_barrier.access_before = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS;
-    tex_barrier.access_after = D3D12_BARRIER_ACCESS_SHADER_RESOURCE;
-    tex_barrier.layout_before = D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS;
-    tex_barrier.layout_after = D3D12_BARRIER_LAYOUT_SHADER_RESOURCE;
-
-    tex_barrier.texture = m_resources->displacement_x_y_z_texture;
-    tex_barrier.sync_after = D3D12_BARRIER_SYNC_VERTEX_SHADING;
-    barrier_builder.push(tex_barrier);
-    tex_barrier.texture = m_resources->derivatives_texture;
-    tex_barrier.sync_after = D3D12_BARRIER_SYNC_PIXEL_SHADING;
-    barrier_builder.push(tex_barrier);
-    tex_barrier.texture = m_resources->jacobian_texture;
-    tex_barrier.sync_after = D3D12_BARRIER_SYNC_PIXEL_SHADING;
-    barrier_builder.push(tex_barrier);
-    barrier_builder.flush();
+    // The outputs are read on the direct queue in the next frame, the fence between the queues
+    // synchronizes the access so only the layout is changed here.
+    tex_usage.sync = D3D12_BARRIER_SYNC_NONE;
+    tex_usage.access = D3D12_BARRIER_ACCESS_NO_ACCESS;
+    tex_usage.layout = D3D12_BARRIER_LAYOUT_SHADER_RESOURCE;
+    for (auto texture : output_textures)
+    {
+        tex_usage.texture = texture;
+        barrier_builder.use(tex_usage);
+    }
+    output.written = true;
 
     payload.cmd->end_event();
 }
+
+D3D12_BARRIER_SUBRESOURCE_RANGE Ocean_Simulation_Render_Procedure::get_cascade_subresources() const
+{
+    return {
+        .IndexOrFirstMipLevel = 0,
+        .NumMipLevels = 1,
+        .FirstArraySlice = 0,
+        .NumArraySlices = m_settings->cascade_count,
+        .FirstPlane = 0,
+        .NumPlanes = 1
+    };
+}
 }
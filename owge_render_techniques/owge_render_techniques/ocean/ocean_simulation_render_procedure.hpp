@@ -2,6 +2,9 @@
 
 #include <owge_render_engine/render_procedure/render_procedure.hpp>
 
+#include <cstdint>
+#include <include/d3d12.h>
+
 namespace owge
 {
 struct Ocean_Settings;
@@ -11,9 +14,16 @@ class Barrier_Builder;
 class Ocean_Simulation_Render_Procedure : public Render_Procedure
 {
 public:
+    // Pass order within a frame, used for transient resource lifetimes.
+    static constexpr uint32_t PASS_INITIAL_SPECTRUM = 0;
+    static constexpr uint32_t PASS_DEVELOPED_SPECTRUM = 1;
+    static constexpr uint32_t PASS_FFTS = 2;
+    static constexpr uint32_t PASS_REORDER = 3;
+
     Ocean_Simulation_Render_Procedure(
         Ocean_Settings* settings, Ocean_Simulation_Render_Resources* resources);
 
+    virtual void declare(Render_Engine* render_engine, Render_Pass_Builder& builder) override;
     virtual void process(const Render_Procedure_Payload& payload) override;
 
 private:
@@ -21,6 +31,7 @@ private:
     void process_developed_spectrum(const Render_Procedure_Payload& payload, Barrier_Builder& barrier_builder);
     void process_ffts(const Render_Procedure_Payload& payload, Barrier_Builder& barrier_builder);
     void process_reorder(const Render_Procedure_Payload& payload, Barrier_Builder& barrier_builder);
+    [[nodiscard]] D3D12_BARRIER_SUBRESOURCE_RANGE get_cascade_subresources() const;
 
 private:
     Ocean_Settings* m_settings;
@@ -4,6 +4,7 @@
 #include <owge_render_engine/render_engine.hpp>
 #include <owge_render_engine/command_list.hpp>
 #include <owge_render_engine/camera.hpp>
+#include <owge_render_engine/render_procedure/render_pass_builder.hpp>
 
 namespace owge
 {
@@ -17,8 +18,32 @@ Ocean_Surface_Render_Procedure::Ocean_Surface_Render_Procedure(
     , m_camera(camera)
 {}
 
+void Ocean_Surface_Render_Procedure::declare(Render_Engine* render_engine, Render_Pass_Builder& builder)
+{
+    auto& output = m_resources->get_surface_output(render_engine->get_current_frame());
+    if (!output.written)
+    {
+        return;
+    }
+    for (auto texture : { output.displacement_x_y_z_texture, output.derivatives_texture, output.jacobian_texture })
+    {
+        builder.use(texture, Render_Graph_Access::Vertex_Shader_Read);
+    }
+}
+
 void Ocean_Surface_Render_Procedure::process(const Render_Procedure_Payload& payload)
 {
+    // Streams complete in order, so the index buffer finishing implies the vertex buffer did too.
+    if (!payload.render_engine->is_upload_stream_complete(m_resources->ocean_surface_index_upload))
+    {
+        return;
+    }
+    auto& output = m_resources->get_surface_output(payload.render_engine->get_current_frame());
+    if (!output.written)
+    {
+        return;
+    }
+
     Ocean_Surface_VS_Render_Data vs_render_data = {
         .view_proj = m_camera->view_proj,
         .length_scales = {
@@ -40,7 +65,7 @@ void Ocean_Surface_Render_Procedure::process(const Render_Procedure_Payload& pay
     payload.cmd->set_pipeline_state(m_resources->surface_plane_pso);
     payload.cmd->set_index_buffer(m_resources->ocean_surface_index_buffer, Index_Type::Uint32);
     payload.cmd->set_primitive_topology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    payload.cmd->set_bindset_graphics(m_resources->surface_render_vs_bindset, 0);
+    payload.cmd->set_bindset_graphics(output.surface_render_vs_bindset, 0);
     payload.cmd->set_bindset_graphics(m_resources->surface_render_ps_bindset, 2);
 
     payload.cmd->draw_indexed(m_resources->ocean_surface_index_count, 0, 1, 0, 0);
@@ -16,6 +16,7 @@ public:
         Ocean_Simulation_Render_Resources* resources,
         Camera_Data* camera_data);
 
+    virtual void declare(Render_Engine* render_engine, Render_Pass_Builder& builder) override;
     virtual void process(const Render_Procedure_Payload& payload) override;
 
 private:
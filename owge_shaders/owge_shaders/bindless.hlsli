@@ -1,7 +1,7 @@
 #ifndef OWGE_BINDLESS
 #define OWGE_BINDLESS
 
-static const uint bindless_max_bindset_size = 16 * sizeof(uint);
+static const uint bindless_max_bindset_size = 64 * sizeof(uint);
 
 // D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE = 2048
 sampler samplers[2048] : register(s0);
@@ -26,126 +26,137 @@ struct Resource_Handle
     {
         return this.index + 1;
     }
+
+    // Textures with a UAV have one UAV per mip level, laid out after the SRV.
+    uint write_index(uint mip)
+    {
+        return this.index + 1 + mip;
+    }
 };
 
+// Buffers may be suballocated from a shared buffer, `offset` is the byte offset of their data in it.
 struct Array_Buffer
 {
     Resource_Handle handle;
+    uint offset;
 
     template<typename T>
     T load(uint index)
     {
         ByteAddressBuffer buffer = ResourceDescriptorHeap[NonUniformResourceIndex(handle.read_index())];
-        return buffer.Load<T>(index * sizeof(T));
+        return buffer.Load<T>(offset + index * sizeof(T));
     }
 
     template<typename T>
     T load_uniform(uint index)
     {
         ByteAddressBuffer buffer = ResourceDescriptorHeap[handle.read_index()];
-        return buffer.Load<T>(index * sizeof(T));
+        return buffer.Load<T>(offset + index * sizeof(T));
     }
 };
 
 struct RW_Array_Buffer
 {
     Resource_Handle handle;
+    uint offset;
 
     template<typename T>
     T load(uint index)
     {
         ByteAddressBuffer buffer = ResourceDescriptorHeap[NonUniformResourceIndex(handle.read_index())];
-        return buffer.Load<T>(index * sizeof(T));
+        return buffer.Load<T>(offset + index * sizeof(T));
     }
 
     template<typename T>
     T load_uniform(uint index)
     {
         ByteAddressBuffer buffer = ResourceDescriptorHeap[handle.read_index()];
-        return buffer.Load<T>(index * sizeof(T));
+        return buffer.Load<T>(offset + index * sizeof(T));
     }
 
     template<typename T>
     void store(uint index, T value)
     {
         RWByteAddressBuffer buffer = ResourceDescriptorHeap[NonUniformResourceIndex(handle.write_index())];
-        buffer.Store(index * sizeof(T), value);
+        buffer.Store(offset + index * sizeof(T), value);
     }
 
     template<typename T>
     void store_uniform(uint index, T value)
     {
         RWByteAddressBuffer buffer = ResourceDescriptorHeap[handle.write_index()];
-        buffer.Store(index * sizeof(T), value);
+        buffer.Store(offset + index * sizeof(T), value);
     }
 };
 
 struct Raw_Buffer
 {
     Resource_Handle handle;
+    uint offset;
 
     template<typename T>
     T load()
     {
         ByteAddressBuffer buffer = ResourceDescriptorHeap[NonUniformResourceIndex(handle.read_index())];
-        return buffer.Load<T>(0);
+        return buffer.Load<T>(offset);
     }
 
     template<typename T>
     T load_uniform()
     {
         ByteAddressBuffer buffer = ResourceDescriptorHeap[handle.read_index()];
-        return buffer.Load<T>(0);
+        return buffer.Load<T>(offset);
     }
 };
 
 struct RW_Raw_Buffer
 {
     Resource_Handle handle;
+    uint offset;
 
     template<typename T>
     T load()
     {
         ByteAddressBuffer buffer = ResourceDescriptorHeap[NonUniformResourceIndex(handle.read_index())];
-        return buffer.Load<T>(0);
+        return buffer.Load<T>(offset);
     }
 
     template<typename T>
     T load_uniform()
     {
         ByteAddressBuffer buffer = ResourceDescriptorHeap[handle.read_index()];
-        return buffer.Load<T>(0);
+        return buffer.Load<T>(offset);
     }
 
     template<typename T>
     void store(T value)
     {
         RWByteAddressBuffer buffer = ResourceDescriptorHeap[NonUniformResourceIndex(handle.write_index())];
-        buffer.Store(0, value);
+        buffer.Store(offset, value);
     }
 
     template<typename T>
     void store_uniform(T value)
     {
         RWByteAddressBuffer buffer = ResourceDescriptorHeap[handle.write_index()];
-        buffer.Store(0, value);
+        buffer.Store(offset, value);
     }
 
     template<typename T>
-    uint interlocked_add(uint offset, uint value)
+    uint interlocked_add(uint byte_offset, uint value)
     {
         RWByteAddressBuffer buffer = ResourceDescriptorHeap[NonUniformResourceIndex(handle.write_index())];
         uint prev;
-        buffer.InterlockedAdd(offset, value, prev);
+        buffer.InterlockedAdd(offset + byte_offset, value, prev);
         return prev;
     }
 
     template<typename T>
-    uint interlocked_add_uniform(uint offset, uint value)
+    uint interlocked_add_uniform(uint byte_offset, uint value)
     {
         RWByteAddressBuffer buffer = ResourceDescriptorHeap[handle.write_index()];
         uint prev;
-        buffer.InterlockedAdd(offset, value, prev);
+        buffer.InterlockedAdd(offset + byte_offset, value, prev);
         return prev;
     }
 };
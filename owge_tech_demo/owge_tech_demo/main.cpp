@@ -71,7 +71,10 @@ int32_t main(uint32_t argc, const char* argv[])
     };
     owge::Render_Engine_Settings render_engine_settings = {
         .nvperf_enabled = d3d12_settings.enable_validation ? false : enable_nvperf_arg.getValue(),
-        .nvperf_lock_clocks_to_rated_tdp = false
+        .nvperf_lock_clocks_to_rated_tdp = false,
+        .bindset_page_upload_density = 0.5f,
+        .streaming_upload_budget = 8388608, // 8 MB
+        .recording_worker_count = 0
     };
     auto render_engine = std::make_unique<owge::Render_Engine>(
         window->get_hwnd(),
@@ -129,7 +132,7 @@ int32_t main(uint32_t argc, const char* argv[])
     auto imgui_render_procedure =
         std::make_unique<owge::Imgui_Render_Procedure>();
 
-    render_engine->add_procedure(ocean_simulation_render_procedure.get());
+    render_engine->add_async_compute_procedure(ocean_simulation_render_procedure.get());
     render_engine->add_procedure(swapchain_pass.get());
     swapchain_pass->add_subprocedure(ocean_surface_render_procedure.get());
     swapchain_pass->add_subprocedure(imgui_render_procedure.get());
@@ -0,0 +1,52 @@
+#include "test.hpp"
+
+#include <owge_common/block_allocator.hpp>
+
+namespace owge
+{
+OWGE_TEST(block_allocator, allocate_fails_until_a_block_is_added)
+{
+    Block_Allocator allocator(1024);
+    OWGE_CHECK(!allocator.allocate(16).is_valid());
+    auto block = allocator.add_block();
+    auto allocation = allocator.allocate(16, 256);
+    OWGE_CHECK(allocation.is_valid());
+    OWGE_CHECK(allocation.block == block);
+    OWGE_CHECK(!allocator.allocate(2048).is_valid());
+}
+
+OWGE_TEST(block_allocator, empty_blocks_are_reported_except_the_last)
+{
+    Block_Allocator allocator(1024);
+    (void)allocator.add_block();
+    auto first = allocator.allocate(1024);
+    OWGE_CHECK(!allocator.allocate(1).is_valid());
+    auto second_block = allocator.add_block();
+    auto second = allocator.allocate(512);
+    OWGE_CHECK(second.block == second_block);
+
+    OWGE_CHECK(allocator.free(second));
+    allocator.remove_block(second_block);
+    OWGE_CHECK(allocator.get_stats().block_count == 1);
+    OWGE_CHECK(!allocator.free(first));
+    OWGE_CHECK(allocator.get_stats().used_size == 0);
+}
+
+OWGE_TEST(block_allocator, removed_blocks_are_reused)
+{
+    Block_Allocator allocator(256);
+    auto first_block = allocator.add_block();
+    auto second_block = allocator.add_block();
+    auto first = allocator.allocate(256);
+    auto second = allocator.allocate(256);
+    OWGE_CHECK(first.block == first_block && second.block == second_block);
+
+    OWGE_CHECK(allocator.free(first));
+    allocator.remove_block(first_block);
+    OWGE_CHECK(allocator.add_block() == first_block);
+    auto stats = allocator.get_stats();
+    OWGE_CHECK(stats.block_count == 2);
+    OWGE_CHECK(stats.allocation_count == 1);
+    OWGE_CHECK(stats.largest_free_block == 256);
+}
+}
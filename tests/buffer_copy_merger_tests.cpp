@@ -0,0 +1,67 @@
+#include "test.hpp"
+
+#include <owge_common/buffer_copy_merger.hpp>
+
+#include <vector>
+
+namespace owge
+{
+struct Test_Copy
+{
+    uint32_t src;
+    uint64_t src_offset;
+    uint32_t dst;
+    uint64_t dst_offset;
+    uint64_t size;
+};
+
+[[nodiscard]] static std::vector<Test_Copy> merge(const std::vector<Test_Copy>& copies)
+{
+    std::vector<Test_Copy> sorted;
+    std::vector<Test_Copy> merged;
+    auto count = merge_buffer_copies(copies, sorted, [&](const Test_Copy& copy) {
+        merged.push_back(copy);
+    });
+    OWGE_CHECK(count == merged.size());
+    return merged;
+}
+
+OWGE_TEST(buffer_copy_merger, contiguous_copies_are_merged_across_submission_order)
+{
+    auto merged = merge({
+        { .src = 0, .src_offset = 16, .dst = 1, .dst_offset = 116, .size = 16 },
+        { .src = 0, .src_offset = 0, .dst = 1, .dst_offset = 100, .size = 16 },
+        { .src = 0, .src_offset = 32, .dst = 2, .dst_offset = 132, .size = 16 },
+        { .src = 0, .src_offset = 48, .dst = 1, .dst_offset = 200, .size = 16 }
+    });
+    OWGE_CHECK(merged.size() == 3);
+    OWGE_CHECK(merged[0].dst == 1 && merged[0].dst_offset == 100 && merged[0].src_offset == 0);
+    OWGE_CHECK(merged[0].size == 32);
+    OWGE_CHECK(merged[1].dst == 1 && merged[1].dst_offset == 200);
+    OWGE_CHECK(merged[2].dst == 2);
+}
+
+OWGE_TEST(buffer_copy_merger, overlapping_writes_keep_the_submission_order)
+{
+    auto merged = merge({
+        { .src = 0, .src_offset = 0, .dst = 1, .dst_offset = 64, .size = 16 },
+        { .src = 0, .src_offset = 16, .dst = 1, .dst_offset = 0, .size = 16 },
+        { .src = 0, .src_offset = 32, .dst = 1, .dst_offset = 16, .size = 16 },
+        { .src = 0, .src_offset = 48, .dst = 1, .dst_offset = 68, .size = 4 }
+    });
+    OWGE_CHECK(merged.size() == 3);
+    OWGE_CHECK(merged[0].dst_offset == 64);
+    OWGE_CHECK(merged[1].dst_offset == 0 && merged[1].size == 32);
+    OWGE_CHECK(merged[2].dst_offset == 68 && merged[2].src_offset == 48);
+}
+
+OWGE_TEST(buffer_copy_merger, copies_from_different_sources_stay_apart)
+{
+    auto merged = merge({
+        { .src = 0, .src_offset = 0, .dst = 1, .dst_offset = 0, .size = 16 },
+        { .src = 3, .src_offset = 16, .dst = 1, .dst_offset = 16, .size = 16 }
+    });
+    OWGE_CHECK(merged.size() == 2);
+    OWGE_CHECK(merge({}).empty());
+}
+}
@@ -0,0 +1,285 @@
+#include "test.hpp"
+
+#include <owge_common/command_stream.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace owge
+{
+struct Replayed_Draw
+{
+    uint64_t pipeline;
+    uint32_t constant;
+    uint32_t vertex_count;
+
+    bool operator==(const Replayed_Draw&) const = default;
+};
+
+// Replays the stream like a translator would, starting from the state left by earlier streams.
+struct Replay
+{
+    uint64_t pipeline;
+    uint32_t constant;
+    std::vector<Replayed_Draw> draws;
+    uint32_t state_packet_count = 0;
+
+    Replay(uint64_t initial_pipeline, uint32_t initial_constant)
+        : pipeline(initial_pipeline), constant(initial_constant)
+    {}
+
+    void run(const Command_Stream& stream)
+    {
+        stream.for_each([&](const Command_Header& header) {
+            switch (header.type)
+            {
+            case Command_Type::Set_Pipeline_State:
+                pipeline = Command_Stream::get_payload<Command_Set_Pipeline_State>(header).pipeline;
+                state_packet_count += 1;
+                break;
+            case Command_Type::Set_Constants:
+            {
+                auto& constants = Command_Stream::get_payload<Command_Set_Constants>(header);
+                if (constants.first_constant == 0 && constants.count > 0)
+                {
+                    std::memcpy(&constant, Command_Stream::get_trailing_data<Command_Set_Constants>(header),
+                        sizeof(uint32_t));
+                }
+                state_packet_count += 1;
+                break;
+            }
+            case Command_Type::Draw:
+                draws.push_back({
+                    .pipeline = pipeline,
+                    .constant = constant,
+                    .vertex_count = Command_Stream::get_payload<Command_Draw>(header).vertex_count
+                });
+                break;
+            default:
+                break;
+            }
+        });
+    }
+};
+
+static void push_pipeline(Command_Stream& stream, uint64_t pipeline)
+{
+    stream.push<Command_Set_Pipeline_State>(Command_Type::Set_Pipeline_State).pipeline = pipeline;
+}
+
+static void push_constant(Command_Stream& stream, uint32_t value)
+{
+    auto& constants = stream.push<Command_Set_Constants>(Command_Type::Set_Constants, sizeof(uint32_t));
+    constants = { .first_constant = 0, .count = 1, .graphics = true };
+    std::memcpy(Command_Stream::get_trailing_data(constants), &value, sizeof(uint32_t));
+}
+
+static void push_draw(Command_Stream& stream, uint32_t vertex_count)
+{
+    stream.push<Command_Draw>(Command_Type::Draw) = {
+        .vertex_count = vertex_count,
+        .vertex_offset = 0,
+        .instance_count = 1,
+        .instance_offset = 0
+    };
+}
+
+static void push_event(Command_Stream& stream, Command_Type type, const char* message)
+{
+    auto length = uint32_t(std::strlen(message));
+    auto& event = stream.push<Command_Event>(type, length + 1);
+    event.length = length;
+    std::memcpy(Command_Stream::get_trailing_data(event), message, length + 1);
+}
+
+OWGE_TEST(command_stream, validates_well_formed_streams)
+{
+    Command_Stream stream(256);
+    push_event(stream, Command_Type::Begin_Event, "Pass");
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        push_pipeline(stream, i % 3 + 1);
+        push_constant(stream, i);
+        push_draw(stream, i);
+    }
+    push_event(stream, Command_Type::Set_Marker, "Marker");
+    uint32_t open_event_count = 0;
+    OWGE_CHECK(stream.validate(open_event_count));
+    OWGE_CHECK(open_event_count == 1);
+
+    // Events may be closed by the next stream.
+    Command_Stream next;
+    next.push(Command_Type::End_Event);
+    OWGE_CHECK(next.validate(open_event_count));
+    OWGE_CHECK(open_event_count == 0);
+    OWGE_CHECK(!next.validate(open_event_count));
+}
+
+OWGE_TEST(command_stream, rejects_malformed_packets)
+{
+    uint32_t open_event_count = 0;
+    Command_Stream constants_out_of_range;
+    auto& constants = constants_out_of_range.push<Command_Set_Constants>(Command_Type::Set_Constants,
+        8 * sizeof(uint32_t));
+    constants = { .first_constant = COMMAND_STREAM_MAX_CONSTANTS - 4, .count = 8, .graphics = false };
+    OWGE_CHECK(!constants_out_of_range.validate(open_event_count));
+
+    Command_Stream missing_constants;
+    missing_constants.push<Command_Set_Constants>(Command_Type::Set_Constants) = {
+        .first_constant = 0,
+        .count = 4,
+        .graphics = false
+    };
+    OWGE_CHECK(!missing_constants.validate(open_event_count));
+
+    Command_Stream unterminated_marker;
+    auto& marker = unterminated_marker.push<Command_Event>(Command_Type::Set_Marker, 8);
+    marker.length = 8;
+    OWGE_CHECK(!unterminated_marker.validate(open_event_count));
+    OWGE_CHECK(open_event_count == 0);
+}
+
+OWGE_TEST(command_stream, sort_groups_work_by_pipeline)
+{
+    Command_Stream stream;
+    push_pipeline(stream, 1);
+    push_constant(stream, 10);
+    push_draw(stream, 0);
+    push_pipeline(stream, 2);
+    push_constant(stream, 20);
+    push_draw(stream, 1);
+    push_pipeline(stream, 1);
+    push_constant(stream, 10);
+    push_draw(stream, 2);
+    push_pipeline(stream, 2);
+    push_constant(stream, 21);
+    push_draw(stream, 3);
+    // Work is never moved across a barrier.
+    stream.push<Command_Barrier>(Command_Type::Barrier) = {};
+    push_pipeline(stream, 1);
+    push_draw(stream, 4);
+
+    Replay recorded(0, 0);
+    recorded.run(stream);
+    stream.sort_by_pipeline();
+    uint32_t open_event_count = 0;
+    OWGE_CHECK(stream.validate(open_event_count));
+    Replay sorted(0, 0);
+    sorted.run(stream);
+
+    OWGE_CHECK(sorted.draws == std::vector<Replayed_Draw>({
+        { .pipeline = 1, .constant = 10, .vertex_count = 0 },
+        { .pipeline = 1, .constant = 10, .vertex_count = 2 },
+        { .pipeline = 2, .constant = 20, .vertex_count = 1 },
+        { .pipeline = 2, .constant = 21, .vertex_count = 3 },
+        { .pipeline = 1, .constant = 21, .vertex_count = 4 }
+    }));
+    OWGE_CHECK(sorted.pipeline == recorded.pipeline && sorted.constant == recorded.constant);
+    OWGE_CHECK(sorted.state_packet_count < recorded.state_packet_count);
+}
+
+OWGE_TEST(command_stream, sort_keeps_state_from_before_the_stream)
+{
+    // The first draw uses the constant set before the stream, so it can't move behind the draw that sets it.
+    Command_Stream stream;
+    push_pipeline(stream, 2);
+    push_draw(stream, 0);
+    push_pipeline(stream, 1);
+    push_constant(stream, 5);
+    push_draw(stream, 1);
+    push_pipeline(stream, 2);
+    push_draw(stream, 2);
+
+    Replay recorded(7, 7);
+    recorded.run(stream);
+    stream.sort_by_pipeline();
+    Replay sorted(7, 7);
+    sorted.run(stream);
+
+    OWGE_CHECK(sorted.draws.size() == 3);
+    OWGE_CHECK(sorted.draws[0] == recorded.draws[0]);
+    for (const auto& draw : recorded.draws)
+    {
+        OWGE_CHECK(std::ranges::find(sorted.draws, draw) != sorted.draws.end());
+    }
+    OWGE_CHECK(sorted.pipeline == recorded.pipeline && sorted.constant == recorded.constant);
+
+    // Work recorded before the first pipeline keeps the pipeline from before the stream.
+    Command_Stream no_pipeline;
+    push_draw(no_pipeline, 0);
+    push_pipeline(no_pipeline, 1);
+    push_draw(no_pipeline, 1);
+    no_pipeline.sort_by_pipeline();
+    Replay replay(7, 7);
+    replay.run(no_pipeline);
+    OWGE_CHECK(replay.draws == std::vector<Replayed_Draw>({
+        { .pipeline = 7, .constant = 7, .vertex_count = 0 },
+        { .pipeline = 1, .constant = 7, .vertex_count = 1 }
+    }));
+}
+
+OWGE_TEST(command_stream, sort_ignores_header_padding)
+{
+    Command_Stream stream;
+    push_pipeline(stream, 1);
+    push_draw(stream, 0);
+    push_pipeline(stream, 1);
+    push_draw(stream, 1);
+    // The header's padding bytes are never initialized.
+    stream.for_each([](const Command_Header& header) {
+        auto bytes = reinterpret_cast<std::byte*>(const_cast<Command_Header*>(&header));
+        std::memset(bytes + sizeof(Command_Type), 0xCD, offsetof(Command_Header, size) - sizeof(Command_Type));
+    });
+
+    stream.sort_by_pipeline();
+    Replay replay(0, 0);
+    replay.run(stream);
+    OWGE_CHECK(replay.state_packet_count == 1);
+    OWGE_CHECK(replay.draws.size() == 2);
+}
+
+OWGE_TEST(command_stream, sort_reuses_chunks_across_frames)
+{
+    Command_Stream stream(64);
+    for (uint32_t frame = 0; frame < 4; ++frame)
+    {
+        stream.reset();
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            push_pipeline(stream, i % 2 + 1);
+            push_draw(stream, i + frame);
+        }
+        stream.sort_by_pipeline();
+        Replay replay(0, 0);
+        replay.run(stream);
+        OWGE_CHECK(replay.state_packet_count == 2);
+        OWGE_CHECK(replay.draws.size() == 8);
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            OWGE_CHECK(replay.draws[i].pipeline == (i < 4 ? 1u : 2u));
+            OWGE_CHECK(replay.draws[i].vertex_count == (i < 4 ? 2 * i : 2 * (i - 4) + 1) + frame);
+        }
+    }
+}
+
+OWGE_TEST(command_stream, reset_keeps_chunks)
+{
+    Command_Stream stream(64);
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        push_draw(stream, i);
+    }
+    auto size = stream.get_size();
+    stream.reset();
+    OWGE_CHECK(stream.empty());
+    OWGE_CHECK(stream.get_size() == 0);
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        push_draw(stream, i);
+    }
+    OWGE_CHECK(stream.get_size() == size);
+    OWGE_CHECK(stream.get_packet_count() == 16);
+}
+}
@@ -0,0 +1,45 @@
+#include "test.hpp"
+
+#include <owge_common/dirty_range_merger.hpp>
+
+#include <vector>
+
+namespace owge
+{
+OWGE_TEST(dirty_range_merger, overlapping_and_touching_ranges_are_merged)
+{
+    std::vector<Dirty_Range> ranges = {
+        { .buffer = 2, .begin = 0, .end = 16 },
+        { .buffer = 1, .begin = 32, .end = 48 },
+        { .buffer = 1, .begin = 0, .end = 16 },
+        { .buffer = 1, .begin = 16, .end = 20 },
+        { .buffer = 1, .begin = 8, .end = 12 },
+        { .buffer = 1, .begin = 32, .end = 40 }
+    };
+    merge_dirty_ranges(ranges);
+    OWGE_CHECK(ranges.size() == 3);
+    OWGE_CHECK(ranges[0].buffer == 1 && ranges[0].begin == 0 && ranges[0].end == 20);
+    OWGE_CHECK(ranges[1].buffer == 1 && ranges[1].begin == 32 && ranges[1].end == 48);
+    OWGE_CHECK(ranges[2].buffer == 2);
+}
+
+OWGE_TEST(dirty_range_merger, only_dense_pages_are_appended)
+{
+    std::vector<Dirty_Range> ranges = {
+        { .buffer = 1, .begin = 0, .end = 40 },
+        { .buffer = 1, .begin = 64, .end = 100 },
+        { .buffer = 1, .begin = 120, .end = 130 },
+        { .buffer = 2, .begin = 200, .end = 210 }
+    };
+    std::vector<Dirty_Range> pages;
+    append_dense_pages(ranges, 128, 64, [](uint64_t buffer) { return buffer == 1 ? 1000 : 220; }, pages);
+    OWGE_CHECK(pages.size() == 1);
+    OWGE_CHECK(pages[0].buffer == 1 && pages[0].begin == 0 && pages[0].end == 128);
+
+    pages.clear();
+    append_dense_pages(ranges, 128, 10, [](uint64_t buffer) { return buffer == 1 ? 1000 : 220; }, pages);
+    OWGE_CHECK(pages.size() == 2);
+    OWGE_CHECK(pages[0].buffer == 1 && pages[0].begin == 0);
+    OWGE_CHECK(pages[1].buffer == 2 && pages[1].begin == 128 && pages[1].end == 220);
+}
+}
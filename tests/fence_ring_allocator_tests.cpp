@@ -0,0 +1,115 @@
+#include "test.hpp"
+
+#include <owge_common/fence_ring_allocator.hpp>
+
+#include <deque>
+#include <random>
+
+namespace owge
+{
+// Stands in for an ID3D12Fence, the GPU completes submissions `latency` submits after they were made.
+struct Simulated_Fence
+{
+    uint64_t latency;
+    uint64_t next_value = 1;
+
+    [[nodiscard]] uint64_t signal()
+    {
+        return next_value++;
+    }
+    [[nodiscard]] uint64_t get_completed_value() const
+    {
+        return next_value > latency ? next_value - 1 - latency : 0;
+    }
+};
+
+OWGE_TEST(fence_ring_allocator, space_is_reclaimed_once_the_fence_completes)
+{
+    Fence_Ring_Allocator allocator(1024);
+    Simulated_Fence fence = { .latency = 1 };
+    OWGE_CHECK(allocator.allocate(1024) == 0);
+    allocator.submit(fence.signal());
+    OWGE_CHECK(allocator.allocate(1) == FENCE_RING_NO_ALLOCATION);
+
+    allocator.reclaim(fence.get_completed_value());
+    OWGE_CHECK(allocator.used_size() == 1024);
+    allocator.submit(fence.signal());
+    allocator.reclaim(fence.get_completed_value());
+    OWGE_CHECK(allocator.used_size() == 0);
+    OWGE_CHECK(allocator.allocate(512) == 0);
+}
+
+OWGE_TEST(fence_ring_allocator, allocations_that_would_wrap_start_at_the_front)
+{
+    Fence_Ring_Allocator allocator(1024);
+    OWGE_CHECK(allocator.allocate(600) == 0);
+    allocator.submit(1);
+    allocator.reclaim(1);
+    OWGE_CHECK(allocator.allocate(300, 256) == 0);
+    // The skipped tail end of the ring is still accounted for until the allocation is reclaimed.
+    OWGE_CHECK(allocator.used_size() == 724);
+    OWGE_CHECK(allocator.allocate(16, 16) == 304);
+}
+
+OWGE_TEST(fence_ring_allocator, live_allocations_never_overlap)
+{
+    static constexpr uint64_t CAPACITY = 65536;
+    struct Live_Allocation
+    {
+        uint64_t fence_value;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    Fence_Ring_Allocator allocator(CAPACITY);
+    Simulated_Fence fence = { .latency = 2 };
+    std::deque<Live_Allocation> live;
+    std::mt19937 random(11);
+    uint64_t failed_count = 0;
+    for (uint32_t frame = 0; frame < 2000; ++frame)
+    {
+        auto fence_value = fence.next_value;
+        for (uint32_t i = random() % 32; i > 0; --i)
+        {
+            auto size = 1 + random() % 2048;
+            auto offset = allocator.allocate(size, 1ull << (random() % 9));
+            if (offset == FENCE_RING_NO_ALLOCATION)
+            {
+                failed_count += 1;
+                continue;
+            }
+            OWGE_CHECK(offset + size <= CAPACITY);
+            for (const auto& other : live)
+            {
+                OWGE_CHECK(offset >= other.offset + other.size || other.offset >= offset + size);
+            }
+            live.push_back({ .fence_value = fence_value, .offset = offset, .size = size });
+        }
+        allocator.submit(fence.signal());
+
+        auto completed = fence.get_completed_value();
+        allocator.reclaim(completed);
+        while (!live.empty() && live.front().fence_value <= completed)
+        {
+            live.pop_front();
+        }
+    }
+    OWGE_CHECK(failed_count > 0);
+}
+
+OWGE_TEST(fence_ring_allocator, shrinks_after_a_full_window_of_low_usage)
+{
+    Fence_Ring_Allocator allocator(4096);
+    for (uint32_t i = 1; i < Fence_Ring_Allocator::SHRINK_WINDOW; ++i)
+    {
+        (void)allocator.allocate(1024);
+        allocator.submit(i);
+        allocator.reclaim(i);
+    }
+    OWGE_CHECK(allocator.get_shrink_capacity(256) == 4096);
+    (void)allocator.allocate(1024);
+    allocator.submit(Fence_Ring_Allocator::SHRINK_WINDOW);
+    OWGE_CHECK(allocator.get_shrink_capacity(256) == 2048);
+    OWGE_CHECK(allocator.get_shrink_capacity(4096) == 4096);
+}
+}
@@ -0,0 +1,132 @@
+#include "test.hpp"
+
+#include <owge_common/index_range_allocator.hpp>
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace owge
+{
+OWGE_TEST(index_range_allocator, freed_ranges_are_reused_by_their_count)
+{
+    Index_Range_Allocator allocator(4096);
+    auto first = allocator.allocate(2);
+    auto second = allocator.allocate(2);
+    OWGE_CHECK(first.is_valid() && second.is_valid());
+    OWGE_CHECK(first.count == 2 && second.count == 2);
+    OWGE_CHECK(first.offset + 2 <= second.offset || second.offset + 2 <= first.offset);
+    OWGE_CHECK(allocator.get_allocated_count() == 4);
+
+    allocator.free(first.allocation);
+    OWGE_CHECK(allocator.get_allocated_count() == 2);
+    auto reused = allocator.allocate(2);
+    OWGE_CHECK(reused.offset == first.offset);
+    // Other counts don't take ranges freed by this one.
+    allocator.free(reused.allocation);
+    OWGE_CHECK(allocator.allocate(1).offset != first.offset);
+}
+
+OWGE_TEST(index_range_allocator, large_ranges_coalesce_when_freed)
+{
+    Index_Range_Allocator allocator(256);
+    auto first = allocator.allocate(128);
+    auto second = allocator.allocate(128);
+    OWGE_CHECK(first.is_valid() && second.is_valid());
+    OWGE_CHECK(!allocator.allocate(17).is_valid());
+    allocator.free(first.allocation);
+    allocator.free(second.allocation);
+    OWGE_CHECK(allocator.get_allocated_count() == 0);
+    auto whole = allocator.allocate(256);
+    OWGE_CHECK(whole.is_valid() && whole.offset == 0);
+}
+
+OWGE_TEST(index_range_allocator, batches_shrink_when_nearly_full)
+{
+    // Too small for a whole batch, every index is still handed out.
+    Index_Range_Allocator allocator(40);
+    std::vector<uint32_t> owners(40, 0);
+    uint32_t allocated_count = 0;
+    for (auto range = allocator.allocate(4); range.is_valid(); range = allocator.allocate(4))
+    {
+        for (auto i = range.offset; i < range.offset + range.count; ++i)
+        {
+            owners[i] += 1;
+        }
+        allocated_count += range.count;
+    }
+    OWGE_CHECK(allocated_count == 40);
+    OWGE_CHECK(allocator.get_allocated_count() == 40);
+    for (auto owner : owners)
+    {
+        OWGE_CHECK(owner == 1);
+    }
+    OWGE_CHECK(!allocator.allocate(1).is_valid());
+    OWGE_CHECK(!allocator.allocate(0).is_valid());
+}
+
+OWGE_TEST(index_range_allocator, concurrent_ranges_never_overlap)
+{
+    static constexpr uint32_t THREAD_COUNT = 8;
+    static constexpr uint32_t SIZE = 65536;
+    Index_Range_Allocator allocator(SIZE);
+    auto owners = std::make_unique<std::atomic<uint32_t>[]>(SIZE);
+    std::atomic<uint32_t> overlap_count = 0;
+    std::atomic<uint32_t> failed_count = 0;
+
+    std::vector<std::jthread> threads;
+    for (uint32_t thread = 0; thread < THREAD_COUNT; ++thread)
+    {
+        threads.emplace_back([&, thread]() {
+            std::mt19937 random(thread);
+            std::vector<Index_Range> live;
+            for (uint32_t i = 0; i < 20000; ++i)
+            {
+                if (live.size() > 64 || (!live.empty() && random() % 2 == 0))
+                {
+                    auto index = random() % live.size();
+                    auto range = live[index];
+                    live[index] = live.back();
+                    live.pop_back();
+                    for (auto j = range.offset; j < range.offset + range.count; ++j)
+                    {
+                        owners[j].store(0, std::memory_order_relaxed);
+                    }
+                    allocator.free(range.allocation);
+                    continue;
+                }
+                // Mostly descriptor table sizes, sometimes a range too large to be cached.
+                auto count = random() % 8 == 0 ? 17 + random() % 16 : 1 + random() % 16;
+                auto range = allocator.allocate(count);
+                if (!range.is_valid())
+                {
+                    failed_count += 1;
+                    continue;
+                }
+                for (auto j = range.offset; j < range.offset + range.count; ++j)
+                {
+                    if (owners[j].exchange(thread + 1, std::memory_order_relaxed) != 0)
+                    {
+                        overlap_count += 1;
+                    }
+                }
+                live.push_back(range);
+            }
+            for (const auto& range : live)
+            {
+                for (auto j = range.offset; j < range.offset + range.count; ++j)
+                {
+                    owners[j].store(0, std::memory_order_relaxed);
+                }
+                allocator.free(range.allocation);
+            }
+        });
+    }
+    threads.clear();
+    OWGE_CHECK(overlap_count == 0);
+    OWGE_CHECK(failed_count == 0);
+    OWGE_CHECK(allocator.get_allocated_count() == 0);
+}
+}
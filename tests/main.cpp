@@ -0,0 +1,54 @@
+#include "test.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+namespace owge::test
+{
+static uint32_t s_failure_count = 0;
+
+std::vector<Test_Case>& get_test_cases()
+{
+    static std::vector<Test_Case> test_cases;
+    return test_cases;
+}
+
+void report_failure(const char* file, int line, const char* expression)
+{
+    std::printf("%s:%d: check failed: %s\n", file, line, expression);
+    s_failure_count += 1;
+}
+}
+
+int main(int argc, char** argv)
+{
+    using namespace owge::test;
+
+    const char* suite = argc > 1 ? argv[1] : nullptr;
+    uint32_t run_count = 0;
+    uint32_t failed_count = 0;
+    for (const auto& test_case : get_test_cases())
+    {
+        if (suite != nullptr && std::strcmp(suite, test_case.suite) != 0)
+        {
+            continue;
+        }
+        auto failure_count = s_failure_count;
+        try
+        {
+            test_case.run();
+        }
+        catch (const std::exception& exception)
+        {
+            std::printf("unexpected exception: %s\n", exception.what());
+            s_failure_count += 1;
+        }
+        auto failed = s_failure_count != failure_count;
+        std::printf("[%s] %s.%s\n", failed ? "FAILED" : "passed", test_case.suite, test_case.name);
+        run_count += 1;
+        failed_count += failed ? 1 : 0;
+    }
+    std::printf("%u of %u tests passed.\n", run_count - failed_count, run_count);
+    return run_count == 0 || failed_count > 0 ? 1 : 0;
+}
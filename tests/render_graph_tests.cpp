@@ -0,0 +1,260 @@
+#include "test.hpp"
+
+#include <owge_common/render_graph.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace owge
+{
+static constexpr Render_Graph_Resource_Desc TRANSIENT_TEXTURE = {
+    .texture = true,
+    .imported = false,
+    .exported = false,
+    .initial_access = Render_Graph_Access::None,
+    .final_access = Render_Graph_Access::None,
+    .size = 1024,
+    .alignment = 256
+};
+
+static constexpr Render_Graph_Resource_Desc EXPORTED_TEXTURE = {
+    .texture = true,
+    .imported = true,
+    .exported = true,
+    .initial_access = Render_Graph_Access::Pixel_Shader_Read,
+    .final_access = Render_Graph_Access::None,
+    .size = 0,
+    .alignment = 0
+};
+
+static constexpr Render_Graph_Pass_Desc DIRECT_PASS = { .async_compute = false, .side_effects = false };
+static constexpr Render_Graph_Pass_Desc ASYNC_COMPUTE_PASS = { .async_compute = true, .side_effects = false };
+static constexpr Render_Graph_Pass_Desc SIDE_EFFECT_PASS = { .async_compute = false, .side_effects = true };
+
+[[nodiscard]] static std::vector<uint32_t> get_pass_order(const Compiled_Render_Graph& compiled)
+{
+    std::vector<uint32_t> order;
+    for (const auto& pass : compiled.passes)
+    {
+        order.push_back(pass.pass);
+    }
+    return order;
+}
+
+OWGE_TEST(render_graph, culls_passes_whose_results_are_unused)
+{
+    Render_Graph graph;
+    auto intermediate = graph.add_resource(TRANSIENT_TEXTURE);
+    auto output = graph.add_resource(EXPORTED_TEXTURE);
+    auto unused = graph.add_resource(TRANSIENT_TEXTURE);
+    auto producer = graph.add_pass(DIRECT_PASS);
+    auto consumer = graph.add_pass(DIRECT_PASS);
+    auto dead = graph.add_pass(DIRECT_PASS);
+    graph.use(producer, intermediate, Render_Graph_Access::Unordered_Access);
+    graph.use(consumer, intermediate, Render_Graph_Access::Compute_Shader_Read);
+    graph.use(consumer, output, Render_Graph_Access::Unordered_Access);
+    graph.use(dead, unused, Render_Graph_Access::Unordered_Access);
+
+    auto compiled = graph.compile();
+    OWGE_CHECK(get_pass_order(compiled) == std::vector<uint32_t>({ producer, consumer }));
+    OWGE_CHECK(compiled.culled_passes == std::vector<uint32_t>({ dead }));
+    OWGE_CHECK(compiled.transient_placements[unused].offset == RENDER_GRAPH_NO_OFFSET);
+}
+
+OWGE_TEST(render_graph, side_effects_keep_a_pass)
+{
+    Render_Graph graph;
+    auto texture = graph.add_resource(TRANSIENT_TEXTURE);
+    auto producer = graph.add_pass(DIRECT_PASS);
+    auto readback = graph.add_pass(SIDE_EFFECT_PASS);
+    auto empty = graph.add_pass(SIDE_EFFECT_PASS);
+    graph.use(producer, texture, Render_Graph_Access::Render_Target);
+    graph.use(readback, texture, Render_Graph_Access::Copy_Source);
+
+    auto compiled = graph.compile();
+    OWGE_CHECK(get_pass_order(compiled) == std::vector<uint32_t>({ producer, readback, empty }));
+    OWGE_CHECK(compiled.culled_passes.empty());
+}
+
+OWGE_TEST(render_graph, copies_overwrite_without_consuming)
+{
+    Render_Graph graph;
+    auto output = graph.add_resource(EXPORTED_TEXTURE);
+    auto overwritten = graph.add_pass(DIRECT_PASS);
+    auto copy = graph.add_pass(DIRECT_PASS);
+    graph.use(overwritten, output, Render_Graph_Access::Unordered_Access);
+    graph.use(copy, output, Render_Graph_Access::Copy_Dest);
+
+    auto compiled = graph.compile();
+    OWGE_CHECK(get_pass_order(compiled) == std::vector<uint32_t>({ copy }));
+    OWGE_CHECK(compiled.culled_passes == std::vector<uint32_t>({ overwritten }));
+}
+
+OWGE_TEST(render_graph, independent_async_compute_passes_go_first)
+{
+    Render_Graph graph;
+    auto texture = graph.add_resource(EXPORTED_TEXTURE);
+    auto direct = graph.add_pass(SIDE_EFFECT_PASS);
+    auto async_compute = graph.add_pass(ASYNC_COMPUTE_PASS);
+    graph.use(async_compute, texture, Render_Graph_Access::Unordered_Access);
+
+    auto compiled = graph.compile();
+    OWGE_CHECK(get_pass_order(compiled) == std::vector<uint32_t>({ async_compute, direct }));
+    OWGE_CHECK(compiled.passes[0].queue == Render_Graph_Queue::Async_Compute);
+    OWGE_CHECK(compiled.passes[1].queue == Render_Graph_Queue::Direct);
+    OWGE_CHECK(compiled.passes[1].wait_pass == RENDER_GRAPH_NO_PASS);
+    OWGE_CHECK(!compiled.passes[0].signal);
+}
+
+OWGE_TEST(render_graph, cross_queue_dependencies_wait_on_a_signal)
+{
+    Render_Graph graph;
+    auto texture = graph.add_resource(EXPORTED_TEXTURE);
+    auto target = graph.add_resource(EXPORTED_TEXTURE);
+    auto simulation = graph.add_pass(ASYNC_COMPUTE_PASS);
+    auto draw = graph.add_pass(DIRECT_PASS);
+    auto async_draw = graph.add_pass(ASYNC_COMPUTE_PASS);
+    graph.use(simulation, texture, Render_Graph_Access::Unordered_Access);
+    graph.use(draw, texture, Render_Graph_Access::Vertex_Shader_Read);
+    graph.use(draw, target, Render_Graph_Access::Render_Target);
+    // Render targets can't be used on the async compute queue.
+    graph.use(async_draw, target, Render_Graph_Access::Render_Target);
+
+    auto compiled = graph.compile();
+    OWGE_CHECK(get_pass_order(compiled) == std::vector<uint32_t>({ simulation, draw, async_draw }));
+    OWGE_CHECK(compiled.passes[0].queue == Render_Graph_Queue::Async_Compute);
+    OWGE_CHECK(compiled.passes[0].signal);
+    OWGE_CHECK(compiled.passes[1].wait_pass == 0);
+    OWGE_CHECK(compiled.passes[2].queue == Render_Graph_Queue::Direct);
+    OWGE_CHECK(compiled.passes[2].wait_pass == RENDER_GRAPH_NO_PASS);
+
+    OWGE_CHECK(compiled.passes[1].barrier_count == 2);
+    const auto& barrier = compiled.barriers[compiled.passes[1].first_barrier];
+    OWGE_CHECK(barrier.resource == texture);
+    OWGE_CHECK(barrier.access_before == get_render_graph_access_bit(Render_Graph_Access::Unordered_Access));
+    OWGE_CHECK(barrier.access_after == Render_Graph_Access::Vertex_Shader_Read);
+    OWGE_CHECK(barrier.queue_transfer);
+}
+
+OWGE_TEST(render_graph, reads_in_the_same_layout_share_a_barrier)
+{
+    Render_Graph graph;
+    auto texture = graph.add_resource({
+        .texture = true,
+        .imported = true,
+        .exported = false,
+        .initial_access = Render_Graph_Access::Unordered_Access,
+        .final_access = Render_Graph_Access::None,
+        .size = 0,
+        .alignment = 0
+    });
+    auto buffer = graph.add_resource({
+        .texture = false,
+        .imported = true,
+        .exported = false,
+        .initial_access = Render_Graph_Access::Compute_Shader_Read,
+        .final_access = Render_Graph_Access::None,
+        .size = 0,
+        .alignment = 0
+    });
+    std::vector<uint32_t> passes;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        passes.push_back(graph.add_pass(SIDE_EFFECT_PASS));
+    }
+    graph.use(passes[0], texture, Render_Graph_Access::Pixel_Shader_Read);
+    graph.use(passes[1], texture, Render_Graph_Access::Compute_Shader_Read);
+    graph.use(passes[2], texture, Render_Graph_Access::Vertex_Shader_Read);
+    graph.use(passes[3], texture, Render_Graph_Access::Unordered_Access);
+    // Buffers don't have layouts, reads never need a barrier.
+    graph.use(passes[0], buffer, Render_Graph_Access::Index_Buffer);
+    graph.use(passes[1], buffer, Render_Graph_Access::Copy_Source);
+
+    auto compiled = graph.compile();
+    OWGE_CHECK(compiled.barriers.size() == 2);
+    OWGE_CHECK(compiled.passes[0].barrier_count == 1);
+    OWGE_CHECK(compiled.passes[1].barrier_count == 0);
+    OWGE_CHECK(compiled.passes[2].barrier_count == 0);
+    OWGE_CHECK(compiled.passes[3].barrier_count == 1);
+    OWGE_CHECK(std::ranges::all_of(compiled.barriers, [&](const Render_Graph_Barrier& barrier) {
+        return barrier.resource == texture && !barrier.queue_transfer;
+    }));
+    OWGE_CHECK(compiled.barriers[1].access_before == (
+        get_render_graph_access_bit(Render_Graph_Access::Pixel_Shader_Read) |
+        get_render_graph_access_bit(Render_Graph_Access::Compute_Shader_Read) |
+        get_render_graph_access_bit(Render_Graph_Access::Vertex_Shader_Read)));
+}
+
+OWGE_TEST(render_graph, repeated_usages_in_a_pass_need_one_barrier)
+{
+    Render_Graph graph;
+    auto texture = graph.add_resource(EXPORTED_TEXTURE);
+    auto pass = graph.add_pass(DIRECT_PASS);
+    graph.use(pass, texture, Render_Graph_Access::Unordered_Access);
+    graph.use(pass, texture, Render_Graph_Access::Unordered_Access);
+
+    auto compiled = graph.compile();
+    OWGE_CHECK(compiled.barriers.size() == 1);
+}
+
+OWGE_TEST(render_graph, exported_resources_end_in_their_final_access)
+{
+    Render_Graph graph;
+    auto swapchain = graph.add_resource({
+        .texture = true,
+        .imported = true,
+        .exported = true,
+        .initial_access = Render_Graph_Access::None,
+        .final_access = Render_Graph_Access::Present,
+        .size = 0,
+        .alignment = 0
+    });
+    auto pass = graph.add_pass(DIRECT_PASS);
+    graph.use(pass, swapchain, Render_Graph_Access::Render_Target);
+
+    auto compiled = graph.compile();
+    OWGE_CHECK(compiled.barriers.size() == 1);
+    OWGE_CHECK(compiled.barriers[0].access_before == 0);
+    OWGE_CHECK(compiled.final_barriers.size() == 1);
+    OWGE_CHECK(compiled.final_barriers[0].access_before ==
+        get_render_graph_access_bit(Render_Graph_Access::Render_Target));
+    OWGE_CHECK(compiled.final_barriers[0].access_after == Render_Graph_Access::Present);
+}
+
+OWGE_TEST(render_graph, transients_with_disjoint_lifetimes_alias)
+{
+    Render_Graph graph;
+    auto first = graph.add_resource(TRANSIENT_TEXTURE);
+    auto output = graph.add_resource(EXPORTED_TEXTURE);
+    auto second = graph.add_resource(TRANSIENT_TEXTURE);
+    std::vector<uint32_t> passes;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        passes.push_back(graph.add_pass(DIRECT_PASS));
+    }
+    graph.use(passes[0], first, Render_Graph_Access::Unordered_Access);
+    graph.use(passes[1], first, Render_Graph_Access::Compute_Shader_Read);
+    graph.use(passes[1], output, Render_Graph_Access::Unordered_Access);
+    graph.use(passes[2], second, Render_Graph_Access::Unordered_Access);
+    graph.use(passes[3], second, Render_Graph_Access::Compute_Shader_Read);
+    graph.use(passes[3], output, Render_Graph_Access::Unordered_Access);
+
+    auto compiled = graph.compile();
+    OWGE_CHECK(compiled.culled_passes.empty());
+    OWGE_CHECK(compiled.transient_heap_size == 1024);
+    OWGE_CHECK(compiled.transient_placements[first].next_resource == second);
+    OWGE_CHECK(compiled.transient_placements[second].previous_resource == first);
+    OWGE_CHECK(compiled.transient_placements[output].offset == RENDER_GRAPH_NO_OFFSET);
+}
+
+OWGE_TEST(render_graph, clear_keeps_nothing)
+{
+    Render_Graph graph;
+    auto texture = graph.add_resource(EXPORTED_TEXTURE);
+    graph.use(graph.add_pass(DIRECT_PASS), texture, Render_Graph_Access::Render_Target);
+    graph.clear();
+    OWGE_CHECK(graph.get_pass_count() == 0);
+    OWGE_CHECK(graph.get_resource_count() == 0);
+    OWGE_CHECK(graph.compile().passes.empty());
+}
+}
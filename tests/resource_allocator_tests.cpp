@@ -0,0 +1,147 @@
+#include "test.hpp"
+
+#include <owge_render_engine/resource_allocator.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace owge
+{
+struct Test_Resource
+{
+    uint64_t value;
+};
+
+struct Test_Resource_Desc
+{
+    uint32_t value;
+};
+
+OWGE_TEST(resource_allocator, removed_slots_are_reused_with_a_new_generation)
+{
+    Resource_Allocator<Test_Resource> allocator(16);
+    auto first = allocator.insert(0, 0, { .value = 1 });
+    allocator.remove(first);
+    auto second = allocator.insert(0, 0, { .value = 2 });
+    OWGE_CHECK(second.resource_idx == first.resource_idx);
+    OWGE_CHECK(second.gen == first.gen + 1);
+    OWGE_CHECK(allocator[second].value == 2);
+    OWGE_CHECK(allocator.size() == 1);
+}
+
+OWGE_TEST(resource_allocator, pages_are_committed_on_demand)
+{
+    Resource_Allocator<Test_Resource> allocator(1 << 20);
+    OWGE_CHECK(allocator.committed_pages() == 0);
+    auto handle = allocator.insert(0, 0, {});
+    OWGE_CHECK(allocator.committed_pages() == 1);
+    allocator.remove(handle);
+    OWGE_CHECK(allocator.committed_pages() == 1);
+}
+
+OWGE_TEST(resource_allocator, references_stay_valid_while_growing)
+{
+    Resource_Allocator<Test_Resource> allocator(1 << 16);
+    auto emplaced = allocator.emplace(0, 0);
+    emplaced.value.value = 42;
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        (void)allocator.insert(0, 0, { .value = i });
+    }
+    OWGE_CHECK(&allocator[emplaced.handle] == &emplaced.value);
+    OWGE_CHECK(emplaced.value.value == 42);
+}
+
+OWGE_TEST(resource_allocator, cold_data_is_stored_next_to_the_hot_data)
+{
+    Resource_Allocator<Test_Resource, Test_Resource_Desc> allocator(16);
+    auto handle = allocator.insert(0, 0, { .value = 1 }, { .value = 2 });
+    OWGE_CHECK(allocator[handle].value == 1);
+    OWGE_CHECK(allocator.cold_at(handle).value == 2);
+    allocator.remove(handle);
+    OWGE_CHECK(allocator.cold(handle).value == 0);
+}
+
+OWGE_TEST(resource_allocator, handles_keep_the_missing_bindless_index)
+{
+    Resource_Allocator<Test_Resource> allocator(16);
+    auto handle = allocator.insert(0, NO_BINDLESS_IDX, {});
+    OWGE_CHECK(handle.bindless_idx == NO_BINDLESS_IDX);
+    OWGE_CHECK(!handle.is_null_handle());
+    OWGE_CHECK(allocator.insert(0, 999999, {}).get_bindless_idx() == 999999);
+}
+
+OWGE_TEST(resource_allocator, insert_throws_when_full)
+{
+    Resource_Allocator<Test_Resource> allocator(2);
+    auto first = allocator.insert(0, 0, {});
+    (void)allocator.insert(0, 0, {});
+    bool threw = false;
+    try
+    {
+        (void)allocator.insert(0, 0, {});
+    }
+    catch (const std::length_error&)
+    {
+        threw = true;
+    }
+    OWGE_CHECK(threw);
+    OWGE_CHECK(allocator.size() == 2);
+    allocator.remove(first);
+    OWGE_CHECK(allocator.insert(0, 0, {}).resource_idx == first.resource_idx);
+}
+
+OWGE_TEST(resource_allocator, concurrent_insert_and_remove)
+{
+    static constexpr uint32_t THREAD_COUNT = 8;
+    static constexpr uint32_t ITERATION_COUNT = 20000;
+    static constexpr uint32_t LIVE_COUNT = 64;
+    Resource_Allocator<Test_Resource, Test_Resource_Desc> allocator(THREAD_COUNT * LIVE_COUNT);
+    std::atomic<uint32_t> corrupted_count = 0;
+    std::vector<std::vector<Base_Resource_Handle<Test_Resource>>> live(THREAD_COUNT);
+    std::vector<std::jthread> threads;
+    for (uint32_t thread = 0; thread < THREAD_COUNT; ++thread)
+    {
+        threads.emplace_back([&, thread]() {
+            std::mt19937 random(thread);
+            auto& handles = live[thread];
+            for (uint32_t i = 0; i < ITERATION_COUNT; ++i)
+            {
+                if (handles.size() == LIVE_COUNT || (!handles.empty() && random() % 2 == 0))
+                {
+                    auto index = random() % handles.size();
+                    auto handle = handles[index];
+                    auto expected = allocator.cold(handle).value;
+                    corrupted_count += allocator[handle].value != (uint64_t(thread) << 32 | expected) ? 1 : 0;
+                    allocator.remove(handle);
+                    handles[index] = handles.back();
+                    handles.pop_back();
+                }
+                else
+                {
+                    handles.push_back(allocator.insert(0, 0, { .value = uint64_t(thread) << 32 | i }, { .value = i }));
+                }
+            }
+        });
+    }
+    threads.clear();
+
+    OWGE_CHECK(corrupted_count == 0);
+    OWGE_CHECK(allocator.size() <= allocator.capacity());
+    std::vector<uint32_t> indices;
+    for (uint32_t thread = 0; thread < THREAD_COUNT; ++thread)
+    {
+        for (auto handle : live[thread])
+        {
+            OWGE_CHECK(allocator[handle].value >> 32 == thread);
+            indices.push_back(handle.resource_idx);
+        }
+    }
+    std::ranges::sort(indices);
+    OWGE_CHECK(std::ranges::adjacent_find(indices) == indices.end());
+}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace owge::test
+{
+struct Test_Case
+{
+    const char* suite;
+    const char* name;
+    void(*run)();
+};
+
+[[nodiscard]] std::vector<Test_Case>& get_test_cases();
+void report_failure(const char* file, int line, const char* expression);
+
+struct Test_Registrar
+{
+    Test_Registrar(const char* suite, const char* name, void(*run)())
+    {
+        get_test_cases().push_back({ .suite = suite, .name = name, .run = run });
+    }
+};
+}
+
+// Defines a test case of `suite`, `owge_tests <suite>` only runs the cases of that suite.
+#define OWGE_TEST(suite, name) \
+    static void suite##_##name(); \
+    static const owge::test::Test_Registrar suite##_##name##_registrar(#suite, #name, suite##_##name); \
+    static void suite##_##name()
+
+// Failed checks are reported and fail the test case, the case keeps running.
+#define OWGE_CHECK(expression) \
+    do \
+    { \
+        if (!(expression)) \
+        { \
+            owge::test::report_failure(__FILE__, __LINE__, #expression); \
+        } \
+    } while (false)
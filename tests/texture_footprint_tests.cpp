@@ -0,0 +1,121 @@
+#include "test.hpp"
+
+#include <owge_common/texture_footprint.hpp>
+
+#include <vector>
+
+namespace owge
+{
+static constexpr Texel_Block_Info R8_BLOCK = { .size = 1, .width = 1, .height = 1 };
+static constexpr Texel_Block_Info RGBA8_BLOCK = { .size = 4, .width = 1, .height = 1 };
+static constexpr Texel_Block_Info BC1_BLOCK = { .size = 8, .width = 4, .height = 4 };
+
+OWGE_TEST(texture_footprint, rows_are_256_byte_aligned)
+{
+    Texture_Footprint_Desc desc = {
+        .width = 100,
+        .height = 10,
+        .depth = 1,
+        .array_layers = 1,
+        .mip_levels = 1,
+        .block = RGBA8_BLOCK
+    };
+    std::vector<Subresource_Footprint> footprints(1);
+    auto size = compute_subresource_footprints(desc, 0, footprints);
+    OWGE_CHECK(footprints[0].offset == 0);
+    OWGE_CHECK(footprints[0].width == 100 && footprints[0].height == 10 && footprints[0].depth == 1);
+    OWGE_CHECK(footprints[0].row_size == 400);
+    OWGE_CHECK(footprints[0].row_pitch == 512);
+    OWGE_CHECK(footprints[0].row_count == 10);
+    OWGE_CHECK(size == 512 * 10);
+}
+
+OWGE_TEST(texture_footprint, subresources_start_on_512_byte_boundaries)
+{
+    Texture_Footprint_Desc desc = {
+        .width = 100,
+        .height = 3,
+        .depth = 1,
+        .array_layers = 1,
+        .mip_levels = 2,
+        .block = R8_BLOCK
+    };
+    std::vector<Subresource_Footprint> footprints(2);
+    auto size = compute_subresource_footprints(desc, 0, footprints);
+    OWGE_CHECK(footprints[0].row_pitch == 256);
+    OWGE_CHECK(footprints[1].offset == 1024);
+    OWGE_CHECK(footprints[1].width == 50 && footprints[1].height == 1);
+    OWGE_CHECK(size == 1024 + 256);
+    for (const auto& footprint : footprints)
+    {
+        OWGE_CHECK(footprint.offset % 512 == 0);
+        OWGE_CHECK(footprint.row_pitch % 256 == 0);
+    }
+}
+
+OWGE_TEST(texture_footprint, block_compressed_mips_round_up_to_whole_blocks)
+{
+    Texture_Footprint_Desc desc = {
+        .width = 16,
+        .height = 16,
+        .depth = 1,
+        .array_layers = 1,
+        .mip_levels = 5,
+        .block = BC1_BLOCK
+    };
+    std::vector<Subresource_Footprint> footprints(5);
+    compute_subresource_footprints(desc, 0, footprints);
+    OWGE_CHECK(footprints[0].row_size == 4 * 8);
+    OWGE_CHECK(footprints[0].row_count == 4);
+    OWGE_CHECK(footprints[1].width == 8 && footprints[1].height == 8);
+    OWGE_CHECK(footprints[1].row_count == 2);
+    // 2x2 and 1x1 still occupy a whole 4x4 block.
+    for (uint32_t mip = 3; mip < 5; ++mip)
+    {
+        OWGE_CHECK(footprints[mip].width == 4 && footprints[mip].height == 4);
+        OWGE_CHECK(footprints[mip].row_size == 8);
+        OWGE_CHECK(footprints[mip].row_pitch == 256);
+        OWGE_CHECK(footprints[mip].row_count == 1);
+    }
+}
+
+OWGE_TEST(texture_footprint, first_subresource_wraps_across_array_layers)
+{
+    Texture_Footprint_Desc desc = {
+        .width = 64,
+        .height = 64,
+        .depth = 1,
+        .array_layers = 2,
+        .mip_levels = 3,
+        .block = RGBA8_BLOCK
+    };
+    // The last mip of layer 0, then the first mip of layer 1.
+    std::vector<Subresource_Footprint> footprints(2);
+    auto size = compute_subresource_footprints(desc, 2, footprints);
+    OWGE_CHECK(footprints[0].offset == 0);
+    OWGE_CHECK(footprints[0].width == 16 && footprints[0].height == 16);
+    OWGE_CHECK(footprints[1].offset == 256 * 16);
+    OWGE_CHECK(footprints[1].width == 64 && footprints[1].height == 64);
+    OWGE_CHECK(size == 256 * 16 + 256 * 64);
+}
+
+OWGE_TEST(texture_footprint, volume_mips_halve_the_depth)
+{
+    Texture_Footprint_Desc desc = {
+        .width = 32,
+        .height = 32,
+        .depth = 8,
+        .array_layers = 1,
+        .mip_levels = 5,
+        .block = RGBA8_BLOCK
+    };
+    std::vector<Subresource_Footprint> footprints(5);
+    auto size = compute_subresource_footprints(desc, 0, footprints);
+    OWGE_CHECK(footprints[0].depth == 8);
+    OWGE_CHECK(footprints[1].offset == 256 * 32 * 8);
+    OWGE_CHECK(footprints[1].depth == 4);
+    OWGE_CHECK(footprints[3].depth == 1);
+    OWGE_CHECK(footprints[4].depth == 1);
+    OWGE_CHECK(size == footprints[4].offset + 256 * 2 * 1);
+}
+}
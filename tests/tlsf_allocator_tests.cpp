@@ -0,0 +1,88 @@
+#include "test.hpp"
+
+#include <owge_common/tlsf_allocator.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace owge
+{
+OWGE_TEST(tlsf_allocator, freed_neighbours_are_coalesced)
+{
+    Tlsf_Allocator allocator(300);
+    auto a = allocator.allocate(100);
+    auto b = allocator.allocate(100);
+    auto c = allocator.allocate(100);
+    OWGE_CHECK(a.is_valid() && b.is_valid() && c.is_valid());
+    OWGE_CHECK(!allocator.allocate(1).is_valid());
+
+    allocator.free(a);
+    allocator.free(c);
+    OWGE_CHECK(allocator.get_stats().free_block_count == 2);
+    OWGE_CHECK(!allocator.allocate(200).is_valid());
+
+    allocator.free(b);
+    auto stats = allocator.get_stats();
+    OWGE_CHECK(allocator.empty());
+    OWGE_CHECK(stats.free_block_count == 1);
+    OWGE_CHECK(stats.largest_free_block == 300);
+    OWGE_CHECK(allocator.allocate(300).is_valid());
+}
+
+OWGE_TEST(tlsf_allocator, aligned_allocations_keep_the_padding_free)
+{
+    Tlsf_Allocator allocator(1024);
+    auto a = allocator.allocate(3);
+    auto b = allocator.allocate(64, 256);
+    OWGE_CHECK(b.is_valid());
+    OWGE_CHECK(b.offset % 256 == 0);
+    OWGE_CHECK(allocator.get_stats().used_size == 67);
+    allocator.free(a);
+    allocator.free(b);
+    OWGE_CHECK(allocator.get_stats().largest_free_block == 1024);
+}
+
+OWGE_TEST(tlsf_allocator, empty_allocator_and_zero_size_fail)
+{
+    Tlsf_Allocator empty(0);
+    OWGE_CHECK(!empty.allocate(1).is_valid());
+    Tlsf_Allocator allocator(16);
+    OWGE_CHECK(!allocator.allocate(0).is_valid());
+    OWGE_CHECK(allocator.empty());
+}
+
+OWGE_TEST(tlsf_allocator, random_allocations_never_overlap)
+{
+    Tlsf_Allocator allocator(1 << 16);
+    std::mt19937 random(7);
+    std::vector<Tlsf_Allocation> allocations;
+    for (uint32_t i = 0; i < 20000; ++i)
+    {
+        if (!allocations.empty() && random() % 3 == 0)
+        {
+            auto index = random() % allocations.size();
+            allocator.free(allocations[index]);
+            allocations[index] = allocations.back();
+            allocations.pop_back();
+            continue;
+        }
+        auto allocation = allocator.allocate(1 + random() % 512, 1ull << (random() % 5));
+        if (allocation.is_valid())
+        {
+            allocations.push_back(allocation);
+        }
+    }
+
+    std::ranges::sort(allocations, {}, &Tlsf_Allocation::offset);
+    for (std::size_t i = 1; i < allocations.size(); ++i)
+    {
+        OWGE_CHECK(allocations[i - 1].offset + allocations[i - 1].size <= allocations[i].offset);
+    }
+    for (const auto& allocation : allocations)
+    {
+        allocator.free(allocation);
+    }
+    OWGE_CHECK(allocator.get_stats().free_block_count == 1);
+}
+}
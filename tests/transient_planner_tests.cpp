@@ -0,0 +1,76 @@
+#include "test.hpp"
+
+#include <owge_common/transient_planner.hpp>
+
+#include <random>
+#include <vector>
+
+namespace owge
+{
+OWGE_TEST(transient_planner, disjoint_lifetimes_share_memory)
+{
+    std::vector<Transient_Resource_Desc> resources = {
+        { .size = 1024, .alignment = 256, .first_use = 0, .last_use = 1 },
+        { .size = 512, .alignment = 256, .first_use = 2, .last_use = 3 },
+        { .size = 1024, .alignment = 256, .first_use = 4, .last_use = 4 }
+    };
+    auto plan = plan_transient_resources(resources);
+    OWGE_CHECK(plan.heap_size == 1024);
+    OWGE_CHECK(plan.placements[0].previous_resource == TRANSIENT_NO_RESOURCE);
+    OWGE_CHECK(plan.placements[0].next_resource == 1);
+    OWGE_CHECK(plan.placements[1].previous_resource == 0);
+    OWGE_CHECK(plan.placements[1].next_resource == 2);
+    OWGE_CHECK(plan.placements[2].previous_resource == 1);
+    OWGE_CHECK(plan.placements[2].is_aliased());
+}
+
+OWGE_TEST(transient_planner, overlapping_lifetimes_are_placed_side_by_side)
+{
+    std::vector<Transient_Resource_Desc> resources = {
+        { .size = 100, .alignment = 1, .first_use = 1, .last_use = 3 },
+        { .size = 100, .alignment = 256, .first_use = 3, .last_use = 3 }
+    };
+    auto plan = plan_transient_resources(resources);
+    OWGE_CHECK(plan.placements[0].offset == 0);
+    OWGE_CHECK(plan.placements[1].offset == 256);
+    OWGE_CHECK(plan.heap_size == 356);
+    OWGE_CHECK(!plan.placements[0].is_aliased() && !plan.placements[1].is_aliased());
+}
+
+OWGE_TEST(transient_planner, resources_alive_together_never_overlap)
+{
+    std::mt19937 random(3);
+    for (uint32_t round = 0; round < 50; ++round)
+    {
+        std::vector<Transient_Resource_Desc> resources(64);
+        uint64_t total_size = 0;
+        for (auto& resource : resources)
+        {
+            auto first_use = uint32_t(random() % 16);
+            resource = {
+                .size = 1 + random() % 4096,
+                .alignment = 1ull << (random() % 9),
+                .first_use = first_use,
+                .last_use = first_use + uint32_t(random() % 4)
+            };
+            total_size += resource.size + resource.alignment;
+        }
+        auto plan = plan_transient_resources(resources);
+        OWGE_CHECK(plan.heap_size <= total_size);
+        for (uint32_t a = 0; a < resources.size(); ++a)
+        {
+            const auto& placement = plan.placements[a];
+            OWGE_CHECK(placement.offset % resources[a].alignment == 0);
+            OWGE_CHECK(placement.offset + resources[a].size <= plan.heap_size);
+            for (uint32_t b = a + 1; b < resources.size(); ++b)
+            {
+                auto alive_together = resources[a].first_use <= resources[b].last_use
+                    && resources[b].first_use <= resources[a].last_use;
+                auto memory_overlaps = placement.offset < plan.placements[b].offset + resources[b].size
+                    && plan.placements[b].offset < placement.offset + resources[a].size;
+                OWGE_CHECK(!(alive_together && memory_overlaps));
+            }
+        }
+    }
+}
+}
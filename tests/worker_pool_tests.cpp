@@ -0,0 +1,57 @@
+#include "test.hpp"
+
+#include <owge_common/worker_pool.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace owge
+{
+OWGE_TEST(worker_pool, runs_every_task_on_its_worker)
+{
+    Worker_Pool pool(4);
+    std::vector<uint32_t> workers(64, ~0u);
+    for (uint32_t batch = 0; batch < 16; ++batch)
+    {
+        pool.run(uint32_t(workers.size()), [&](uint32_t i, uint32_t worker) {
+            workers[i] = worker;
+        });
+        for (uint32_t i = 0; i < uint32_t(workers.size()); ++i)
+        {
+            OWGE_CHECK(workers[i] == i % pool.get_worker_count());
+        }
+    }
+}
+
+OWGE_TEST(worker_pool, rethrows_after_the_batch_finished)
+{
+    Worker_Pool pool(4);
+    for (uint32_t throwing_task = 0; throwing_task < 4; ++throwing_task)
+    {
+        std::atomic<uint32_t> finished_count = 0;
+        bool thrown = false;
+        try
+        {
+            pool.run(4, [&](uint32_t i, uint32_t) {
+                if (i == throwing_task)
+                {
+                    throw std::runtime_error("task failed");
+                }
+                finished_count += 1;
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        OWGE_CHECK(thrown);
+        OWGE_CHECK(finished_count == 3);
+    }
+
+    // The pool stays usable after a failed batch.
+    std::atomic<uint32_t> count = 0;
+    pool.run(8, [&](uint32_t, uint32_t) { count += 1; });
+    OWGE_CHECK(count == 8);
+}
+}